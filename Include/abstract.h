@@ -311,6 +311,48 @@ xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx*/
 
        */
 
+     PyAPI_FUNC(PyObject *) _PyObject_FastCall(PyObject *callable_object,
+                                              PyObject **args,
+                                              Py_ssize_t nargs,
+                                              PyObject **kws,
+                                              Py_ssize_t nkws);
+
+       /*
+     Call a callable Python object with nargs positional arguments
+     from the C array args, and nkws keyword arguments from the C
+     array kws, which holds alternating names and values as for
+     PyEval_EvalCodeEx().  kws may be NULL if nkws is 0.  Functions,
+     bound methods, builtins, method descriptors and classes are
+     called without building an argument tuple where possible.
+
+       */
+
+     PyAPI_FUNC(PyObject *) _PyObject_FastCallPrepend(PyObject *callable,
+                                                     PyObject *self,
+                                                     PyObject **args,
+                                                     Py_ssize_t nargs,
+                                                     PyObject **kws,
+                                                     Py_ssize_t nkws);
+
+       /*
+     Like _PyObject_FastCall(), with self inserted before the
+     positional arguments.
+
+       */
+
+     PyAPI_FUNC(PyObject *) _PyStack_AsTuple(PyObject **args,
+                                            Py_ssize_t nargs);
+     PyAPI_FUNC(PyObject *) _PyStack_AsDict(PyObject **kws,
+                                           Py_ssize_t nkws,
+                                           PyObject *func);
+
+       /*
+     Build the argument tuple and keyword dictionary of a call to
+     func from C arrays of arguments, for callables which need them.
+     func is only used in error messages and may be NULL.
+
+       */
+
      PyAPI_FUNC(PyObject *) PyObject_CallObject(PyObject *callable_object,
                                                PyObject *args);
 
@@ -74,6 +74,13 @@ PyAPI_FUNC(PyObject *) PyEval_EvalFrameEx_slp(struct _frame *f, int exc, PyObjec
 PyAPI_DATA(volatile int) _Py_Ticker;
 PyAPI_DATA(int) _Py_CheckInterval;
 
+#ifdef WITH_THREAD
+/* the time in microseconds a thread waits for the GIL before it asks the
+   holder to drop it */
+PyAPI_FUNC(void) _PyEval_SetSwitchInterval(long microseconds);
+PyAPI_FUNC(long) _PyEval_GetSwitchInterval(void);
+#endif
+
 /* Interface for threads.
 
    A module that plans to do a blocking system call (or something else
@@ -6,6 +6,33 @@
 extern "C" {
 #endif
 
+/* An entry of the LOAD_GLOBAL cache. value is a borrowed reference,
+   valid while the globals and builtins keep the recorded versions. */
+typedef struct {
+    PyDictVersion gc_globals_version;
+    PyDictVersion gc_builtins_version;
+    PyObject *gc_value;
+} PyGlobalCacheEntry;
+
+/* The attribute caches of the LOAD_ATTR, STORE_ATTR and LOAD_METHOD
+   instructions. at_index maps an instruction offset to the number of
+   its cache plus one, 0 for instructions which have none. */
+typedef struct {
+    unsigned short *at_index;
+    PyAttrCache at_sites[1];
+} PyAttrCacheTable;
+
+/* The quickened code of a hot code object: a copy of co_code in which
+   the interpreter rewrites instructions to forms specialized for the
+   operand types they have seen.  qc_kinds and qc_hits are indexed by
+   instruction offset like qc_code, and count how often in a row an
+   instruction wanted the same specialized form. */
+typedef struct {
+    unsigned char *qc_kinds;
+    unsigned char *qc_hits;
+    unsigned char qc_code[1];
+} PyQuickenedCode;
+
 /* Bytecode object */
 typedef struct {
     PyObject_HEAD
@@ -27,6 +54,14 @@ typedef struct {
 				   Objects/lnotab_notes.txt for details. */
     void *co_zombieframe;     /* for optimization only (see frameobject.c) */
     PyObject *co_weakreflist;   /* to support weakrefs to code objects */
+    PyGlobalCacheEntry *co_globalcache; /* LOAD_GLOBAL cache by name index,
+                                           allocated on first use */
+    PyAttrCacheTable *co_attrcache; /* attribute caches by instruction,
+                                       allocated on first use */
+    long co_execcount;          /* number of calls, for finding hot code */
+    int co_warmup;              /* calls and loop iterations to run before
+                                   quickening, <= 0 when done */
+    PyQuickenedCode *co_quickened; /* NULL until the code is hot */
 } PyCodeObject;
 
 /* Masks for co_flags above */
@@ -82,6 +117,19 @@ PyCode_NewEmpty(const char *filename, const char *funcname, int firstlineno);
    use PyFrame_GetLineNumber() instead. */
 PyAPI_FUNC(int) PyCode_Addr2Line(PyCodeObject *, int);
 
+/* Return the LOAD_GLOBAL cache of a code object, or NULL if it cannot
+   be allocated. No exception is set. */
+PyAPI_FUNC(PyGlobalCacheEntry *) _PyCode_GetGlobalCache(PyCodeObject *);
+
+/* Return the attribute cache of the instruction at the given offset,
+   or NULL if it has none. No exception is set. */
+PyAPI_FUNC(PyAttrCache *) _PyCode_GetAttrCache(PyCodeObject *, int);
+
+/* Make the quickened code of a code object, and return it.  Returns
+   NULL if there is no memory or nothing to specialize; the code then
+   runs unquickened.  No exception is set. */
+PyAPI_FUNC(PyQuickenedCode *) _PyCode_Quicken(PyCodeObject *);
+
 /* for internal use only */
 #define _PyCode_GETCODEPTR(co, pp) \
 	((*Py_TYPE((co)->co_code)->tp_as_buffer->bf_getreadbuffer) \
@@ -73,6 +73,7 @@ typedef struct {
 #endif
 } PyWrapperDescrObject;
 
+PyAPI_DATA(PyTypeObject) PyMethodDescr_Type;
 PyAPI_DATA(PyTypeObject) PyWrapperDescr_Type;
 PyAPI_DATA(PyTypeObject) PyDictProxy_Type;
 PyAPI_DATA(PyTypeObject) PyGetSetDescr_Type;
@@ -88,6 +89,11 @@ PyAPI_FUNC(PyObject *) PyDescr_NewWrapper(PyTypeObject *,
                                                 struct wrapperbase *, void *);
 #define PyDescr_IsData(d) (Py_TYPE(d)->tp_descr_set != NULL)
 
+#define PyMethodDescr_Check(d) (Py_TYPE(d) == &PyMethodDescr_Type)
+PyAPI_FUNC(PyObject *) _PyMethodDescr_FastCall(PyObject *, PyObject **,
+                                               Py_ssize_t, PyObject **,
+                                               Py_ssize_t);
+
 PyAPI_FUNC(PyObject *) PyDictProxy_New(PyObject *);
 PyAPI_FUNC(PyObject *) PyWrapper_New(PyObject *, PyObject *);
 
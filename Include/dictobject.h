@@ -66,6 +66,17 @@ values == the number of Active items).
 To avoid slowing down lookups on a near-full table, we resize the table when
 it's two-thirds full.
 */
+/* The version tag of a dict changes with every modification. Tags are
+   never reused, so equal tags mean the same dict with the same items. */
+#ifdef HAVE_LONG_LONG
+typedef unsigned PY_LONG_LONG PyDictVersion;
+#else
+typedef size_t PyDictVersion;
+#endif
+
+/* The keys shared by the instance dicts of a class, see below */
+typedef struct _dictsharedkeys PyDictSharedKeys;
+
 typedef struct _dictobject PyDictObject;
 struct _dictobject {
     PyObject_HEAD
@@ -81,10 +92,21 @@ struct _dictobject {
     /* ma_table points to ma_smalltable for small tables, else to
      * additional malloc'ed memory.  ma_table is never NULL!  This rule
      * saves repeated runtime null-tests in the workhorse getitem and
-     * setitem calls.
+     * setitem calls.  The exception are split dicts (see below), whose
+     * ma_lookup returns a copy of the entry, which must not be stored to.
      */
     PyDictEntry *ma_table;
     PyDictEntry *(*ma_lookup)(PyDictObject *mp, PyObject *key, long hash);
+    PyDictVersion ma_version_tag;
+
+    /* Instance dicts of heap types may be split: the keys live in
+     * ma_keys, shared by all instances of the class, and ma_values
+     * holds the values by key index. ma_table is NULL and ma_fill is
+     * the size of ma_values then. A split dict is allocated without
+     * ma_smalltable, and keeps ma_keys when it becomes combined.
+     */
+    PyDictSharedKeys *ma_keys;
+    PyObject **ma_values;
     PyDictEntry ma_smalltable[PyDict_MINSIZE];
 };
 
@@ -125,6 +147,16 @@ PyAPI_FUNC(int) _PyDict_Contains(PyObject *mp, PyObject *key, long hash);
 PyAPI_FUNC(PyObject *) _PyDict_NewPresized(Py_ssize_t minused);
 PyAPI_FUNC(void) _PyDict_MaybeUntrack(PyObject *mp);
 
+/* Create an instance dict for an object of the type, sharing the keys
+   of its other instances if it is a heap type. */
+PyAPI_FUNC(PyObject *) _PyDict_NewShared(PyTypeObject *);
+PyAPI_FUNC(void) _PyDict_SharedKeysDecref(PyDictSharedKeys *);
+/* Look up a string key, trying the position in *hint first, which is
+   updated to where the key was found. Errors are ignored like in
+   PyDict_GetItem(). */
+PyAPI_FUNC(PyObject *) _PyDict_GetItemHint(PyObject *, PyObject *,
+                                           Py_ssize_t *);
+
 /* PyDict_Update(mp, other) is equivalent to PyDict_Merge(mp, other, 1). */
 PyAPI_FUNC(int) PyDict_Update(PyObject *mp, PyObject *other);
 
@@ -92,6 +92,12 @@ PyAPI_FUNC(void) PyFrame_FastToLocals(PyFrameObject *);
 
 PyAPI_FUNC(int) PyFrame_ClearFreeList(void);
 
+/* The per-thread pools of free frames */
+
+PyAPI_FUNC(void) _PyFrame_InitPool(PyThreadState *);
+PyAPI_FUNC(int) _PyFrame_ClearPool(PyThreadState *);
+PyAPI_FUNC(void) _PyFrame_SetPoolLimit(int);
+
 /* Return the line of code the frame is currently executing. */
 PyAPI_FUNC(int) PyFrame_GetLineNumber(PyFrameObject *);
 
@@ -49,6 +49,9 @@ PyAPI_FUNC(PyObject *) PyFunction_GetDefaults(PyObject *);
 PyAPI_FUNC(int) PyFunction_SetDefaults(PyObject *, PyObject *);
 PyAPI_FUNC(PyObject *) PyFunction_GetClosure(PyObject *);
 PyAPI_FUNC(int) PyFunction_SetClosure(PyObject *, PyObject *);
+PyAPI_FUNC(PyObject *) _PyFunction_FastCall(PyObject *, PyObject **,
+                                            Py_ssize_t, PyObject **,
+                                            Py_ssize_t);
 
 /* Macros for direct access to these values. Type checks are *not*
    done, so use with care. */
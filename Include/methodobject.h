@@ -19,6 +19,7 @@ typedef PyObject *(*PyCFunction)(PyObject *, PyObject *);
 typedef PyObject *(*PyCFunctionWithKeywords)(PyObject *, PyObject *,
 					     PyObject *);
 typedef PyObject *(*PyNoArgsFunction)(PyObject *);
+typedef PyObject *(*PyCFunctionFast)(PyObject *, PyObject **, Py_ssize_t);
 
 PyAPI_FUNC(PyCFunction) PyCFunction_GetFunction(PyObject *);
 PyAPI_FUNC(PyObject *) PyCFunction_GetSelf(PyObject *);
@@ -33,6 +34,9 @@ PyAPI_FUNC(int) PyCFunction_GetFlags(PyObject *);
 #define PyCFunction_GET_FLAGS(func) \
 	(((PyCFunctionObject *)func) -> m_ml -> ml_flags)
 PyAPI_FUNC(PyObject *) PyCFunction_Call(PyObject *, PyObject *, PyObject *);
+PyAPI_FUNC(PyObject *) _PyCFunction_FastCall(PyObject *, PyObject **,
+                                             Py_ssize_t, PyObject **,
+                                             Py_ssize_t);
 
 struct PyMethodDef {
     const char	*ml_name;	/* The name of the built-in function/method */
@@ -48,6 +52,9 @@ PyAPI_FUNC(PyObject *) Py_FindMethod(PyMethodDef[], PyObject *, const char *);
 #define PyCFunction_New(ML, SELF) PyCFunction_NewEx((ML), (SELF), NULL)
 PyAPI_FUNC(PyObject *) PyCFunction_NewEx(PyMethodDef *, PyObject *, 
 					 PyObject *);
+PyAPI_FUNC(PyObject *) _PyMethodDef_FastCall(PyMethodDef *, PyObject *,
+                                             PyObject **, Py_ssize_t,
+                                             PyObject **, Py_ssize_t);
 
 /* Flag passed to newmethodobject */
 #define METH_OLDARGS  0x0000
@@ -76,6 +83,12 @@ PyAPI_FUNC(PyObject *) PyCFunction_NewEx(PyMethodDef *, PyObject *,
 #define METH_STACKLESS 0x0000
 #endif
 
+/* METH_FASTCALL functions are PyCFunctionFast: they receive their
+   positional arguments as a C array and take no keyword arguments.
+   Like METH_NOARGS and METH_O it must not be combined with the
+   argument flags above. */
+#define METH_FASTCALL  0x0100
+
 typedef struct PyMethodChain {
     PyMethodDef *methods;		/* Methods of this type */
     struct PyMethodChain *link;	/* NULL or base type */
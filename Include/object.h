@@ -423,6 +423,7 @@ typedef struct _typeobject {
                                       see add_operators() in typeobject.c . */
     PyBufferProcs as_buffer;
     PyObject *ht_name, *ht_slots;
+    struct _dictsharedkeys *ht_cached_keys;
     slp_methodflags slpflags;
 #endif
 } PyTypeObject;
@@ -451,6 +452,7 @@ typedef struct _heaptypeobject {
                                       see add_operators() in typeobject.c . */
     PyBufferProcs as_buffer;
     PyObject *ht_name, *ht_slots;
+    struct _dictsharedkeys *ht_cached_keys; /* keys of instance dicts */
     /* here are optional user slots, followed by the members. */
 } PyHeapTypeObject;
 
@@ -478,6 +480,8 @@ PyAPI_FUNC(PyObject *) PyType_GenericAlloc(PyTypeObject *, Py_ssize_t);
 PyAPI_FUNC(PyObject *) PyType_GenericNew(PyTypeObject *,
                                                PyObject *, PyObject *);
 PyAPI_FUNC(PyObject *) _PyType_Lookup(PyTypeObject *, PyObject *);
+PyAPI_FUNC(PyObject *) _PyType_FastCall(PyTypeObject *, PyObject **,
+                                        Py_ssize_t, PyObject **, Py_ssize_t);
 PyAPI_FUNC(PyObject *) _PyObject_LookupSpecial(PyObject *, char *, PyObject **);
 PyAPI_FUNC(unsigned int) PyType_ClearCache(void);
 PyAPI_FUNC(void) PyType_Modified(PyTypeObject *);
@@ -507,6 +511,36 @@ PyAPI_FUNC(PyObject *) _PyObject_NextNotImplemented(PyObject *);
 PyAPI_FUNC(PyObject *) PyObject_GenericGetAttr(PyObject *, PyObject *);
 PyAPI_FUNC(int) PyObject_GenericSetAttr(PyObject *,
                                               PyObject *, PyObject *);
+
+/* Inline caches of attribute lookups, used by LOAD_ATTR and STORE_ATTR.
+   An entry records the result of _PyType_Lookup() for a type, valid as
+   long as the type keeps ac_version as its tp_version_tag. ac_hint is
+   the index in the instance dict where the attribute was last found. */
+typedef struct {
+    PyTypeObject *ac_type;      /* only compared, not a reference */
+    unsigned int ac_version;
+    PyObject *ac_descr;         /* borrowed */
+    Py_ssize_t ac_hint;
+} PyAttrCacheEntry;
+
+#define PY_ATTRCACHE_WAYS 4
+
+typedef struct {
+    PyAttrCacheEntry ac_entries[PY_ATTRCACHE_WAYS];
+    int ac_next;                /* the entry to replace on a miss */
+} PyAttrCache;
+
+PyAPI_FUNC(PyObject *) _PyObject_GetAttrCached(PyObject *, PyObject *,
+                                               PyAttrCache *);
+PyAPI_FUNC(int) _PyObject_SetAttrCached(PyObject *, PyObject *, PyObject *,
+                                        PyAttrCache *);
+
+/* Look up a method for LOAD_METHOD. Return 1 and the plain function or
+   method descriptor if the attribute would be a method bound to the
+   object, else return 0 and the attribute, or NULL on error. The cache
+   may be NULL. */
+PyAPI_FUNC(int) _PyObject_GetMethod(PyObject *, PyObject *, PyAttrCache *,
+                                    PyObject **);
 PyAPI_FUNC(long) PyObject_Hash(PyObject *);
 PyAPI_FUNC(long) PyObject_HashNotImplemented(PyObject *);
 PyAPI_FUNC(int) PyObject_IsTrue(PyObject *);
@@ -265,6 +265,7 @@ extern PyGC_Head *_PyGC_generation0;
 #define _PyGC_REFS_UNTRACKED                    (-2)
 #define _PyGC_REFS_REACHABLE                    (-3)
 #define _PyGC_REFS_TENTATIVELY_UNREACHABLE      (-4)
+#define _PyGC_REFS_FROZEN                       (-5)
 
 /* Tell the GC to track this object.  NB: While the object is tracked the
  * collector it must be safe to call the ob_traverse method. */
@@ -311,6 +312,9 @@ PyAPI_FUNC(void) PyObject_GC_UnTrack(void *);
 PyAPI_FUNC(void) PyObject_GC_Del(void *);
 /* STACKLESS addition */
 PyAPI_FUNC(void) PyObject_GC_Collectable(PyObject *, visitproc, void*, int);
+/* moving objects to and from the permanent generation */
+PyAPI_FUNC(int) _PyObject_GC_Freeze(PyObject *);
+PyAPI_FUNC(int) _PyObject_GC_Thaw(PyObject *);
 
 #define PyObject_GC_New(type, typeobj) \
                 ( (type *) _PyObject_GC_New(typeobj) )
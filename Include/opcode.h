@@ -150,6 +150,30 @@ extern "C" {
 #define SET_ADD         146
 #define MAP_ADD         147
 
+#define LOAD_METHOD     148	/* Index in name list */
+#define CALL_METHOD     149	/* #args */
+
+/* Superinstructions, made by the peephole optimizer from a pair of
+   instructions.  They take the argument of the first one, the second
+   one stays in place behind them. */
+#define LOAD_FAST_LOAD_FAST             150
+#define LOAD_FAST_LOAD_CONST            151
+#define LOAD_FAST_LOAD_ATTR             152
+#define LOAD_FAST_LOAD_METHOD           153
+#define STORE_FAST_LOAD_FAST            154
+#define LOAD_CONST_RETURN_VALUE         155
+#define COMPARE_OP_POP_JUMP_IF_FALSE    156
+
+/* Specialized forms of instructions, which only occur in quickened
+   code (see ceval.c).  Those without an argument are numbered below
+   HAVE_ARGUMENT. */
+#define BINARY_ADD_INT          34
+#define BINARY_ADD_FLOAT        35
+#define BINARY_SUBSCR_LIST_INT  36
+#define BINARY_SUBSCR_DICT_STR  37
+#define COMPARE_OP_FLOAT        157
+#define COMPARE_OP_STR          158
+
 
 enum cmp_op {PyCmp_LT=Py_LT, PyCmp_LE=Py_LE, PyCmp_EQ=Py_EQ, PyCmp_NE=Py_NE, PyCmp_GT=Py_GT, PyCmp_GE=Py_GE,
 	     PyCmp_IN, PyCmp_NOT_IN, PyCmp_IS, PyCmp_IS_NOT, PyCmp_EXC_MATCH, PyCmp_BAD};
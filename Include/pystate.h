@@ -56,6 +56,19 @@ typedef int (*Py_tracefunc)(PyObject *, struct _frame *, int, PyObject *);
 #define PyTrace_C_EXCEPTION 5
 #define PyTrace_C_RETURN 6
 
+/* Free frames which a thread keeps for reuse, on one free list per
+   size class; see Objects/frameobject.c */
+#define PyFrame_POOLCLASSES 16
+
+typedef struct {
+    struct _frame *fp_free[PyFrame_POOLCLASSES];
+    int fp_count;       /* frames on the free lists */
+    int fp_limit;       /* most frames to keep */
+    long fp_hits;       /* frames taken from the free lists */
+    long fp_misses;     /* frames allocated anew */
+    long fp_released;   /* frames freed because the pool was full */
+} PyFramePool;
+
 typedef struct _ts {
     /* See Python/ceval.c for comments explaining most fields */
 
@@ -98,6 +111,8 @@ typedef struct _ts {
     PyObject *async_exc; /* Asynchronous exception to raise */
     long thread_id; /* Thread id where this tstate was created */
 
+    PyFramePool frame_pool;
+
 #ifdef STACKLESS
 	PyStacklessState st;
 #endif
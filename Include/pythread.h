@@ -21,6 +21,17 @@ PyAPI_FUNC(int) PyThread_acquire_lock(PyThread_type_lock, int);
 #define NOWAIT_LOCK	0
 PyAPI_FUNC(void) PyThread_release_lock(PyThread_type_lock);
 
+/* The interpreter lock (see ceval.c).  A thread that waited for it longer
+   than the given interval in microseconds sets *drop_request, asking the
+   holder to let go, and zeroes *ticker so that the holder looks at the
+   request right away; a forced drop waits until another thread took over. */
+typedef void *PyThread_type_gil;
+
+PyAPI_FUNC(PyThread_type_gil) PyThread_allocate_gil(volatile int *,
+                                                    volatile int *);
+PyAPI_FUNC(void) PyThread_take_gil(PyThread_type_gil, long);
+PyAPI_FUNC(void) PyThread_drop_gil(PyThread_type_gil, int);
+
 PyAPI_FUNC(size_t) PyThread_get_stacksize(void);
 PyAPI_FUNC(int) PyThread_set_stacksize(size_t);
 
@@ -767,7 +767,7 @@ def getargs(co):
                     if opname in ('UNPACK_TUPLE', 'UNPACK_SEQUENCE'):
                         remain.append(value)
                         count.append(value)
-                    elif opname == 'STORE_FAST':
+                    elif opname in ('STORE_FAST', 'STORE_FAST_LOAD_FAST'):
                         stack.append(names[value])
 
                         # Special case for sublists of length 1: def foo((bar))
@@ -189,4 +189,33 @@ EXTENDED_ARG = 145
 def_op('SET_ADD', 146)
 def_op('MAP_ADD', 147)
 
+name_op('LOAD_METHOD', 148)     # Index in name list
+def_op('CALL_METHOD', 149)      # #args
+
+# Superinstructions, with the argument of the first instruction of the pair
+def_op('LOAD_FAST_LOAD_FAST', 150)
+haslocal.append(150)
+def_op('LOAD_FAST_LOAD_CONST', 151)
+haslocal.append(151)
+def_op('LOAD_FAST_LOAD_ATTR', 152)
+haslocal.append(152)
+def_op('LOAD_FAST_LOAD_METHOD', 153)
+haslocal.append(153)
+def_op('STORE_FAST_LOAD_FAST', 154)
+haslocal.append(154)
+def_op('LOAD_CONST_RETURN_VALUE', 155)
+hasconst.append(155)
+def_op('COMPARE_OP_POP_JUMP_IF_FALSE', 156)
+hascompare.append(156)
+
+# Specialized forms, only found in quickened code inside the interpreter
+def_op('BINARY_ADD_INT', 34)
+def_op('BINARY_ADD_FLOAT', 35)
+def_op('BINARY_SUBSCR_LIST_INT', 36)
+def_op('BINARY_SUBSCR_DICT_STR', 37)
+def_op('COMPARE_OP_FLOAT', 157)
+hascompare.append(157)
+def_op('COMPARE_OP_STR', 158)
+hascompare.append(158)
+
 del def_op, name_op, jrel_op, jabs_op
@@ -125,9 +125,97 @@ class CFunctionCalls(unittest.TestCase):
     def test_oldargs1_2_kw(self):
         self.assertRaises(TypeError, [].count, x=2, y=2)
 
+    def test_fastcall(self):
+        d = {1: 2}
+        self.assertEqual(d.get(1), 2)
+        self.assertEqual(d.get(3), None)
+        self.assertEqual(d.get(3, 4), 4)
+        self.assertEqual(d.get(*(1,)), 2)
+        self.assertRaises(TypeError, d.get)
+        self.assertRaises(TypeError, d.get, 1, 2, 3)
+        self.assertRaises(TypeError, d.get, 1, default=2)
+        self.assertEqual(getattr(d, "nothing", 5), 5)
+        self.assertRaises(TypeError, getattr, d)
+        self.assertRaises(TypeError, getattr, d, "nothing", x=5)
+
+    def test_fastcall_descr(self):
+        l = []
+        list.append(l, 1)
+        self.assertEqual(l, [1])
+        self.assertEqual(dict.get({1: 2}, 1), 2)
+        self.assertRaises(TypeError, list.append)
+        self.assertRaises(TypeError, list.append, (), 1)
+        self.assertRaises(TypeError, list.append, l, x=1)
+        class L(list):
+            pass
+        m = L()
+        list.append(m, 1)
+        self.assertEqual(m, [1])
+
+
+class PythonClassCalls(unittest.TestCase):
+
+    # Instances of classes with a Python __init__ and the default __new__
+    # are created without building an argument tuple.
+
+    def test_init(self):
+        class C(object):
+            def __init__(self, a, b=2, *args, **kw):
+                self.args = a, b, args, kw
+        self.assertEqual(C(1).args, (1, 2, (), {}))
+        self.assertEqual(C(1, 3, 4).args, (1, 3, (4,), {}))
+        self.assertEqual(C(b=3, a=1, c=4).args, (1, 3, (), {"c": 4}))
+        self.assertRaises(TypeError, C)
+        self.assertRaises(TypeError, C, 1, a=1)
+
+    def test_init_returns(self):
+        class C(object):
+            def __init__(self):
+                return 1
+        self.assertRaises(TypeError, C)
+
+    def test_abstract(self):
+        import abc
+        class A(object):
+            __metaclass__ = abc.ABCMeta
+            def __init__(self):
+                pass
+            @abc.abstractmethod
+            def f(self):
+                pass
+        self.assertRaises(TypeError, A)
+
+    def test_no_init(self):
+        class C(object):
+            pass
+        self.assertRaises(TypeError, C, 1)
+        self.assertEqual(type(1), int)
+
+
+class CallerCalls(unittest.TestCase):
+
+    def test_partial(self):
+        from functools import partial
+        def f(*args, **kw):
+            return args, kw
+        self.assertEqual(partial(f, 1)(2), ((1, 2), {}))
+        self.assertEqual(partial(f, 1, a=1)(2), ((1, 2), {"a": 1}))
+        self.assertEqual(partial(f, 1)(b=2), ((1,), {"b": 2}))
+        self.assertEqual(partial(f, a=1)(a=2, b=3), ((), {"a": 2, "b": 3}))
+
+    def test_iterators(self):
+        from itertools import imap, starmap, ifilter
+        from operator import methodcaller
+        self.assertEqual(list(imap(pow, [2, 3], [2, 2])), [4, 9])
+        self.assertEqual(list(starmap(pow, [(2, 3)])), [8])
+        self.assertEqual(list(ifilter(bool, [0, 1])), [1])
+        self.assertEqual(methodcaller("get", 1)({1: 2}), 2)
+        self.assertEqual(methodcaller("split", ",", 1)("a,b,c"), ["a", "b,c"])
+        self.assertRaises(TypeError, methodcaller("get"), {})
+
 
 def test_main():
-    test_support.run_unittest(CFunctionCalls)
+    test_support.run_unittest(CFunctionCalls, PythonClassCalls, CallerCalls)
 
 
 if __name__ == "__main__":
@@ -1302,6 +1302,172 @@ order (MRO) for bases """
             __metaclass__ = dynamicmetaclass
         self.assertNotEqual(someclass, object)
 
+    def test_attribute_cache(self):
+        # Testing the attribute caches of LOAD_ATTR and STORE_ATTR...
+        def get(obj):
+            return obj.x
+        def put(obj, value):
+            obj.x = value
+        class C(object):
+            x = "class"
+        c = C()
+        self.assertEqual(get(c), "class")
+        put(c, "instance")
+        self.assertEqual(get(c), "instance")
+        C.x = property(lambda self: "property")
+        self.assertEqual(get(c), "property")
+        self.assertRaises(AttributeError, put, c, 1)
+        del C.x
+        self.assertEqual(get(c), "instance")
+        del c.x
+        self.assertRaises(AttributeError, get, c)
+        c.__dict__ = {"x": "new dict"}
+        self.assertEqual(get(c), "new dict")
+        C.__getattribute__ = lambda self, name: "getattribute"
+        self.assertEqual(get(c), "getattribute")
+        del C.__getattribute__
+        self.assertEqual(get(c), "new dict")
+        # more types than a cache has entries
+        classes = [type("C%d" % i, (object,), {"x": i}) for i in range(10)]
+        for i in range(3):
+            self.assertEqual([get(cls()) for cls in classes], range(10))
+        class D(C):
+            __slots__ = ()
+        d = D()
+        put(d, 1)
+        self.assertEqual(get(d), 1)
+        d.__class__ = classes[5]
+        self.assertEqual(get(d), 1)
+        del d.x
+        self.assertEqual(get(d), 5)
+        class S(object):
+            __slots__ = ["x"]
+        s = S()
+        put(s, "slot")
+        self.assertEqual(get(s), "slot")
+        self.assertRaises(AttributeError, put, object(), 1)
+        class Classic:
+            x = "classic"
+        self.assertEqual(get(Classic()), "classic")
+        self.assertEqual(get(Classic), "classic")
+
+    def test_method_calls(self):
+        # Testing calls compiled to LOAD_METHOD and CALL_METHOD...
+        class C(object):
+            def m(self, *args):
+                return (self,) + args
+            @staticmethod
+            def s(*args):
+                return args
+            @classmethod
+            def k(cls, *args):
+                return (cls,) + args
+        c = C()
+        self.assertEqual(c.m(), (c,))
+        self.assertEqual(c.m(1, 2), (c, 1, 2))
+        self.assertEqual(c.s(1), (1,))
+        self.assertEqual(c.k(1), (C, 1))
+        self.assertEqual(C.k(1), (C, 1))
+        self.assertEqual(C.m(c, 1), (c, 1))
+        c.m = lambda *args: args
+        self.assertEqual(c.m(1), (1,))
+        del c.m
+        self.assertEqual(c.m(1), (c, 1))
+        self.assertRaises(AttributeError, lambda: c.missing(1))
+        self.assertRaises(TypeError, lambda: C.m())
+        args = range(254)
+        self.assertEqual(eval("c.m(%s)" % ", ".join(map(str, args))),
+                         (c,) + tuple(args))
+        def gen():
+            yield c.m((yield 1), 2)
+        g = gen()
+        self.assertEqual(g.next(), 1)
+        self.assertEqual(g.send(0), (c, 0, 2))
+        class G(object):
+            def __getattr__(self, name):
+                return lambda *args: (name,) + args
+        self.assertEqual(G().anything(1), ("anything", 1))
+        class Classic:
+            def m(self, x):
+                return x
+        self.assertEqual(Classic().m(5), 5)
+        self.assertEqual([].count(1), 0)
+
+    def test_shared_key_dicts(self):
+        # Testing instance dicts sharing their keys...
+        class C(object):
+            def __init__(self, i):
+                self.a = i
+                self.b = str(i)
+        objs = [C(i) for i in range(5)]
+        d = objs[1].__dict__
+        self.assertEqual(d, {"a": 1, "b": "1"})
+        self.assertEqual(sorted(d.items()), [("a", 1), ("b", "1")])
+        self.assertEqual(list(d.iteritems()), d.items())
+        self.assertTrue("a" in d and "c" not in d)
+        self.assertEqual(d.get("c", 42), 42)
+        del objs[1].a
+        self.assertEqual(d, {"b": "1"})
+        self.assertRaises(KeyError, d.__delitem__, "a")
+        objs[1].c = None
+        self.assertEqual(sorted(d), ["b", "c"])
+        self.assertEqual(objs[2].__dict__, {"a": 2, "b": "2"})
+        d.clear()
+        self.assertEqual(d, {})
+        objs[1].a = 1
+        self.assertEqual(d, {"a": 1})
+        # keys that cannot be shared
+        d[1] = 2
+        self.assertEqual(d, {"a": 1, 1: 2})
+        for i in range(50):
+            setattr(objs[3], "x%d" % i, i)
+        self.assertEqual(len(objs[3].__dict__), 52)
+        self.assertEqual(objs[3].x49, 49)
+        self.assertEqual(objs[4].__dict__, {"a": 4, "b": "4"})
+        # whole dict operations
+        d = objs[4].__dict__
+        self.assertEqual(d.copy(), {"a": 4, "b": "4"})
+        d.update(a=0, c=1)
+        self.assertEqual(d, {"a": 0, "b": "4", "c": 1})
+        self.assertEqual(d.popitem()[0] in "abc", True)
+        self.assertEqual(len(d), 2)
+        exec "x = a = 5" in objs[0].__dict__
+        self.assertEqual((objs[0].x, objs[0].a), (5, 5))
+        e = C(5).__dict__
+        self.assertEqual(cmp(e, dict(e)), 0)
+        # the keys outlive their class
+        d = C(6).__dict__
+        del C, objs
+        test_support.gc_collect()
+        self.assertEqual(d, {"a": 6, "b": "6"})
+
+    def test_shared_key_dicts_lookup(self):
+        # Testing lookups in a shared key dict while iterating over it...
+        class C(object):
+            pass
+        o = C()
+        names = ["a%d" % i for i in range(10)]
+        for i, name in enumerate(names):
+            setattr(o, name, i)
+        d = o.__dict__
+        seen = []
+        for i, key in enumerate(d):
+            seen.append(key)
+            if i == 5:
+                self.assertFalse(1 in d)
+                self.assertEqual(d.get(1), None)
+                self.assertEqual(d[u"a3"], 3)
+                self.assertTrue(u"a4" in d)
+                self.assertEqual(d.setdefault(u"a5"), 5)
+                self.assertEqual(d.pop(2, None), None)
+                self.assertRaises(KeyError, d.__delitem__, 2)
+                self.assertEqual(cmp(d, dict(d)), 0)
+        self.assertEqual(sorted(seen), sorted(names))
+        # keys of another type that are equal to a shared key
+        self.assertEqual(d.pop(u"a0"), 0)
+        del d[u"a1"]
+        self.assertEqual(sorted(d), sorted(names[2:]))
+
     def test_errors(self):
         # Testing errors...
         try:
@@ -16,7 +16,7 @@ dis_f = """\
               3 PRINT_ITEM
               4 PRINT_NEWLINE
 
- %-4d         5 LOAD_CONST               1 (1)
+ %-4d         5 LOAD_CONST_RETURN_VALUE     1 (1)
               8 RETURN_VALUE
 """%(_f.func_code.co_firstlineno + 1,
      _f.func_code.co_firstlineno + 2)
@@ -40,7 +40,7 @@ dis_bug708901 = """\
 
  %-4d        22 JUMP_ABSOLUTE           16
         >>   25 POP_BLOCK
-        >>   26 LOAD_CONST               0 (None)
+        >>   26 LOAD_CONST_RETURN_VALUE     0 (None)
              29 RETURN_VALUE
 """%(bug708901.func_code.co_firstlineno + 1,
      bug708901.func_code.co_firstlineno + 2,
@@ -60,7 +60,7 @@ dis_bug1333982 = """\
              12 LOAD_FAST                0 (x)
              15 GET_ITER
         >>   16 FOR_ITER                12 (to 31)
-             19 STORE_FAST               1 (s)
+             19 STORE_FAST_LOAD_FAST     1 (s)
              22 LOAD_FAST                1 (s)
              25 LIST_APPEND              2
              28 JUMP_ABSOLUTE           16
@@ -69,7 +69,7 @@ dis_bug1333982 = """\
              34 BINARY_ADD
              35 RAISE_VARARGS            2
 
- %-4d   >>   38 LOAD_CONST               0 (None)
+ %-4d   >>   38 LOAD_CONST_RETURN_VALUE     0 (None)
              41 RETURN_VALUE
 """%(bug1333982.func_code.co_firstlineno + 1,
      bug1333982.func_code.co_firstlineno + 2,
@@ -78,10 +78,16 @@ dis_bug1333982 = """\
 _BIG_LINENO_FORMAT = """\
 %3d           0 LOAD_GLOBAL              0 (spam)
               3 POP_TOP
-              4 LOAD_CONST               0 (None)
+              4 %s0 (None)
               7 RETURN_VALUE
 """
 
+def _big_lineno_expected(lineno):
+    # The peephole optimizer leaves code with line gaps >= 255 alone
+    if lineno < 256:
+        return _BIG_LINENO_FORMAT % (lineno, "LOAD_CONST_RETURN_VALUE     ")
+    return _BIG_LINENO_FORMAT % (lineno, "LOAD_CONST               ")
+
 class DisTests(unittest.TestCase):
     def do_disassembly_test(self, func, expected):
         s = StringIO.StringIO()
@@ -134,12 +140,12 @@ class DisTests(unittest.TestCase):
 
         # Test all small ranges
         for i in xrange(1, 300):
-            expected = _BIG_LINENO_FORMAT % (i + 2)
+            expected = _big_lineno_expected(i + 2)
             self.do_disassembly_test(func(i), expected)
 
         # Test some larger ranges too
         for i in xrange(300, 5000, 10):
-            expected = _BIG_LINENO_FORMAT % (i + 2)
+            expected = _big_lineno_expected(i + 2)
             self.do_disassembly_test(func(i), expected)
 
 def test_main():
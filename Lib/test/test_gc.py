@@ -1,5 +1,5 @@
 import unittest
-from test.test_support import verbose, run_unittest
+from test.test_support import verbose, run_unittest, captured_output
 import sys
 import gc
 import weakref
@@ -264,6 +264,121 @@ class GCTests(unittest.TestCase):
         gc.collect(2)
         assertEqual(gc.get_count(), (0, 0, 0))
 
+    def test_incremental(self):
+        enabled, budget = gc.get_incremental()
+        self.assertRaises(ValueError, gc.set_incremental, True, 0)
+        histogram = gc.get_pause_histogram()
+        self.assertEqual(len(histogram), 16)
+        self.assertEqual(histogram[-1][0], None)
+        gc.set_incremental(True, 0.001)
+        try:
+            self.assertEqual(gc.get_incremental(), (True, 0.001))
+            class A:
+                pass
+            a = A()
+            a.a = a
+            wr = weakref.ref(a)
+            gc.collect()
+            del a
+            # the cycle is in the oldest generation; slices find it
+            gc.enable()
+            try:
+                junk = []
+                for i in xrange(1000000):
+                    junk.append([])
+                    if wr() is None:
+                        break
+            finally:
+                gc.disable()
+            del junk
+            self.assertEqual(wr(), None)
+            after = gc.get_pause_histogram()
+            self.assertTrue(sum(n for limit, n in after) >
+                            sum(n for limit, n in histogram))
+        finally:
+            gc.set_incremental(enabled, budget)
+        self.assertEqual(gc.get_incremental(), (enabled, budget))
+
+    def test_freeze(self):
+        class A:
+            pass
+        a = A()
+        a.a = a
+        wr = weakref.ref(a)
+        del a
+        gc.freeze()
+        try:
+            self.assertTrue(gc.get_freeze_count() > 0)
+            gc.collect()
+            # frozen cycles are not found
+            self.assertNotEqual(wr(), None)
+            self.assertTrue(wr() in gc.get_objects())
+        finally:
+            gc.unfreeze()
+        self.assertEqual(gc.get_freeze_count(), 0)
+        gc.collect()
+        self.assertEqual(wr(), None)
+
+    def test_stats(self):
+        before = gc.get_stats()
+        self.assertEqual(len(before), 3)
+        class A:
+            pass
+        a = A()
+        a.a = a
+        del a
+        gc.collect(1)
+        after = gc.get_stats()
+        self.assertEqual(after[0], before[0])
+        self.assertEqual(after[1]["collections"],
+                         before[1]["collections"] + 1)
+        self.assertTrue(after[1]["collected"] >= before[1]["collected"] + 2)
+        self.assertTrue(after[1]["max_pause"] <= after[1]["total_pause"])
+
+    def test_callbacks(self):
+        calls = []
+        def cb(phase, info):
+            calls.append((phase, info))
+        def bad(phase, info):
+            raise ValueError
+        gc.callbacks[:] = [bad, cb]
+        try:
+            class A:
+                pass
+            a = A()
+            a.a = a
+            del a
+            with captured_output("stderr"):
+                gc.collect()
+        finally:
+            gc.callbacks[:] = []
+        self.assertEqual([phase for phase, info in calls], ["start", "stop"])
+        self.assertEqual(calls[0][1],
+            {"generation": 2, "collected": 0, "uncollectable": 0})
+        self.assertEqual(calls[1][1]["generation"], 2)
+        self.assertTrue(calls[1][1]["collected"] >= 2)
+
+    def test_adaptive_threshold(self):
+        thresholds = gc.get_threshold()
+        try:
+            gc.set_threshold(100, 10, 10, adaptive=True)
+            # collections which find no garbage raise the threshold
+            for i in range(10):
+                gc.collect(0)
+            self.assertEqual(gc.get_threshold()[0], 1600)
+            # collections which find a lot of it lower it again
+            for i in range(10):
+                for j in range(10):
+                    l = []
+                    l.append(l)
+                del l
+                gc.collect(0)
+            self.assertEqual(gc.get_threshold()[0], 100)
+            gc.set_threshold(100)
+            self.assertEqual(gc.get_threshold(), (100, 10, 10))
+        finally:
+            gc.set_threshold(*thresholds)
+
     def test_trashcan(self):
         class Ouch:
             n = 0
@@ -108,6 +108,44 @@ class OpcodeTest(unittest.TestCase):
                 return 42
         self.assertEqual(MyString() % 3, 42)
 
+    def test_quickening(self):
+        # Hot code is rewritten to specialized instructions, which must
+        # fall back to the generic ones for other types.
+        import opcode, sys
+        def add(a, b): return a + b
+        def getitem(a, b): return a[b]
+        def less(a, b): return a < b
+        def equal(a, b): return a == b
+        sys.setopcodeprofile(True)
+        try:
+            sys.getopcodeprofile()
+            for i in range(100):
+                self.assertEqual(add(i, 1), i + 1)
+                self.assertEqual(getitem([0, i], 1), i)
+                self.assertTrue(less(0.5, i + 0.75))
+                self.assertTrue(equal('x', 'x'))
+            counts = sys.getopcodeprofile()
+        finally:
+            sys.setopcodeprofile(False)
+        for name in ('BINARY_ADD_INT', 'BINARY_SUBSCR_LIST_INT',
+                     'COMPARE_OP_FLOAT', 'COMPARE_OP_STR'):
+            self.assertGreater(counts[opcode.opmap[name]], 0, name)
+        self.assertEqual(add(sys.maxint, 1), sys.maxint + 1)
+        self.assertEqual(add(1.5, 1), 2.5)
+        self.assertEqual(add('a', 'b'), 'ab')
+        self.assertEqual(getitem([1, 2], -1), 2)
+        self.assertRaises(IndexError, getitem, [1, 2], 2)
+        self.assertEqual(getitem({1: 2}, 1), 2)
+        self.assertEqual(getitem('ab', 1), 'b')
+        self.assertTrue(less(1, 2))
+        self.assertFalse(less(float('nan'), 1.0))
+        self.assertTrue(equal(u'x', 'x'))
+        self.assertFalse(equal(1, 'x'))
+        for i in range(100):
+            self.assertEqual(getitem({'a': i}, 'a'), i)
+        self.assertRaises(KeyError, getitem, {}, 'a')
+        self.assertEqual(getitem([3], 0), 3)
+
 
 def test_main():
     with check_py3k_warnings(("exceptions must derive from BaseException",
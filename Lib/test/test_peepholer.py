@@ -201,6 +201,32 @@ class TestTranforms(unittest.TestCase):
         self.assertEqual(asm.split().count('JUMP_ABSOLUTE'), 1)
         self.assertEqual(asm.split().count('RETURN_VALUE'), 2)
 
+    def test_superinstructions(self):
+        # LOAD_FAST LOAD_FAST  -->  LOAD_FAST_LOAD_FAST LOAD_FAST
+        def f(a, b):
+            c = a + b; return c < a
+        asm = disassemble(f)
+        for elem in ('LOAD_FAST_LOAD_FAST', 'STORE_FAST_LOAD_FAST'):
+            self.assertIn(elem, asm)
+        self.assertEqual(f(1, 2), False)
+        # A pair is not fused when its second instruction starts a line
+        def f(a):
+            a = 1
+            return a
+        asm = disassemble(f)
+        self.assertNotIn('STORE_FAST_LOAD_FAST', asm)
+        # COMPARE_OP POP_JUMP_IF_FALSE  -->  COMPARE_OP_POP_JUMP_IF_FALSE
+        def f(a, b):
+            if a < b:
+                return a.real
+            return 2
+        asm = disassemble(f)
+        for elem in ('COMPARE_OP_POP_JUMP_IF_FALSE', 'LOAD_FAST_LOAD_ATTR',
+                     'LOAD_CONST_RETURN_VALUE'):
+            self.assertIn(elem, asm)
+        self.assertEqual(f(1, 2), 1)
+        self.assertEqual(f(2, 1), 2)
+
 
 def test_main(verbose=None):
     import sys
@@ -647,6 +647,38 @@ result2 = h()
         self.assertEqual(2, global_ns["result2"])
         self.assertEqual(9, global_ns["result9"])
 
+    def testGlobalLookupCache(self):
+        # LOAD_GLOBAL caches its result until the globals or the
+        # builtins change.
+        CODE = """def f():
+    return len, x
+"""
+        ns = {"x": 1}
+        exec CODE in ns
+        f = ns["f"]
+        self.assertEqual(f(), (len, 1))
+        self.assertEqual(f(), (len, 1))
+        ns["x"] = 2
+        self.assertEqual(f(), (len, 2))
+        ns["len"] = 3
+        self.assertEqual(f(), (3, 2))
+        del ns["len"]
+        self.assertEqual(f(), (len, 2))
+        ns["y"] = 0
+        self.assertEqual(f(), (len, 2))
+        ns.pop("x")
+        self.assertRaises(NameError, f)
+        ns.update(x=4)
+        self.assertEqual(f(), (len, 4))
+        ns.clear()
+        ns["__builtins__"] = {"len": 5}
+        ns["x"] = 6
+        self.assertEqual(f(), (5, 6))
+        # the same code with other globals
+        g = type(f)(f.func_code, {"x": 7, "len": 8})
+        self.assertEqual(g(), (8, 7))
+        self.assertEqual(f(), (5, 6))
+
 
 def test_main():
     with check_warnings(("import \* only allowed at module level",
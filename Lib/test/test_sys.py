@@ -221,6 +221,49 @@ class SysModuleTest(unittest.TestCase):
             sys.setcheckinterval(n)
             self.assertEquals(sys.getcheckinterval(), n)
 
+    def test_switchinterval(self):
+        self.assertRaises(TypeError, sys.setswitchinterval)
+        self.assertRaises(TypeError, sys.setswitchinterval, "a")
+        self.assertRaises(ValueError, sys.setswitchinterval, -1.0)
+        self.assertRaises(ValueError, sys.setswitchinterval, 0.0)
+        self.assertRaises(ValueError, sys.setswitchinterval, float("nan"))
+        orig = sys.getswitchinterval()
+        # sanity check
+        self.assertTrue(orig < 0.5, orig)
+        try:
+            for n in 0.00001, 0.05, 3.0, orig:
+                sys.setswitchinterval(n)
+                self.assertAlmostEquals(sys.getswitchinterval(), n)
+        finally:
+            sys.setswitchinterval(orig)
+
+    @test.test_support.reap_threads
+    def test_switchinterval_latency(self):
+        # A busy thread must let a waiting thread in after about one
+        # switch interval, even if its check interval never runs out.
+        import thread, time
+        orig = sys.getcheckinterval()
+        started = []
+        done = []
+        def busy():
+            started.append(True)
+            while not done:
+                pass
+        sys.setcheckinterval(10**9)
+        try:
+            thread.start_new_thread(busy, ())
+            while not started:
+                time.sleep(0.001)
+            worst = 0.0
+            for i in range(10):
+                t = time.time()
+                time.sleep(0.001)
+                worst = max(worst, time.time() - t)
+        finally:
+            done.append(True)
+            sys.setcheckinterval(orig)
+        self.assertTrue(worst < 1.0, worst)
+
     def test_recursionlimit(self):
         self.assertRaises(TypeError, sys.getrecursionlimit, 42)
         oldlimit = sys.getrecursionlimit()
@@ -230,6 +273,79 @@ class SysModuleTest(unittest.TestCase):
         self.assertEqual(sys.getrecursionlimit(), 10000)
         sys.setrecursionlimit(oldlimit)
 
+    def test_opcodeprofile(self):
+        import opcode
+        def f(n):
+            for i in xrange(n):
+                pass
+        self.assertRaises(TypeError, sys.setopcodeprofile)
+        sys.setopcodeprofile(True)
+        try:
+            sys.getopcodeprofile()
+            f(100)
+            counts = sys.getopcodeprofile()
+            self.assertEqual(len(counts), 256)
+            self.assertGreaterEqual(counts[opcode.opmap['FOR_ITER']], 101)
+            sys.setopcodeprofile(True, True)
+            f(100)
+            pairs = sys.getopcodeprofile()
+            self.assertEqual(len(pairs), 257)
+            for_iter = opcode.opmap['FOR_ITER']
+            store = opcode.opmap['STORE_FAST']
+            self.assertGreaterEqual(pairs[for_iter][store], 100)
+            self.assertGreaterEqual(pairs[256][for_iter], 101)
+        finally:
+            sys.setopcodeprofile(False)
+            sys.getopcodeprofile()
+        # the last counts can be read after stopping
+        f(100)
+        self.assertEqual(sum(sys.getopcodeprofile()[256]), 0)
+        sys.setopcodeprofile(True)
+        sys.setopcodeprofile(False)
+        self.assertEqual(len(sys.getopcodeprofile()), 256)
+
+    def test_execcount(self):
+        def f():
+            yield 1
+            yield 2
+        count = f.func_code.co_execcount
+        for i in range(3):
+            list(f())
+        self.assertEqual(f.func_code.co_execcount, count + 3)
+
+    def test_framepool(self):
+        def f(n):
+            if n:
+                return f(n - 1)
+            return sys.getframepoolstats()
+        limit = sys.getframepoolstats()["limit"]
+        self.assertRaises(ValueError, sys.setframepoollimit, -1)
+        self.assertRaises(TypeError, sys.setframepoollimit)
+        try:
+            sys.setframepoollimit(100)
+            f(20)
+            # one frame is kept by the code object, the others are pooled
+            before = sys.getframepoolstats()
+            self.assertEqual(before["limit"], 100)
+            self.assertTrue(before["count"] >= 20)
+            during = f(20)
+            self.assertEqual(during["hits"], before["hits"] + 20)
+            self.assertEqual(during["misses"], before["misses"])
+            sys.setframepoollimit(0)
+            self.assertEqual(sys.getframepoolstats()["count"], 0)
+            released = sys.getframepoolstats()["released"]
+            f(20)
+            self.assertEqual(sys.getframepoolstats()["released"],
+                             released + 20)
+            sys.setframepoollimit(100)
+            f(20)
+            self.assertTrue(sys.getframepoolstats()["count"] > 0)
+            import gc
+            gc.collect()
+            self.assertEqual(sys.getframepoolstats()["count"], 0)
+        finally:
+            sys.setframepoollimit(limit)
+
     def test_getwindowsversion(self):
         # Raise SkipTest if sys doesn't have getwindowsversion attribute
         test.test_support.get_attribute(sys, "getwindowsversion")
@@ -578,7 +694,7 @@ class SizeofTest(unittest.TestCase):
         # complex
         check(complex(0,1), size(h + '2d'))
         # code
-        check(get_cell().func_code, size(h + '4i8Pi3P'))
+        check(get_cell().func_code, size(h + '4i8Pi5PliP'))
         # BaseException
         check(BaseException(), size(h + '3P'))
         # UnicodeEncodeError
@@ -606,9 +722,14 @@ class SizeofTest(unittest.TestCase):
         # method-wrapper (descriptor object)
         check({}.__iter__, size(h + '2P'))
         # dict
-        check({}, size(h + '3P2P' + 8*'P2P'))
+        check({}, size(h + '3P2PQ2P' + 8*'P2P'))
         x = {1:1, 2:2, 3:3, 4:4, 5:5, 6:6, 7:7, 8:8}
-        check(x, size(h + '3P2P' + 8*'P2P') + 16*size('P2P'))
+        check(x, size(h + '3P2PQ2P' + 8*'P2P') + 16*size('P2P'))
+        # split instance dict, without the small table
+        class C(object):
+            def __init__(self):
+                self.a = self.b = self.c = None
+        check(C().__dict__, size(h + '3P2PQ2P') + 3*size('P'))
         # dictionary-keyiterator
         check({}.iterkeys(), size(h + 'P2PPP'))
         # dictionary-valueiterator
@@ -750,7 +871,7 @@ class SizeofTest(unittest.TestCase):
             stacklessSize = ' 83c'
         else:
             stacklessSize = ''
-        s = size(vh + 'P2P15Pl4PP9PP11PI') + size('41P 10P 3P 6P' + stacklessSize)
+        s = size(vh + 'P2P15Pl4PP9PP11PI') + size('41P 10P 3P 7P' + stacklessSize)
         class newstyleclass(object):
             pass
         check(newstyleclass, s)
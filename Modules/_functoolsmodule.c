@@ -162,6 +162,55 @@ partial_dealloc(partialobject *pto)
     Py_TYPE(pto)->tp_free(pto);
 }
 
+/* The arguments of most calls fit on the C stack */
+#define SMALL_STACK 8
+
+/* Call the function with the arguments in a C array, when there is no
+   need to merge keyword arguments */
+static PyObject *
+partial_fastcall(partialobject *pto, PyObject *args, PyObject *kw)
+{
+    PyObject *small_stack[SMALL_STACK];
+    PyObject **stack, *key, *value, *ret, *fn, *partial_args;
+    Py_ssize_t npartial, nargs, nkws, i, pos;
+
+    npartial = PyTuple_GET_SIZE(pto->args);
+    nargs = npartial + PyTuple_GET_SIZE(args);
+    nkws = kw == NULL ? 0 : PyDict_Size(kw);
+    if (nargs + 2*nkws <= SMALL_STACK)
+        stack = small_stack;
+    else {
+        stack = PyMem_NEW(PyObject *, nargs + 2*nkws);
+        if (stack == NULL)
+            return PyErr_NoMemory();
+    }
+    for (i = 0; i < npartial; i++)
+        stack[i] = PyTuple_GET_ITEM(pto->args, i);
+    for (; i < nargs; i++)
+        stack[i] = PyTuple_GET_ITEM(args, i - npartial);
+    pos = 0;
+    while (nkws > 0 && PyDict_Next(kw, &pos, &key, &value)) {
+        Py_INCREF(key);
+        stack[i++] = key;
+        Py_INCREF(value);
+        stack[i++] = value;
+    }
+    nkws = (i - nargs) / 2;
+    /* the call may replace the state of the partial object */
+    fn = pto->fn;
+    partial_args = pto->args;
+    Py_INCREF(fn);
+    Py_INCREF(partial_args);
+    ret = _PyObject_FastCall(fn, stack, nargs, stack + nargs, nkws);
+    Py_DECREF(fn);
+    Py_DECREF(partial_args);
+    for (i = nargs; i < nargs + 2*nkws; i++)
+        Py_DECREF(stack[i]);
+    if (stack != small_stack)
+        PyMem_FREE(stack);
+    return ret;
+}
+
 static PyObject *
 partial_call(partialobject *pto, PyObject *args, PyObject *kw)
 {
@@ -172,6 +221,11 @@ partial_call(partialobject *pto, PyObject *args, PyObject *kw)
     assert (PyTuple_Check(pto->args));
     assert (pto->kw == Py_None  ||  PyDict_Check(pto->kw));
 
+    if (pto->kw == Py_None || PyDict_Size(pto->kw) == 0)
+        return partial_fastcall(pto, args, kw);
+    if (kw == NULL || PyDict_Size(kw) == 0)
+        return partial_fastcall(pto, args, pto->kw);
+
     if (PyTuple_GET_SIZE(pto->args) == 0) {
         argappl = args;
         Py_INCREF(args);
@@ -1994,7 +1994,6 @@ join_list(PyObject* list, PyObject* string)
     PyObject* joiner;
 #if PY_VERSION_HEX >= 0x01060000
     PyObject* function;
-    PyObject* args;
 #endif
     PyObject* result;
 
@@ -2013,15 +2012,8 @@ join_list(PyObject* list, PyObject* string)
         Py_DECREF(joiner);
         return NULL;
     }
-    args = PyTuple_New(1);
-    if (!args) {
-        Py_DECREF(function);
-        Py_DECREF(joiner);
-        return NULL;
-    }
-    PyTuple_SET_ITEM(args, 0, list);
-    result = PyObject_CallObject(function, args);
-    Py_DECREF(args); /* also removes list */
+    result = _PyObject_FastCall(function, &list, 1, NULL, 0);
+    Py_DECREF(list);
     Py_DECREF(function);
 #else
     result = call(
@@ -2282,7 +2274,6 @@ pattern_subx(PatternObject* self, PyObject* ptemplate, PyObject* string,
     PyObject* list;
     PyObject* item;
     PyObject* filter;
-    PyObject* args;
     PyObject* match;
     void* ptr;
     int status;
@@ -2390,13 +2381,7 @@ pattern_subx(PatternObject* self, PyObject* ptemplate, PyObject* string,
             match = pattern_new_match(self, &state, 1);
             if (!match)
                 goto error;
-            args = PyTuple_Pack(1, match);
-            if (!args) {
-                Py_DECREF(match);
-                goto error;
-            }
-            item = PyObject_CallObject(filter, args);
-            Py_DECREF(args);
+            item = _PyObject_FastCall(filter, &match, 1, NULL, 0);
             Py_DECREF(match);
             if (!item)
                 goto error;
@@ -1207,6 +1207,39 @@ test_null_strings(PyObject *self)
     return tuple;
 }
 
+/* PyObject_Free and PyObject_Realloc accept memory from PyMem_MALLOC.
+   Tasklet memory accounting must not mistake it for its own. */
+
+static PyObject *
+test_pyobject_free_foreign(PyObject *self)
+{
+    static size_t sizes[] = {1, 24, 100, 500, 1000, 5000, 200000};
+    size_t i;
+
+    for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        char *p = (char *) PyMem_MALLOC(sizes[i]);
+
+        if (p == NULL)
+            return PyErr_NoMemory();
+        memset(p, 0x5a, sizes[i]);
+        PyObject_Free(p);
+        p = (char *) PyMem_MALLOC(sizes[i]);
+        if (p == NULL)
+            return PyErr_NoMemory();
+        p[0] = 42;
+        p = (char *) PyObject_Realloc(p, 2 * sizes[i]);
+        if (p == NULL)
+            return PyErr_NoMemory();
+        if (p[0] != 42) {
+            PyObject_Free(p);
+            return raiseTestError("test_pyobject_free_foreign",
+                                  "PyObject_Realloc lost the data");
+        }
+        PyObject_Free(p);
+    }
+    Py_RETURN_NONE;
+}
+
 static PyObject *
 raise_exception(PyObject *self, PyObject *args)
 {
@@ -1654,6 +1687,8 @@ static PyMethodDef TestMethods[] = {
     {"test_k_code",             (PyCFunction)test_k_code,        METH_NOARGS},
     {"test_empty_argparse", (PyCFunction)test_empty_argparse,METH_NOARGS},
     {"test_null_strings",       (PyCFunction)test_null_strings,  METH_NOARGS},
+    {"test_pyobject_free_foreign", (PyCFunction)test_pyobject_free_foreign,
+     METH_NOARGS},
     {"test_string_from_format", (PyCFunction)test_string_from_format, METH_NOARGS},
     {"test_with_docstring", (PyCFunction)test_with_docstring, METH_NOARGS,
      PyDoc_STR("This is a pretty normal docstring.")},
@@ -21,6 +21,10 @@
 #include "Python.h"
 #include "frameobject.h"        /* for PyFrame_ClearFreeList */
 
+#ifdef MS_WINDOWS
+#include <windows.h>            /* for QueryPerformanceCounter */
+#endif
+
 /* Get an object's GC head */
 #define AS_GC(o) ((PyGC_Head *)(o)-1)
 
@@ -49,6 +53,11 @@ static struct gc_generation generations[NUM_GENERATIONS] = {
 
 PyGC_Head *_PyGC_generation0 = GEN_HEAD(0);
 
+/* objects which are never examined by collections, see _PyObject_GC_Freeze */
+static PyGC_Head permanent_generation = {
+    {&permanent_generation, &permanent_generation, 0}
+};
+
 static int enabled = 1; /* automatic collection enabled? */
 
 /* true if we are currently running the collector */
@@ -76,6 +85,73 @@ static Py_ssize_t long_lived_total = 0;
 */
 static Py_ssize_t long_lived_pending = 0;
 
+/*
+   Incremental collection of the oldest generation.
+
+   In incremental mode, a collection of the oldest generation is spread
+   over a round of slices, which run whenever a collection of the young
+   generations is due. Every slice is a complete collection of its own:
+   it takes a chunk of the oldest generation, adds what the chunk
+   reaches in the older generations up to a limit, and collects that
+   set together with the young generations. Objects referenced from outside the set count
+   as reachable, so collecting a part of the heap is always safe.
+
+   The survivors of a slice go to inc_visited. When the oldest
+   generation is used up, the round is over and inc_visited becomes
+   the oldest generation again. The chunk size adapts, so that a slice
+   takes about slice_budget seconds. Garbage cycles which do not fit
+   into the limit survive the round, a full gc.collect() finds them.
+*/
+static int incremental = 0;
+static double slice_budget = 0.002;
+static Py_ssize_t slice_size = 1000;
+static int inc_active = 0;              /* a round is in progress */
+static PyGC_Head inc_visited = {
+    {&inc_visited, &inc_visited, 0}
+};
+
+#define SLICE_SIZE_MIN 100
+/* a slice adds at most this many times its chunk by reachability */
+#define SLICE_PULL_FACTOR 4
+
+/* The pause times of all collections and slices. Bucket i counts the
+   pauses shorter than PAUSE_UNIT * 2**i, the last bucket all others. */
+#define PAUSE_BUCKETS 16
+#define PAUSE_UNIT 0.0001
+static Py_ssize_t pause_histogram[PAUSE_BUCKETS];
+
+/* Statistics of the collections of every generation, reported by
+   get_stats(). Slices count as collections of the oldest generation. */
+struct gc_generation_stats {
+    Py_ssize_t collections;
+    Py_ssize_t collected;
+    Py_ssize_t uncollectable;
+    double total_pause;
+    double max_pause;
+};
+static struct gc_generation_stats generation_stats[NUM_GENERATIONS];
+
+/* list of functions called before and after every collection */
+static PyObject *callbacks = NULL;
+
+/*
+   Adaptive thresholds.
+
+   In adaptive mode, the thresholds set by set_threshold() are lower
+   bounds, and every collection adjusts the threshold of its generation
+   between them and ADAPTIVE_MAX_FACTOR times them. A collection which
+   finds less than 1% of the objects it examines to be garbage was
+   mostly wasted work, so the threshold is doubled. One which finds
+   more than 10%, or a collection of a young generation which takes
+   longer than ADAPTIVE_MAX_PAUSE, halves it again. Slices of
+   incremental collections are not taken into account.
+*/
+static int adaptive = 0;
+static int base_thresholds[NUM_GENERATIONS] = {700, 10, 10};
+
+#define ADAPTIVE_MAX_FACTOR 16
+#define ADAPTIVE_MAX_PAUSE 0.005
+
 /*
    NOTE: about the counting of long-lived objects.
 
@@ -130,7 +206,7 @@ static PyObject *tmod = NULL;
 /*--------------------------------------------------------------------------
 gc_refs values.
 
-Between collections, every gc'ed object has one of two gc_refs values:
+Between collections, every gc'ed object has one of three gc_refs values:
 
 GC_UNTRACKED
     The initial state; objects returned by PyObject_GC_Malloc are in this
@@ -142,6 +218,11 @@ GC_REACHABLE
     call.  An object transitions to GC_REACHABLE when PyObject_GC_Track
     is called.
 
+GC_FROZEN
+    The object lives in the permanent generation, see _PyObject_GC_Freeze.
+    Collections treat it like GC_REACHABLE, but incremental slices never
+    take it into their set.
+
 During a collection, gc_refs can temporarily take on other states:
 
 >= 0
@@ -169,6 +250,7 @@ GC_TENTATIVELY_UNREACHABLE
 #define GC_UNTRACKED                    _PyGC_REFS_UNTRACKED
 #define GC_REACHABLE                    _PyGC_REFS_REACHABLE
 #define GC_TENTATIVELY_UNREACHABLE      _PyGC_REFS_TENTATIVELY_UNREACHABLE
+#define GC_FROZEN                       _PyGC_REFS_FROZEN
 
 #define IS_TRACKED(o) ((AS_GC(o))->gc.gc_refs != GC_UNTRACKED)
 #define IS_REACHABLE(o) ((AS_GC(o))->gc.gc_refs == GC_REACHABLE)
@@ -283,11 +365,12 @@ append_objects(PyObject *py_list, PyGC_Head *gc_list)
  * in containers, and is GC_REACHABLE for all tracked gc objects not in
  * containers.
  */
-static void
+static Py_ssize_t
 update_refs(PyGC_Head *containers)
 {
+    Py_ssize_t n = 0;
     PyGC_Head *gc = containers->gc.gc_next;
-    for (; gc != containers; gc = gc->gc.gc_next) {
+    for (; gc != containers; gc = gc->gc.gc_next, n++) {
         assert(gc->gc.gc_refs == GC_REACHABLE);
         gc->gc.gc_refs = Py_REFCNT(FROM_GC(gc));
         /* Python's cyclic gc should never see an incoming refcount
@@ -310,6 +393,7 @@ update_refs(PyGC_Head *containers)
          */
         assert(gc->gc.gc_refs != 0);
     }
+    return n;
 }
 
 /* A traversal callback for subtract_refs. */
@@ -381,11 +465,13 @@ visit_reachable(PyObject *op, PyGC_Head *reachable)
          * generation so we don't care about it, or move_unreachable
          * already dealt with it.
          * If gc_refs == GC_UNTRACKED, it must be ignored.
+         * If gc_refs == GC_FROZEN, it is in the permanent generation.
          */
          else {
             assert(gc_refs > 0
                    || gc_refs == GC_REACHABLE
-                   || gc_refs == GC_UNTRACKED);
+                   || gc_refs == GC_UNTRACKED
+                   || gc_refs == GC_FROZEN);
          }
     }
     return 0;
@@ -456,6 +542,44 @@ move_unreachable(PyGC_Head *young, PyGC_Head *unreachable)
     }
 }
 
+/* The number of objects pull_reachable may still add. */
+static Py_ssize_t pull_budget;
+
+/* A traversal callback for pull_reachable. */
+static int
+visit_pull(PyObject *op, PyGC_Head *young)
+{
+    if (PyObject_IS_GC(op) && pull_budget > 0) {
+        PyGC_Head *gc = AS_GC(op);
+
+        /* positive gc_refs are in young already, frozen ones stay out */
+        if (gc->gc.gc_refs == GC_REACHABLE) {
+            gc_list_move(gc, young);
+            gc->gc.gc_refs = Py_REFCNT(op);
+            --pull_budget;
+        }
+    }
+    return 0;
+}
+
+/* Add the objects reached from young, which are in no other collection
+ * and are not frozen, to young, until limit objects have been added.
+ * The added objects get their gc_refs like update_refs() does it.
+ */
+static void
+pull_reachable(PyGC_Head *young, Py_ssize_t limit)
+{
+    PyGC_Head *gc;
+
+    pull_budget = limit;
+    for (gc = young->gc.gc_next; gc != young && pull_budget > 0;
+         gc = gc->gc.gc_next) {
+        traverseproc traverse = Py_TYPE(FROM_GC(gc))->tp_traverse;
+
+        (void) traverse(FROM_GC(gc), (visitproc)visit_pull, (void *)young);
+    }
+}
+
 /* STACKLESS addition to support collection of tasklets */
 
 /* A traversal callback for has_finalisers.  It is a dummy, used to identify
@@ -854,28 +978,209 @@ get_time(void)
     return result;
 }
 
+/* A cheap clock for pause times, which does not call into Python. */
+static double
+gc_clock(void)
+{
+#ifdef MS_WINDOWS
+    static LARGE_INTEGER freq;
+    LARGE_INTEGER now;
+
+    if (freq.QuadPart == 0 && !QueryPerformanceFrequency(&freq))
+        return 0.0;
+    QueryPerformanceCounter(&now);
+    return (double) now.QuadPart / (double) freq.QuadPart;
+#elif defined(HAVE_GETTIMEOFDAY)
+    struct timeval t;
+#ifdef GETTIMEOFDAY_NO_TZ
+    gettimeofday(&t);
+#else
+    gettimeofday(&t, (struct timezone *)NULL);
+#endif
+    return (double)t.tv_sec + t.tv_usec*0.000001;
+#else
+    return 0.0;
+#endif
+}
+
+static void
+record_stats(int generation, Py_ssize_t collected, Py_ssize_t uncollectable,
+             double seconds)
+{
+    struct gc_generation_stats *stats = &generation_stats[generation];
+    int i;
+    double limit = PAUSE_UNIT;
+
+    for (i = 0; i < PAUSE_BUCKETS - 1 && seconds >= limit; i++)
+        limit *= 2;
+    pause_histogram[i]++;
+
+    stats->collections++;
+    stats->collected += collected;
+    stats->uncollectable += uncollectable;
+    stats->total_pause += seconds;
+    if (seconds > stats->max_pause)
+        stats->max_pause = seconds;
+}
+
+/* adjust the threshold of generation after a collection, see adaptive */
+static void
+adapt_threshold(int generation, Py_ssize_t examined, Py_ssize_t found,
+                double seconds)
+{
+    int *threshold = &generations[generation].threshold;
+    int base = base_thresholds[generation];
+
+    if (!adaptive || base <= 0 || examined == 0)
+        return;
+    if (found * 10 > examined ||
+        (generation < NUM_GENERATIONS-1 && seconds > ADAPTIVE_MAX_PAUSE)) {
+        *threshold /= 2;
+        if (*threshold < base)
+            *threshold = base;
+    }
+    else if (found * 100 < examined &&
+             *threshold <= base * (ADAPTIVE_MAX_FACTOR / 2))
+        *threshold *= 2;
+}
+
+/* end an incremental round, making inc_visited the oldest generation */
+static void
+end_round(void)
+{
+    if (inc_active) {
+        gc_list_merge(&inc_visited, GEN_HEAD(NUM_GENERATIONS-1));
+        inc_active = 0;
+    }
+}
+
+/* Delete the objects in unreachable, which were found by
+ * move_unreachable().  Objects which survive, and the uncollectable
+ * ones, are moved to old.  Returns the number of unreachable objects,
+ * and sets *uncollectable to the number of those which could not be
+ * deleted.
+ */
+static Py_ssize_t
+delete_unreachable(PyGC_Head *unreachable, PyGC_Head *old,
+                   Py_ssize_t *uncollectable)
+{
+    Py_ssize_t m = 0; /* # objects collected */
+    Py_ssize_t n = 0; /* # unreachable objects that couldn't be collected */
+#ifdef STACKLESS
+    /* unlinking may occur in a different tasklet during collection
+     * so this must not be on the stack
+     */
+    static PyGC_Head finalizers;  /* objects with, & reachable from, __del__ */
+#else
+    PyGC_Head finalizers;  /* objects with, & reachable from, __del__ */
+#endif
+    PyGC_Head *gc;
+
+    /* All objects in unreachable are trash, but objects reachable from
+     * finalizers can't safely be deleted.  Python programmers should take
+     * care not to create such things.  For Python, finalizers means
+     * instance objects with __del__ methods.  Weakrefs with callbacks
+     * can also call arbitrary Python code but they will be dealt with by
+     * handle_weakrefs().
+     */
+    gc_list_init(&finalizers);
+    move_finalizers(unreachable, &finalizers);
+    /* finalizers contains the unreachable objects with a finalizer;
+     * unreachable objects reachable *from* those are also uncollectable,
+     * and we move those into the finalizers list too.
+     */
+    move_finalizer_reachable(&finalizers);
+
+    /* Collect statistics on collectable objects found and print
+     * debugging information.
+     */
+    for (gc = unreachable->gc.gc_next; gc != unreachable;
+                    gc = gc->gc.gc_next) {
+        m++;
+        if (debug & DEBUG_COLLECTABLE) {
+            debug_cycle("collectable", FROM_GC(gc));
+        }
+    }
+
+    /* Clear weakrefs and invoke callbacks as necessary. */
+    m += handle_weakrefs(unreachable, old);
+
+    /* Call tp_clear on objects in the unreachable set.  This will cause
+     * the reference cycles to be broken.  It may also cause some objects
+     * in finalizers to be freed.
+     */
+    delete_garbage(unreachable, old);
+
+    /* Collect statistics on uncollectable objects found and print
+     * debugging information. */
+    for (gc = finalizers.gc.gc_next;
+         gc != &finalizers;
+         gc = gc->gc.gc_next) {
+        n++;
+        if (debug & DEBUG_UNCOLLECTABLE)
+            debug_cycle("uncollectable", FROM_GC(gc));
+    }
+
+    /* Append instances in the uncollectable set to a Python
+     * reachable list of garbage.  The programmer has to deal with
+     * this if they insist on creating this type of structure.
+     */
+    (void)handle_finalizers(&finalizers, old);
+
+    *uncollectable = n;
+    return n+m;
+}
+
+static void
+debug_done(Py_ssize_t found, Py_ssize_t uncollectable, double t1)
+{
+    double t2 = get_time();
+    if (found == 0)
+        PySys_WriteStderr("gc: done");
+    else
+        PySys_WriteStderr(
+            "gc: done, "
+            "%" PY_FORMAT_SIZE_T "d unreachable, "
+            "%" PY_FORMAT_SIZE_T "d uncollectable",
+            found, uncollectable);
+    if (t1 && t2) {
+        PySys_WriteStderr(", %.4fs elapsed", t2-t1);
+    }
+    PySys_WriteStderr(".\n");
+}
+
+static void
+check_error(void)
+{
+    if (PyErr_Occurred()) {
+        if (gc_str == NULL)
+            gc_str = PyString_FromString("garbage collection");
+        PyErr_WriteUnraisable(gc_str);
+        Py_FatalError("unexpected exception during garbage collection");
+    }
+}
+
 /* This is the main function.  Read this to understand how the
  * collection process works. */
 static Py_ssize_t
-collect(int generation)
+collect(int generation, Py_ssize_t *uncollectable)
 {
     int i;
-    Py_ssize_t m = 0; /* # objects collected */
-    Py_ssize_t n = 0; /* # unreachable objects that couldn't be collected */
+    Py_ssize_t found; /* # unreachable objects */
+    Py_ssize_t n; /* # unreachable objects that couldn't be collected */
+    Py_ssize_t examined; /* # objects in the generation */
     PyGC_Head *young; /* the generation we are examining */
     PyGC_Head *old; /* next older generation */
 #ifdef STACKLESS
     /* unlinking may occur in a different tasklet during collection
-     * so these must not be on the stack
+     * so this must not be on the stack
      */
     static PyGC_Head unreachable; /* non-problematic unreachable trash */
-    static PyGC_Head finalizers;  /* objects with, & reachable from, __del__ */
 #else
     PyGC_Head unreachable; /* non-problematic unreachable trash */
-    PyGC_Head finalizers;  /* objects with, & reachable from, __del__ */
 #endif
-    PyGC_Head *gc;
-    double t1 = 0.0;
+    double t1 = 0.0, elapsed;
+    double start = gc_clock();
 
     if (delstr == NULL) {
         delstr = PyString_InternFromString("__del__");
@@ -883,6 +1188,10 @@ collect(int generation)
             Py_FatalError("gc couldn't allocate \"__del__\"");
     }
 
+    /* a full collection takes over an incremental round */
+    if (generation == NUM_GENERATIONS-1)
+        end_round();
+
     if (debug & DEBUG_STATS) {
         PySys_WriteStderr("gc: collecting generation %d...\n",
                           generation);
@@ -917,7 +1226,7 @@ collect(int generation)
      * refcount greater than 0 when all the references within the
      * set are taken into account).
      */
-    update_refs(young);
+    examined = update_refs(young);
     subtract_refs(young);
 
     /* Leave everything reachable from outside young in young, and move
@@ -941,85 +1250,156 @@ collect(int generation)
         long_lived_total = gc_list_size(young);
     }
 
-    /* All objects in unreachable are trash, but objects reachable from
-     * finalizers can't safely be deleted.  Python programmers should take
-     * care not to create such things.  For Python, finalizers means
-     * instance objects with __del__ methods.  Weakrefs with callbacks
-     * can also call arbitrary Python code but they will be dealt with by
-     * handle_weakrefs().
-     */
-    gc_list_init(&finalizers);
-    move_finalizers(&unreachable, &finalizers);
-    /* finalizers contains the unreachable objects with a finalizer;
-     * unreachable objects reachable *from* those are also uncollectable,
-     * and we move those into the finalizers list too.
-     */
-    move_finalizer_reachable(&finalizers);
+    found = delete_unreachable(&unreachable, old, &n);
+    if (debug & DEBUG_STATS)
+        debug_done(found, n, t1);
 
-    /* Collect statistics on collectable objects found and print
-     * debugging information.
-     */
-    for (gc = unreachable.gc.gc_next; gc != &unreachable;
-                    gc = gc->gc.gc_next) {
-        m++;
-        if (debug & DEBUG_COLLECTABLE) {
-            debug_cycle("collectable", FROM_GC(gc));
-        }
+    /* Clear free list only during the collection of the highest
+     * generation */
+    if (generation == NUM_GENERATIONS-1) {
+        clear_freelists();
     }
 
-    /* Clear weakrefs and invoke callbacks as necessary. */
-    m += handle_weakrefs(&unreachable, old);
+    check_error();
+    elapsed = gc_clock() - start;
+    record_stats(generation, found - n, n, elapsed);
+    adapt_threshold(generation, examined, found, elapsed);
+    *uncollectable = n;
+    return found;
+}
 
-    /* Call tp_clear on objects in the unreachable set.  This will cause
-     * the reference cycles to be broken.  It may also cause some objects
-     * in finalizers to be freed.
-     */
-    delete_garbage(&unreachable, old);
+/* Collect one slice of an incremental round, see inc_visited. */
+static Py_ssize_t
+collect_slice(Py_ssize_t *uncollectable)
+{
+    int i;
+    Py_ssize_t found, n, chunk = 0;
+    PyGC_Head *oldest = GEN_HEAD(NUM_GENERATIONS-1);
+#ifdef STACKLESS
+    static PyGC_Head young;
+    static PyGC_Head generation;
+    static PyGC_Head unreachable;
+#else
+    PyGC_Head young;
+    PyGC_Head generation;
+    PyGC_Head unreachable;
+#endif
+    double t1 = 0.0, elapsed;
+    double start = gc_clock();
 
-    /* Collect statistics on uncollectable objects found and print
-     * debugging information. */
-    for (gc = finalizers.gc.gc_next;
-         gc != &finalizers;
-         gc = gc->gc.gc_next) {
-        n++;
-        if (debug & DEBUG_UNCOLLECTABLE)
-            debug_cycle("uncollectable", FROM_GC(gc));
+    if (delstr == NULL) {
+        delstr = PyString_InternFromString("__del__");
+        if (delstr == NULL)
+            Py_FatalError("gc couldn't allocate \"__del__\"");
     }
+    inc_active = 1;
     if (debug & DEBUG_STATS) {
-        double t2 = get_time();
-        if (m == 0 && n == 0)
-            PySys_WriteStderr("gc: done");
-        else
-            PySys_WriteStderr(
-                "gc: done, "
-                "%" PY_FORMAT_SIZE_T "d unreachable, "
-                "%" PY_FORMAT_SIZE_T "d uncollectable",
-                n+m, n);
-        if (t1 && t2) {
-            PySys_WriteStderr(", %.4fs elapsed", t2-t1);
-        }
-        PySys_WriteStderr(".\n");
+        PySys_WriteStderr("gc: collecting a slice of generation %d, "
+                          "%" PY_FORMAT_SIZE_T "d objects left...\n",
+                          NUM_GENERATIONS-1, gc_list_size(oldest));
+        t1 = get_time();
     }
 
-    /* Append instances in the uncollectable set to a Python
-     * reachable list of garbage.  The programmer has to deal with
-     * this if they insist on creating this type of structure.
-     */
-    (void)handle_finalizers(&finalizers, old);
+    /* take a chunk from the oldest generation, and what it reaches */
+    gc_list_init(&young);
+    while (chunk < slice_size && !gc_list_is_empty(oldest)) {
+        PyGC_Head *gc = oldest->gc.gc_next;
 
-    /* Clear free list only during the collection of the highest
-     * generation */
-    if (generation == NUM_GENERATIONS-1) {
+        assert(gc->gc.gc_refs == GC_REACHABLE);
+        gc_list_move(gc, &young);
+        gc->gc.gc_refs = Py_REFCNT(FROM_GC(gc));
+        ++chunk;
+    }
+    pull_reachable(&young, SLICE_PULL_FACTOR * slice_size);
+
+    /* the young generations are part of every slice */
+    gc_list_init(&generation);
+    for (i = 0; i < NUM_GENERATIONS-1; i++) {
+        generations[i].count = 0;
+        gc_list_merge(GEN_HEAD(i), &generation);
+    }
+    update_refs(&generation);
+    gc_list_merge(&generation, &young);
+
+    subtract_refs(&young);
+    gc_list_init(&unreachable);
+    move_unreachable(&young, &unreachable);
+    gc_list_merge(&young, &inc_visited);
+    found = delete_unreachable(&unreachable, &inc_visited, &n);
+
+    if (gc_list_is_empty(oldest)) {
+        /* the round is over */
+        end_round();
+        generations[NUM_GENERATIONS-1].count = 0;
+        long_lived_pending = 0;
+        long_lived_total = gc_list_size(oldest);
         clear_freelists();
     }
+    if (debug & DEBUG_STATS)
+        debug_done(found, n, t1);
+    check_error();
+
+    /* adapt the chunk size to the budget */
+    elapsed = gc_clock() - start;
+    if (elapsed > slice_budget)
+        slice_size = slice_size / 2 < SLICE_SIZE_MIN ? SLICE_SIZE_MIN
+                                                     : slice_size / 2;
+    else if (elapsed < slice_budget / 2 && chunk == slice_size)
+        slice_size *= 2;
+    record_stats(NUM_GENERATIONS-1, found - n, n, elapsed);
+    *uncollectable = n;
+    return found;
+}
 
-    if (PyErr_Occurred()) {
-        if (gc_str == NULL)
-            gc_str = PyString_FromString("garbage collection");
-        PyErr_WriteUnraisable(gc_str);
-        Py_FatalError("unexpected exception during garbage collection");
+/* Call the functions in gc.callbacks with phase "start" or "stop".
+ * Errors are reported and otherwise ignored.
+ */
+static void
+invoke_gc_callback(const char *phase, int generation,
+                   Py_ssize_t collected, Py_ssize_t uncollectable)
+{
+    Py_ssize_t i;
+    PyObject *info;
+
+    if (callbacks == NULL || PyList_GET_SIZE(callbacks) == 0)
+        return;
+    info = Py_BuildValue("{sisnsn}",
+                         "generation", generation,
+                         "collected", collected,
+                         "uncollectable", uncollectable);
+    if (info == NULL) {
+        PyErr_WriteUnraisable(NULL);
+        return;
     }
-    return n+m;
+    /* the callbacks may change the list, so don't hold on to it */
+    for (i = 0; i < PyList_GET_SIZE(callbacks); i++) {
+        PyObject *r, *cb = PyList_GET_ITEM(callbacks, i);
+
+        Py_INCREF(cb);
+        r = PyObject_CallFunction(cb, "sO", phase, info);
+        if (r == NULL)
+            PyErr_WriteUnraisable(cb);
+        else
+            Py_DECREF(r);
+        Py_DECREF(cb);
+    }
+    Py_DECREF(info);
+}
+
+/* Run a collection, or a slice if incremental, and call the callbacks. */
+static Py_ssize_t
+collect_with_callback(int generation, int slice)
+{
+    Py_ssize_t found, uncollectable;
+
+    invoke_gc_callback("start", generation, 0, 0);
+    if (slice)
+        found = collect_slice(&uncollectable);
+    else
+        found = collect(generation, &uncollectable);
+    invoke_gc_callback("stop", generation, found - uncollectable,
+                       uncollectable);
+    return found;
 }
 
 static Py_ssize_t
@@ -1040,7 +1420,11 @@ collect_generations(void)
             if (i == NUM_GENERATIONS - 1
                 && long_lived_pending < long_lived_total / 4)
                 continue;
-            n = collect(i);
+            /* once a round has started, every collection is a slice */
+            if (incremental && (inc_active || i == NUM_GENERATIONS - 1))
+                n = collect_with_callback(NUM_GENERATIONS - 1, 1);
+            else
+                n = collect_with_callback(i, 0);
             break;
         }
     }
@@ -1111,7 +1495,7 @@ gc_collect(PyObject *self, PyObject *args, PyObject *kws)
         n = 0; /* already collecting, don't do anything */
     else {
         collecting = 1;
-        n = collect(genarg);
+        n = collect_with_callback(genarg, 0);
         collecting = 0;
     }
 
@@ -1156,23 +1540,33 @@ gc_get_debug(PyObject *self, PyObject *noargs)
 }
 
 PyDoc_STRVAR(gc_set_thresh__doc__,
-"set_threshold(threshold0, [threshold1, threshold2]) -> None\n"
+"set_threshold(threshold0, [threshold1, threshold2], adaptive=False) -> None\n"
 "\n"
 "Sets the collection thresholds.  Setting threshold0 to zero disables\n"
-"collection.\n");
+"collection.  If adaptive is true, the thresholds are lower bounds, and\n"
+"the collector raises them up to 16 times while collections find little\n"
+"garbage.\n");
 
 static PyObject *
-gc_set_thresh(PyObject *self, PyObject *args)
+gc_set_thresh(PyObject *self, PyObject *args, PyObject *kws)
 {
-    int i;
-    if (!PyArg_ParseTuple(args, "i|ii:set_threshold",
-                          &generations[0].threshold,
-                          &generations[1].threshold,
-                          &generations[2].threshold))
+    static char *keywords[] = {"threshold0", "threshold1", "threshold2",
+                               "adaptive", NULL};
+    int i, flag = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kws, "i|iii:set_threshold",
+                                     keywords,
+                                     &base_thresholds[0],
+                                     &base_thresholds[1],
+                                     &base_thresholds[2],
+                                     &flag))
         return NULL;
-    for (i = 2; i < NUM_GENERATIONS; i++) {
+    adaptive = flag;
+    for (i = 0; i < NUM_GENERATIONS; i++) {
         /* generations higher than 2 get the same threshold */
-        generations[i].threshold = generations[2].threshold;
+        if (i > 2)
+            base_thresholds[i] = base_thresholds[2];
+        generations[i].threshold = base_thresholds[i];
     }
 
     Py_INCREF(Py_None);
@@ -1207,6 +1601,181 @@ gc_get_count(PyObject *self, PyObject *noargs)
                          generations[2].count);
 }
 
+PyDoc_STRVAR(gc_set_incremental__doc__,
+"set_incremental(enabled[, budget]) -> None\n"
+"\n"
+"Enable or disable incremental collection of the oldest generation.\n"
+"Automatic collections of it are then split into slices, each taking\n"
+"about budget seconds.  collect() still does a full collection.\n");
+
+static PyObject *
+gc_set_incremental(PyObject *self, PyObject *args)
+{
+    int flag;
+    double budget = slice_budget;
+
+    if (!PyArg_ParseTuple(args, "i|d:set_incremental", &flag, &budget))
+        return NULL;
+    if (budget <= 0.0) {
+        PyErr_SetString(PyExc_ValueError, "budget must be positive");
+        return NULL;
+    }
+    incremental = flag;
+    slice_budget = budget;
+    if (!incremental && !collecting)
+        end_round();
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+PyDoc_STRVAR(gc_get_incremental__doc__,
+"get_incremental() -> (enabled, budget)\n"
+"\n"
+"Return the incremental collection settings.\n");
+
+static PyObject *
+gc_get_incremental(PyObject *self, PyObject *noargs)
+{
+    return Py_BuildValue("(Nd)", PyBool_FromLong(incremental), slice_budget);
+}
+
+PyDoc_STRVAR(gc_get_pause_histogram__doc__,
+"get_pause_histogram() -> [(limit, count), ...]\n"
+"\n"
+"Return how many collections, or slices of incremental ones, took less\n"
+"than limit seconds and at least the previous limit.  The last limit is\n"
+"None.\n");
+
+static PyObject *
+gc_get_pause_histogram(PyObject *self, PyObject *noargs)
+{
+    int i;
+    double limit = PAUSE_UNIT;
+    PyObject *result = PyList_New(PAUSE_BUCKETS);
+
+    if (result == NULL)
+        return NULL;
+    for (i = 0; i < PAUSE_BUCKETS; i++) {
+        PyObject *item;
+
+        if (i < PAUSE_BUCKETS - 1)
+            item = Py_BuildValue("(dn)", limit, pause_histogram[i]);
+        else
+            item = Py_BuildValue("(On)", Py_None, pause_histogram[i]);
+        if (item == NULL) {
+            Py_DECREF(result);
+            return NULL;
+        }
+        PyList_SET_ITEM(result, i, item);
+        limit *= 2;
+    }
+    return result;
+}
+
+/* set gc_refs of all objects in list and move them to to */
+static void
+gc_list_move_all(PyGC_Head *list, PyGC_Head *to, Py_ssize_t gc_refs)
+{
+    PyGC_Head *gc;
+
+    for (gc = list->gc.gc_next; gc != list; gc = gc->gc.gc_next)
+        gc->gc.gc_refs = gc_refs;
+    gc_list_merge(list, to);
+}
+
+PyDoc_STRVAR(gc_freeze__doc__,
+"freeze() -> None\n"
+"\n"
+"Move all tracked objects to the permanent generation, which is never\n"
+"examined by collections.  Calling this before os.fork() keeps later\n"
+"collections in the child from writing to the memory shared with the\n"
+"parent.\n");
+
+static PyObject *
+gc_freeze(PyObject *self, PyObject *noargs)
+{
+    int i;
+
+    if (collecting) {
+        PyErr_SetString(PyExc_RuntimeError,
+                        "cannot freeze during a collection");
+        return NULL;
+    }
+    end_round();
+    for (i = 0; i < NUM_GENERATIONS; i++) {
+        gc_list_move_all(GEN_HEAD(i), &permanent_generation, GC_FROZEN);
+        generations[i].count = 0;
+    }
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+PyDoc_STRVAR(gc_unfreeze__doc__,
+"unfreeze() -> None\n"
+"\n"
+"Move the objects of the permanent generation back to the oldest one.\n"
+"This includes the frames of tasklets frozen by tasklet.freeze().\n");
+
+static PyObject *
+gc_unfreeze(PyObject *self, PyObject *noargs)
+{
+    if (collecting) {
+        PyErr_SetString(PyExc_RuntimeError,
+                        "cannot unfreeze during a collection");
+        return NULL;
+    }
+    gc_list_move_all(&permanent_generation, GEN_HEAD(NUM_GENERATIONS - 1),
+                     GC_REACHABLE);
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+PyDoc_STRVAR(gc_get_freeze_count__doc__,
+"get_freeze_count() -> int\n"
+"\n"
+"Return the number of objects in the permanent generation.\n");
+
+static PyObject *
+gc_get_freeze_count(PyObject *self, PyObject *noargs)
+{
+    return PyInt_FromSsize_t(gc_list_size(&permanent_generation));
+}
+
+PyDoc_STRVAR(gc_get_stats__doc__,
+"get_stats() -> [dict, ...]\n"
+"\n"
+"Return a list with a dict of statistics for every generation: the\n"
+"number of collections, collected and uncollectable objects, and the\n"
+"total and maximum pause in seconds.\n");
+
+static PyObject *
+gc_get_stats(PyObject *self, PyObject *noargs)
+{
+    int i;
+    PyObject *result = PyList_New(NUM_GENERATIONS);
+
+    if (result == NULL)
+        return NULL;
+    for (i = 0; i < NUM_GENERATIONS; i++) {
+        struct gc_generation_stats *stats = &generation_stats[i];
+        PyObject *item;
+
+        item = Py_BuildValue("{snsnsnsdsd}",
+                             "collections", stats->collections,
+                             "collected", stats->collected,
+                             "uncollectable", stats->uncollectable,
+                             "total_pause", stats->total_pause,
+                             "max_pause", stats->max_pause);
+        if (item == NULL) {
+            Py_DECREF(result);
+            return NULL;
+        }
+        PyList_SET_ITEM(result, i, item);
+    }
+    return result;
+}
+
 static int
 referrersvisit(PyObject* obj, PyObject *objs)
 {
@@ -1253,6 +1822,11 @@ gc_get_referrers(PyObject *self, PyObject *args)
             return NULL;
         }
     }
+    if (!(gc_referrers_for(args, &inc_visited, result)) ||
+        !(gc_referrers_for(args, &permanent_generation, result))) {
+        Py_DECREF(result);
+        return NULL;
+    }
     return result;
 }
 
@@ -1314,6 +1888,11 @@ gc_get_objects(PyObject *self, PyObject *noargs)
             return NULL;
         }
     }
+    if (append_objects(result, &inc_visited) ||
+        append_objects(result, &permanent_generation)) {
+        Py_DECREF(result);
+        return NULL;
+    }
     return result;
 }
 
@@ -1350,6 +1929,13 @@ PyDoc_STRVAR(gc__doc__,
 "get_debug() -- Get debugging flags.\n"
 "set_threshold() -- Set the collection thresholds.\n"
 "get_threshold() -- Return the current the collection thresholds.\n"
+"set_incremental() -- Split collections of the oldest generation.\n"
+"get_incremental() -- Return the incremental collection settings.\n"
+"get_pause_histogram() -- Return a histogram of collection pauses.\n"
+"get_stats() -- Return the collection statistics of every generation.\n"
+"freeze() -- Move all objects to a generation that is never collected.\n"
+"unfreeze() -- Move the frozen objects back to the oldest generation.\n"
+"get_freeze_count() -- Return the number of frozen objects.\n"
 "get_objects() -- Return a list of all objects tracked by the collector.\n"
 "is_tracked() -- Returns true if a given object is tracked.\n"
 "get_referrers() -- Return the list of objects that refer to an object.\n"
@@ -1362,8 +1948,20 @@ static PyMethodDef GcMethods[] = {
     {"set_debug",          gc_set_debug,  METH_VARARGS, gc_set_debug__doc__},
     {"get_debug",          gc_get_debug,  METH_NOARGS,  gc_get_debug__doc__},
     {"get_count",          gc_get_count,  METH_NOARGS,  gc_get_count__doc__},
-    {"set_threshold",  gc_set_thresh, METH_VARARGS, gc_set_thresh__doc__},
+    {"set_threshold",  (PyCFunction)gc_set_thresh,
+        METH_VARARGS | METH_KEYWORDS,           gc_set_thresh__doc__},
     {"get_threshold",  gc_get_thresh, METH_NOARGS,  gc_get_thresh__doc__},
+    {"set_incremental", gc_set_incremental, METH_VARARGS,
+        gc_set_incremental__doc__},
+    {"get_incremental", gc_get_incremental, METH_NOARGS,
+        gc_get_incremental__doc__},
+    {"get_pause_histogram", gc_get_pause_histogram, METH_NOARGS,
+        gc_get_pause_histogram__doc__},
+    {"get_stats",      gc_get_stats,  METH_NOARGS,  gc_get_stats__doc__},
+    {"freeze",         gc_freeze,     METH_NOARGS,  gc_freeze__doc__},
+    {"unfreeze",       gc_unfreeze,   METH_NOARGS,  gc_unfreeze__doc__},
+    {"get_freeze_count", gc_get_freeze_count, METH_NOARGS,
+        gc_get_freeze_count__doc__},
     {"collect",            (PyCFunction)gc_collect,
         METH_VARARGS | METH_KEYWORDS,           gc_collect__doc__},
     {"get_objects",    gc_get_objects,METH_NOARGS,  gc_get_objects__doc__},
@@ -1397,6 +1995,15 @@ initgc(void)
     if (PyModule_AddObject(m, "garbage", garbage) < 0)
         return;
 
+    if (callbacks == NULL) {
+        callbacks = PyList_New(0);
+        if (callbacks == NULL)
+            return;
+    }
+    Py_INCREF(callbacks);
+    if (PyModule_AddObject(m, "callbacks", callbacks) < 0)
+        return;
+
     /* Importing can't be done in collect() because collect()
      * can be called via PyGC_Collect() in Py_Finalize().
      * This wouldn't be a problem, except that <initialized> is
@@ -1430,13 +2037,44 @@ PyGC_Collect(void)
         n = 0; /* already collecting, don't do anything */
     else {
         collecting = 1;
-        n = collect(NUM_GENERATIONS - 1);
+        n = collect_with_callback(NUM_GENERATIONS - 1, 0);
         collecting = 0;
     }
 
     return n;
 }
 
+/* Move a tracked object to the permanent generation, or back to the
+ * oldest one. Collections never look at the permanent generation, so
+ * objects there are not traversed, and the objects they refer to are
+ * kept alive by their reference counts. Cycles through frozen objects
+ * cannot be found. Both fail while the collector runs, because the
+ * object may be on one of its private lists.
+ */
+int
+_PyObject_GC_Freeze(PyObject *op)
+{
+    if (collecting)
+        return -1;
+    if (PyObject_IS_GC(op) && IS_TRACKED(op)) {
+        gc_list_move(AS_GC(op), &permanent_generation);
+        AS_GC(op)->gc.gc_refs = GC_FROZEN;
+    }
+    return 0;
+}
+
+int
+_PyObject_GC_Thaw(PyObject *op)
+{
+    if (collecting)
+        return -1;
+    if (PyObject_IS_GC(op) && IS_TRACKED(op)) {
+        gc_list_move(AS_GC(op), GEN_HEAD(NUM_GENERATIONS - 1));
+        AS_GC(op)->gc.gc_refs = GC_REACHABLE;
+    }
+    return 0;
+}
+
 /* for debugging */
 void
 _PyGC_Dump(PyGC_Head *g)
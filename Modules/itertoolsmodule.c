@@ -103,8 +103,7 @@ groupby_next(groupbyobject *gbo)
             newkey = newvalue;
             Py_INCREF(newvalue);
         } else {
-            newkey = PyObject_CallFunctionObjArgs(gbo->keyfunc,
-                                                  newvalue, NULL);
+            newkey = _PyObject_FastCall(gbo->keyfunc, &newvalue, 1, NULL, 0);
             if (newkey == NULL) {
                 Py_DECREF(newvalue);
                 return NULL;
@@ -243,8 +242,7 @@ _grouper_next(_grouperobject *igo)
             newkey = newvalue;
             Py_INCREF(newvalue);
         } else {
-            newkey = PyObject_CallFunctionObjArgs(gbo->keyfunc,
-                                                  newvalue, NULL);
+            newkey = _PyObject_FastCall(gbo->keyfunc, &newvalue, 1, NULL, 0);
             if (newkey == NULL) {
                 Py_DECREF(newvalue);
                 return NULL;
@@ -896,7 +894,7 @@ dropwhile_next(dropwhileobject *lz)
         if (lz->start == 1)
             return item;
 
-        good = PyObject_CallFunctionObjArgs(lz->func, item, NULL);
+        good = _PyObject_FastCall(lz->func, &item, 1, NULL, 0);
         if (good == NULL) {
             Py_DECREF(item);
             return NULL;
@@ -1036,7 +1034,7 @@ takewhile_next(takewhileobject *lz)
     if (item == NULL)
         return NULL;
 
-    good = PyObject_CallFunctionObjArgs(lz->func, item, NULL);
+    good = _PyObject_FastCall(lz->func, &item, 1, NULL, 0);
     if (good == NULL) {
         Py_DECREF(item);
         return NULL;
@@ -1369,7 +1367,8 @@ starmap_next(starmapobject *lz)
             return NULL;
         args = newargs;
     }
-    result = PyObject_Call(lz->func, args, NULL);
+    result = _PyObject_FastCall(lz->func, &PyTuple_GET_ITEM(args, 0),
+                                PyTuple_GET_SIZE(args), NULL, 0);
     Py_DECREF(args);
     return result;
 }
@@ -1522,31 +1521,54 @@ the following reasons:
   5) Similar toolsets in Haskell and SML do not have automatic None fill-in.
 */
 
+/* The arguments of most calls fit on the C stack */
+#define SMALL_STACK 8
+
 static PyObject *
 imap_next(imapobject *lz)
 {
     PyObject *val;
     PyObject *argtuple;
-    PyObject *result;
+    PyObject *small_stack[SMALL_STACK];
+    PyObject **stack, *result = NULL;
     Py_ssize_t numargs, i;
 
     numargs = PyTuple_Size(lz->iters);
-    argtuple = PyTuple_New(numargs);
-    if (argtuple == NULL)
-        return NULL;
-
-    for (i=0 ; i<numargs ; i++) {
-        val = PyIter_Next(PyTuple_GET_ITEM(lz->iters, i));
-        if (val == NULL) {
-            Py_DECREF(argtuple);
+    if (lz->func == Py_None) {
+        argtuple = PyTuple_New(numargs);
+        if (argtuple == NULL)
             return NULL;
+
+        for (i=0 ; i<numargs ; i++) {
+            val = PyIter_Next(PyTuple_GET_ITEM(lz->iters, i));
+            if (val == NULL) {
+                Py_DECREF(argtuple);
+                return NULL;
+            }
+            PyTuple_SET_ITEM(argtuple, i, val);
         }
-        PyTuple_SET_ITEM(argtuple, i, val);
-    }
-    if (lz->func == Py_None)
         return argtuple;
-    result = PyObject_Call(lz->func, argtuple, NULL);
-    Py_DECREF(argtuple);
+    }
+
+    /* call the function without building an argument tuple */
+    if (numargs <= SMALL_STACK)
+        stack = small_stack;
+    else {
+        stack = PyMem_NEW(PyObject *, numargs);
+        if (stack == NULL)
+            return PyErr_NoMemory();
+    }
+    for (i=0 ; i<numargs ; i++) {
+        stack[i] = PyIter_Next(PyTuple_GET_ITEM(lz->iters, i));
+        if (stack[i] == NULL)
+            break;
+    }
+    if (i == numargs)
+        result = _PyObject_FastCall(lz->func, stack, numargs, NULL, 0);
+    while (--i >= 0)
+        Py_DECREF(stack[i]);
+    if (stack != small_stack)
+        PyMem_FREE(stack);
     return result;
 }
 
@@ -2989,8 +3011,7 @@ ifilter_next(ifilterobject *lz)
             ok = PyObject_IsTrue(item);
         } else {
             PyObject *good;
-            good = PyObject_CallFunctionObjArgs(lz->func,
-                                                item, NULL);
+            good = _PyObject_FastCall(lz->func, &item, 1, NULL, 0);
             if (good == NULL) {
                 Py_DECREF(item);
                 return NULL;
@@ -3132,8 +3153,7 @@ ifilterfalse_next(ifilterfalseobject *lz)
             ok = PyObject_IsTrue(item);
         } else {
             PyObject *good;
-            good = PyObject_CallFunctionObjArgs(lz->func,
-                                                item, NULL);
+            good = _PyObject_FastCall(lz->func, &item, 1, NULL, 0);
             if (good == NULL) {
                 Py_DECREF(item);
                 return NULL;
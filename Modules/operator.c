@@ -709,13 +709,30 @@ static PyObject *
 methodcaller_call(methodcallerobject *mc, PyObject *args, PyObject *kw)
 {
     PyObject *method, *obj, *result;
+    int unbound;
 
     if (!PyArg_UnpackTuple(args, "methodcaller", 1, 1, &obj))
         return NULL;
-    method = PyObject_GetAttr(obj, mc->name);
+    if (mc->kwds != NULL && PyDict_Size(mc->kwds) > 0) {
+        method = PyObject_GetAttr(obj, mc->name);
+        if (method == NULL)
+            return NULL;
+        result = PyObject_Call(method, mc->args, mc->kwds);
+        Py_DECREF(method);
+        return result;
+    }
+    /* call the method without binding it or building an argument tuple */
+    unbound = _PyObject_GetMethod(obj, mc->name, NULL, &method);
     if (method == NULL)
         return NULL;
-    result = PyObject_Call(method, mc->args, mc->kwds);
+    if (unbound)
+        result = _PyObject_FastCallPrepend(method, obj,
+                                           &PyTuple_GET_ITEM(mc->args, 0),
+                                           PyTuple_GET_SIZE(mc->args),
+                                           NULL, 0);
+    else
+        result = _PyObject_FastCall(method, &PyTuple_GET_ITEM(mc->args, 0),
+                                    PyTuple_GET_SIZE(mc->args), NULL, 0);
     Py_DECREF(method);
     return result;
 }
@@ -2546,6 +2546,136 @@ PyObject_Call(PyObject *func, PyObject *arg, PyObject *kw)
     return NULL;
 }
 
+PyObject *
+_PyStack_AsTuple(PyObject **args, Py_ssize_t nargs)
+{
+    PyObject *result;
+    Py_ssize_t i;
+
+    result = PyTuple_New(nargs);
+    if (result == NULL)
+        return NULL;
+    for (i = 0; i < nargs; i++) {
+        Py_INCREF(args[i]);
+        PyTuple_SET_ITEM(result, i, args[i]);
+    }
+    return result;
+}
+
+PyObject *
+_PyStack_AsDict(PyObject **kws, Py_ssize_t nkws, PyObject *func)
+{
+    PyObject *result;
+    Py_ssize_t i;
+
+    result = PyDict_New();
+    if (result == NULL)
+        return NULL;
+    for (i = 0; i < nkws; i++) {
+        PyObject *key = kws[2*i], *value = kws[2*i + 1];
+        if (PyDict_GetItem(result, key) != NULL) {
+            PyErr_Format(PyExc_TypeError,
+                         "%.200s%s got multiple values "
+                         "for keyword argument '%.200s'",
+                         func ? PyEval_GetFuncName(func) : "function",
+                         func ? PyEval_GetFuncDesc(func) : "",
+                         PyString_Check(key) ?
+                         PyString_AS_STRING(key) : "?");
+            Py_DECREF(result);
+            return NULL;
+        }
+        if (PyDict_SetItem(result, key, value) < 0) {
+            Py_DECREF(result);
+            return NULL;
+        }
+    }
+    return result;
+}
+
+PyObject *
+_PyObject_FastCall(PyObject *func, PyObject **args, Py_ssize_t nargs,
+                   PyObject **kws, Py_ssize_t nkws)
+{
+    PyObject *result;
+
+    STACKLESS_ASSERT();
+    /* functions check the recursion depth when they run their frame */
+    if (PyFunction_Check(func))
+        return _PyFunction_FastCall(func, args, nargs, kws, nkws);
+    if (PyMethod_Check(func) && PyMethod_GET_SELF(func) != NULL)
+        return _PyObject_FastCallPrepend(PyMethod_GET_FUNCTION(func),
+                                         PyMethod_GET_SELF(func),
+                                         args, nargs, kws, nkws);
+
+    if (Py_EnterRecursiveCall(" while calling a Python object"))
+        return NULL;
+    if (PyCFunction_Check(func))
+        result = _PyCFunction_FastCall(func, args, nargs, kws, nkws);
+    else if (PyMethodDescr_Check(func))
+        result = _PyMethodDescr_FastCall(func, args, nargs, kws, nkws);
+    else if (PyType_CheckExact(func))
+        result = _PyType_FastCall((PyTypeObject *)func,
+                                  args, nargs, kws, nkws);
+    else if (func->ob_type->tp_call != NULL) {
+        PyObject *argtuple, *kwdict = NULL;
+
+        argtuple = _PyStack_AsTuple(args, nargs);
+        if (argtuple == NULL) {
+            Py_LeaveRecursiveCall();
+            return NULL;
+        }
+        if (nkws > 0) {
+            kwdict = _PyStack_AsDict(kws, nkws, func);
+            if (kwdict == NULL) {
+                Py_DECREF(argtuple);
+                Py_LeaveRecursiveCall();
+                return NULL;
+            }
+        }
+        result = (*func->ob_type->tp_call)(func, argtuple, kwdict);
+        Py_DECREF(argtuple);
+        Py_XDECREF(kwdict);
+    }
+    else {
+        PyErr_Format(PyExc_TypeError, "'%.200s' object is not callable",
+                     func->ob_type->tp_name);
+        result = NULL;
+    }
+    Py_LeaveRecursiveCall();
+    if (result == NULL && !PyErr_Occurred())
+        PyErr_SetString(
+            PyExc_SystemError,
+            "NULL result without error in PyObject_Call");
+    return result;
+}
+
+/* Most calls have few arguments; they get the arguments with self
+   inserted from the C stack */
+#define SMALL_STACK 8
+
+PyObject *
+_PyObject_FastCallPrepend(PyObject *func, PyObject *self, PyObject **args,
+                          Py_ssize_t nargs, PyObject **kws, Py_ssize_t nkws)
+{
+    PyObject *small_stack[SMALL_STACK];
+    PyObject **stack, *result;
+
+    if (nargs < SMALL_STACK)
+        stack = small_stack;
+    else {
+        stack = PyMem_NEW(PyObject *, nargs + 1);
+        if (stack == NULL)
+            return PyErr_NoMemory();
+    }
+    stack[0] = self;
+    if (nargs > 0)
+        memcpy(stack + 1, args, nargs * sizeof(PyObject *));
+    result = _PyObject_FastCall(func, stack, nargs + 1, kws, nkws);
+    if (stack != small_stack)
+        PyMem_FREE(stack);
+    return result;
+}
+
 static PyObject*
 call_function_tail(PyObject *callable, PyObject *args)
 {
@@ -1,7 +1,11 @@
 #include "Python.h"
 #include "code.h"
+#include "opcode.h"
 #include "structmember.h"
 
+/* Calls and loop iterations before a code object is quickened */
+#define QUICKEN_WARMUP 16
+
 #define NAME_CHARS \
     "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ_abcdefghijklmnopqrstuvwxyz"
 
@@ -104,6 +108,11 @@ PyCode_New(int argcount, int nlocals, int stacksize, int flags,
         co->co_lnotab = lnotab;
         co->co_zombieframe = NULL;
         co->co_weakreflist = NULL;
+        co->co_globalcache = NULL;
+        co->co_attrcache = NULL;
+        co->co_execcount = 0;
+        co->co_warmup = QUICKEN_WARMUP;
+        co->co_quickened = NULL;
     }
     return co;
 }
@@ -172,6 +181,7 @@ static PyMemberDef code_memberlist[] = {
     {"co_name",         T_OBJECT,       OFF(co_name),           READONLY},
     {"co_firstlineno", T_INT,           OFF(co_firstlineno),    READONLY},
     {"co_lnotab",       T_OBJECT,       OFF(co_lnotab),         READONLY},
+    {"co_execcount",    T_LONG,         OFF(co_execcount),      READONLY},
     {NULL}      /* Sentinel */
 };
 
@@ -317,6 +327,12 @@ code_dealloc(PyCodeObject *co)
         PyObject_GC_Del(co->co_zombieframe);
     if (co->co_weakreflist != NULL)
         PyObject_ClearWeakRefs((PyObject*)co);
+    if (co->co_globalcache != NULL)
+        PyMem_FREE(co->co_globalcache);
+    if (co->co_attrcache != NULL)
+        PyMem_FREE(co->co_attrcache);
+    if (co->co_quickened != NULL)
+        PyMem_FREE(co->co_quickened);
     PyObject_DEL(co);
 }
 
@@ -579,3 +595,95 @@ _PyCode_CheckLineNumber(PyCodeObject* co, int lasti, PyAddrPair *bounds)
 
     return line;
 }
+
+/* The LOAD_GLOBAL cache has an entry for every name in co_names. The
+   versions of a new entry are 0, which no dict ever has. */
+PyGlobalCacheEntry *
+_PyCode_GetGlobalCache(PyCodeObject *co)
+{
+    if (co->co_globalcache == NULL) {
+        Py_ssize_t n = PyTuple_GET_SIZE(co->co_names);
+
+        if (n == 0)
+            return NULL;
+        co->co_globalcache = PyMem_New(PyGlobalCacheEntry, n);
+        if (co->co_globalcache == NULL)
+            return NULL;
+        memset(co->co_globalcache, 0, n * sizeof(PyGlobalCacheEntry));
+    }
+    return co->co_globalcache;
+}
+
+/* Only instructions with specialized forms are worth the copy. */
+PyQuickenedCode *
+_PyCode_Quicken(PyCodeObject *co)
+{
+    unsigned char *code = (unsigned char *)PyString_AS_STRING(co->co_code);
+    Py_ssize_t i, n = PyString_GET_SIZE(co->co_code);
+    PyQuickenedCode *quick;
+
+    co->co_warmup = 0;
+    for (i = 0; i < n; i += HAS_ARG(code[i]) ? 3 : 1)
+        if (code[i] == BINARY_ADD || code[i] == BINARY_SUBSCR ||
+            code[i] == COMPARE_OP || code[i] == COMPARE_OP_POP_JUMP_IF_FALSE)
+            break;
+    if (i >= n || (size_t)n > PY_SSIZE_T_MAX / 4)
+        return NULL;
+    quick = (PyQuickenedCode *)PyMem_MALLOC(
+        sizeof(PyQuickenedCode) + 3 * n);
+    if (quick == NULL)
+        return NULL;
+    memcpy(quick->qc_code, code, n);
+    quick->qc_kinds = quick->qc_code + n;
+    quick->qc_hits = quick->qc_kinds + n;
+    memset(quick->qc_kinds, 0, 2 * n);
+    co->co_quickened = quick;
+    return quick;
+}
+
+/* The attribute caches are allocated together with their index, which
+   follows them in the same block. Code with more sites than the index
+   can number only caches the first ones. */
+PyAttrCache *
+_PyCode_GetAttrCache(PyCodeObject *co, int offset)
+{
+    PyAttrCacheTable *table = co->co_attrcache;
+    unsigned short site;
+
+    if (table == NULL) {
+        unsigned char *code = (unsigned char *)PyString_AS_STRING(co->co_code);
+        Py_ssize_t i, n = PyString_GET_SIZE(co->co_code);
+        Py_ssize_t nsites = 0;
+        size_t size;
+
+        for (i = 0; i < n; i += HAS_ARG(code[i]) ? 3 : 1)
+            if (code[i] == LOAD_ATTR || code[i] == STORE_ATTR ||
+                code[i] == LOAD_METHOD)
+                nsites++;
+        if (nsites == 0)
+            return NULL;
+        if (nsites > USHRT_MAX)
+            nsites = USHRT_MAX;
+        if ((size_t)n > PY_SSIZE_T_MAX / 4)
+            return NULL;
+        size = sizeof(PyAttrCacheTable) + (nsites - 1) * sizeof(PyAttrCache);
+        table = (PyAttrCacheTable *)PyMem_MALLOC(
+            size + n * sizeof(unsigned short));
+        if (table == NULL)
+            return NULL;
+        memset(table, 0, size + n * sizeof(unsigned short));
+        table->at_index = (unsigned short *)((char *)table + size);
+        site = 0;
+        for (i = 0; i < n; i += HAS_ARG(code[i]) ? 3 : 1)
+            if ((code[i] == LOAD_ATTR || code[i] == STORE_ATTR ||
+                 code[i] == LOAD_METHOD) && site < nsites)
+                table->at_index[i] = ++site;
+        co->co_attrcache = table;
+    }
+    if (offset < 0 || offset >= PyString_GET_SIZE(co->co_code))
+        return NULL;
+    site = table->at_index[offset];
+    if (site == 0)
+        return NULL;
+    return &table->at_sites[site - 1];
+}
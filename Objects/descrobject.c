@@ -253,6 +253,43 @@ methoddescr_call(PyMethodDescrObject *descr, PyObject *args, PyObject *kwds)
     return result;
 }
 
+/* Like methoddescr_call(), without building a bound method and an
+   argument tuple */
+PyObject *
+_PyMethodDescr_FastCall(PyObject *func, PyObject **args, Py_ssize_t nargs,
+                        PyObject **kws, Py_ssize_t nkws)
+{
+    STACKLESS_GETARG();
+    PyMethodDescrObject *descr = (PyMethodDescrObject *)func;
+    PyObject *self, *result;
+
+    if (nargs < 1) {
+        PyErr_Format(PyExc_TypeError,
+                     "descriptor '%.300s' of '%.100s' "
+                     "object needs an argument",
+                     descr_name((PyDescrObject *)descr),
+                     descr->d_type->tp_name);
+        return NULL;
+    }
+    self = args[0];
+    if (!PyObject_TypeCheck(self, descr->d_type) &&
+        !PyObject_IsInstance(self, (PyObject *)(descr->d_type))) {
+        PyErr_Format(PyExc_TypeError,
+                     "descriptor '%.200s' "
+                     "requires a '%.100s' object "
+                     "but received a '%.100s'",
+                     descr_name((PyDescrObject *)descr),
+                     descr->d_type->tp_name,
+                     self->ob_type->tp_name);
+        return NULL;
+    }
+    STACKLESS_PROMOTE_ALL();
+    result = _PyMethodDef_FastCall(descr->d_method, self,
+                                   args + 1, nargs - 1, kws, nkws);
+    STACKLESS_ASSERT();
+    return result;
+}
+
 static PyObject *
 classmethoddescr_call(PyMethodDescrObject *descr, PyObject *args,
                       PyObject *kwds)
@@ -391,11 +428,7 @@ descr_traverse(PyObject *self, visitproc visit, void *arg)
     return 0;
 }
 
-#ifdef STACKLESS
 PyTypeObject PyMethodDescr_Type = {
-#else
-static PyTypeObject PyMethodDescr_Type = {
-#endif
     PyVarObject_HEAD_INIT(&PyType_Type, 0)
     "method_descriptor",
     sizeof(PyMethodDescrObject),
@@ -8,6 +8,7 @@
 */
 
 #include "Python.h"
+#include <stddef.h>
 
 
 /* Set a key error with the specified argument, wrapping it in a
@@ -148,6 +149,8 @@ _PyDict_Dummy(void)
 /* forward declarations */
 static PyDictEntry *
 lookdict_string(PyDictObject *mp, PyObject *key, long hash);
+static PyDictEntry *
+lookdict_split(PyDictObject *mp, PyObject *key, long hash);
 
 #ifdef SHOW_CONVERSION_COUNTS
 static long created = 0L;
@@ -198,6 +201,40 @@ show_track(void)
 #endif
 
 
+/* The source of version tags, see ma_version_tag. Every insertion,
+   replacement or deletion of an item takes a new tag; dictresize()
+   only moves the items, so it keeps it. 0 is never used. */
+static PyDictVersion pydict_global_version = 0;
+
+#define DICT_NEXT_VERSION() (++pydict_global_version)
+
+/* Split dicts.  The instance dicts of a heap type share their keys in
+   the type's ht_cached_keys: a key's index there is the index of its
+   value in ma_values.  Such a dict is "short", it is allocated without
+   ma_smalltable and remembers its ma_keys for life.  It becomes
+   combined, with a malloc'ed ma_table, as soon as it gets a key that
+   cannot be shared (not an exact string, or the type has already
+   SHARED_KEYS_MAX keys), or when another change wants to see a table.
+   Reads never combine, that would upset running iterators; ma_lookup
+   is lookdict_split(), which only reads.  A split dict has no
+   ma_table, ma_mask is -1 and ma_fill is the size of ma_values.
+*/
+#define SHARED_KEYS_MAX 30
+
+struct _dictsharedkeys {
+    Py_ssize_t sk_refcnt;
+    PyObject *sk_index;         /* maps the keys to their index */
+    Py_ssize_t sk_nkeys;
+    PyObject *sk_keys[SHARED_KEYS_MAX];
+};
+
+#define DICT_IS_SPLIT(mp) ((mp)->ma_values != NULL)
+#define DICT_IS_SHORT(mp) ((mp)->ma_keys != NULL)
+#define SHORT_DICT_SIZE offsetof(PyDictObject, ma_smalltable)
+
+/* The values of an empty split dict */
+static PyObject *empty_values[1] = {NULL};
+
 /* Initialization macros.
    There are two ways to create a dict:  PyDict_New() is the main C API
    function, and the tp_new slot maps to dict_new().  In the latter case we
@@ -210,6 +247,7 @@ show_track(void)
 #define INIT_NONZERO_DICT_SLOTS(mp) do {                                \
     (mp)->ma_table = (mp)->ma_smalltable;                               \
     (mp)->ma_mask = PyDict_MINSIZE - 1;                                 \
+    (mp)->ma_version_tag = DICT_NEXT_VERSION();                         \
     } while(0)
 
 #define EMPTY_TO_MINSIZE(mp) do {                                       \
@@ -268,6 +306,7 @@ PyDict_New(void)
             INIT_NONZERO_DICT_SLOTS(mp);
         }
         assert (mp->ma_used == 0);
+        assert (mp->ma_keys == NULL && mp->ma_values == NULL);
         assert (mp->ma_table == mp->ma_smalltable);
         assert (mp->ma_mask == PyDict_MINSIZE - 1);
 #ifdef SHOW_ALLOC_COUNT
@@ -278,6 +317,8 @@ PyDict_New(void)
         if (mp == NULL)
             return NULL;
         EMPTY_TO_MINSIZE(mp);
+        mp->ma_keys = NULL;
+        mp->ma_values = NULL;
 #ifdef SHOW_ALLOC_COUNT
         count_alloc++;
 #endif
@@ -489,6 +530,17 @@ _PyDict_MaybeUntrack(PyObject *op)
         return;
 
     mp = (PyDictObject *) op;
+    if (DICT_IS_SPLIT(mp)) {
+        /* the keys are strings */
+        for (i = 0; i < mp->ma_fill; i++) {
+            value = mp->ma_values[i];
+            if (value != NULL && _PyObject_GC_MAY_BE_TRACKED(value))
+                return;
+        }
+        DECREASE_TRACK_COUNT
+        _PyObject_GC_UNTRACK(op);
+        return;
+    }
     ep = mp->ma_table;
     mask = mp->ma_mask;
     for (i = 0; i <= mask; i++) {
@@ -524,6 +576,7 @@ insertdict(register PyDictObject *mp, PyObject *key, long hash, PyObject *value)
         return -1;
     }
     MAINTAIN_TRACKING(mp, key, value);
+    mp->ma_version_tag = DICT_NEXT_VERSION();
     if (ep->me_value != NULL) {
         old_value = ep->me_value;
         ep->me_value = value;
@@ -609,7 +662,7 @@ dictresize(PyDictObject *mp, Py_ssize_t minused)
     assert(oldtable != NULL);
     is_oldtable_malloced = oldtable != mp->ma_smalltable;
 
-    if (newsize == PyDict_MINSIZE) {
+    if (newsize == PyDict_MINSIZE && !DICT_IS_SHORT(mp)) {
         /* A large table is shrinking, or we can't get any smaller. */
         newtable = mp->ma_smalltable;
         if (newtable == oldtable) {
@@ -683,6 +736,259 @@ _PyDict_NewPresized(Py_ssize_t minused)
     return op;
 }
 
+/* Split dicts, see DICT_IS_SPLIT() */
+
+static PyDictSharedKeys *
+sharedkeys_new(void)
+{
+    PyDictSharedKeys *sk = PyMem_NEW(PyDictSharedKeys, 1);
+
+    if (sk == NULL) {
+        PyErr_NoMemory();
+        return NULL;
+    }
+    sk->sk_index = PyDict_New();
+    if (sk->sk_index == NULL) {
+        PyMem_DEL(sk);
+        return NULL;
+    }
+    sk->sk_refcnt = 1;
+    sk->sk_nkeys = 0;
+    return sk;
+}
+
+void
+_PyDict_SharedKeysDecref(PyDictSharedKeys *sk)
+{
+    Py_ssize_t i;
+
+    if (sk == NULL || --sk->sk_refcnt > 0)
+        return;
+    for (i = 0; i < sk->sk_nkeys; i++)
+        Py_DECREF(sk->sk_keys[i]);
+    Py_DECREF(sk->sk_index);
+    PyMem_DEL(sk);
+}
+
+/* Return the index of the string key, or -1 if it is not shared. */
+static Py_ssize_t
+sharedkeys_index(PyDictSharedKeys *sk, PyObject *key, long hash)
+{
+    PyDictObject *index = (PyDictObject *)sk->sk_index;
+    PyDictEntry *ep;
+
+    assert(PyString_CheckExact(key));
+    ep = lookdict_string(index, key, hash);
+    if (ep->me_value == NULL)
+        return -1;
+    return PyInt_AS_LONG(ep->me_value);
+}
+
+/* Add a string key, return its index, -1 if there is no room left
+   and -2 on error. */
+static Py_ssize_t
+sharedkeys_add(PyDictSharedKeys *sk, PyObject *key)
+{
+    Py_ssize_t ix = sk->sk_nkeys;
+    PyObject *v;
+
+    if (ix >= SHARED_KEYS_MAX)
+        return -1;
+    v = PyInt_FromSsize_t(ix);
+    if (v == NULL)
+        return -2;
+    if (PyDict_SetItem(sk->sk_index, key, v) < 0) {
+        Py_DECREF(v);
+        return -2;
+    }
+    Py_DECREF(v);
+    Py_INCREF(key);
+    sk->sk_keys[ix] = key;
+    sk->sk_nkeys++;
+    return ix;
+}
+
+PyObject *
+_PyDict_NewShared(PyTypeObject *tp)
+{
+    PyHeapTypeObject *et = (PyHeapTypeObject *)tp;
+    PyDictObject *mp;
+
+    if (!(tp->tp_flags & Py_TPFLAGS_HEAPTYPE))
+        return PyDict_New();
+    if (et->ht_cached_keys == NULL) {
+        et->ht_cached_keys = sharedkeys_new();
+        if (et->ht_cached_keys == NULL)
+            return NULL;
+    }
+    mp = (PyDictObject *)_PyObject_GC_Malloc(SHORT_DICT_SIZE);
+    if (mp == NULL)
+        return NULL;
+    (void)PyObject_INIT(mp, &PyDict_Type);
+    mp->ma_fill = mp->ma_used = 0;
+    mp->ma_mask = -1;
+    mp->ma_table = NULL;
+    mp->ma_lookup = lookdict_split;
+    mp->ma_version_tag = DICT_NEXT_VERSION();
+    mp->ma_keys = et->ht_cached_keys;
+    mp->ma_keys->sk_refcnt++;
+    mp->ma_values = empty_values;
+#ifdef SHOW_TRACK_COUNT
+    count_untracked++;
+#endif
+    return (PyObject *)mp;
+}
+
+/* Move the items of a split dict into a table of its own. */
+static int
+dict_combine(PyDictObject *mp)
+{
+    PyObject **values = mp->ma_values;
+    PyObject **keys = mp->ma_keys->sk_keys;
+    Py_ssize_t i, n = mp->ma_fill;
+    Py_ssize_t newsize;
+    PyDictEntry *newtable;
+
+    assert(DICT_IS_SPLIT(mp));
+    for (newsize = PyDict_MINSIZE;
+         newsize <= 2 * mp->ma_used;
+         newsize <<= 1)
+        ;
+    newtable = PyMem_NEW(PyDictEntry, newsize);
+    if (newtable == NULL) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    memset(newtable, 0, sizeof(PyDictEntry) * newsize);
+    mp->ma_table = newtable;
+    mp->ma_mask = newsize - 1;
+    mp->ma_fill = mp->ma_used = 0;
+    mp->ma_values = NULL;
+    mp->ma_lookup = lookdict_string;
+
+    /* the values move over, the keys were owned by ma_keys */
+    for (i = 0; i < n; i++) {
+        if (values[i] != NULL) {
+            Py_INCREF(keys[i]);
+            insertdict_clean(mp, keys[i],
+                             ((PyStringObject *)keys[i])->ob_shash,
+                             values[i]);
+        }
+    }
+    if (values != empty_values)
+        PyMem_DEL(values);
+    return 0;
+}
+
+/* Return the address of the value of a string key in a split dict,
+   or NULL if the key is not shared or beyond the values. */
+static PyObject **
+split_lookup(PyDictObject *mp, PyObject *key, long hash)
+{
+    Py_ssize_t ix = sharedkeys_index(mp->ma_keys, key, hash);
+
+    if (ix < 0 || ix >= mp->ma_fill)
+        return NULL;
+    return &mp->ma_values[ix];
+}
+
+/* The entry that lookdict_split() returns, valid until the next lookup */
+static PyDictEntry split_entry;
+
+static PyDictEntry *
+split_entry_set(PyObject *key, long hash, PyObject *value)
+{
+    split_entry.me_hash = hash;
+    split_entry.me_key = value == NULL ? NULL : key;
+    split_entry.me_value = value;
+    return &split_entry;
+}
+
+/* The lookup function of split dicts.  It only reads, so that the
+   iterators of the dict stay valid: the entry is a copy, and who
+   wants to store into it must combine the dict first.  A key that
+   is not an exact string can still be equal to one of the keys. */
+static PyDictEntry *
+lookdict_split(PyDictObject *mp, PyObject *key, long hash)
+{
+    PyObject **values = mp->ma_values;
+    PyObject **keys = mp->ma_keys->sk_keys;
+    Py_ssize_t i, n = mp->ma_fill;
+    PyObject *startkey;
+    int cmp;
+
+    if (PyString_CheckExact(key)) {
+        PyObject **pvalue = split_lookup(mp, key, hash);
+
+        if (pvalue == NULL)
+            return split_entry_set(key, hash, NULL);
+        return split_entry_set(keys[pvalue - values], hash, *pvalue);
+    }
+    for (i = 0; i < n; i++) {
+        startkey = keys[i];
+        if (values[i] == NULL ||
+            ((PyStringObject *)startkey)->ob_shash != hash)
+            continue;
+        Py_INCREF(startkey);
+        cmp = PyObject_RichCompareBool(startkey, key, Py_EQ);
+        Py_DECREF(startkey);
+        if (cmp < 0)
+            return NULL;
+        if (mp->ma_values != values || mp->ma_fill != n)
+            /* The compare changed the dict; start over. */
+            return (mp->ma_lookup)(mp, key, hash);
+        if (cmp > 0)
+            return split_entry_set(startkey, hash, values[i]);
+    }
+    return split_entry_set(key, hash, NULL);
+}
+
+/* Store a string key in a split dict.  Returns 1 if the dict must be
+   combined for the key, else 0, or -1 on error. */
+static int
+split_setitem(PyDictObject *mp, PyObject *key, long hash, PyObject *value)
+{
+    PyDictSharedKeys *sk = mp->ma_keys;
+    Py_ssize_t ix;
+    PyObject *old_value;
+
+    ix = sharedkeys_index(sk, key, hash);
+    if (ix < 0) {
+        ix = sharedkeys_add(sk, key);
+        if (ix == -1)
+            return 1;
+        if (ix < 0)
+            return -1;
+    }
+    if (ix >= mp->ma_fill) {
+        /* make room for all the keys the other instances have */
+        Py_ssize_t size = sk->sk_nkeys;
+        PyObject **values = PyMem_NEW(PyObject *, size);
+
+        if (values == NULL) {
+            PyErr_NoMemory();
+            return -1;
+        }
+        memcpy(values, mp->ma_values, mp->ma_fill * sizeof(PyObject *));
+        memset(values + mp->ma_fill, 0,
+               (size - mp->ma_fill) * sizeof(PyObject *));
+        if (mp->ma_values != empty_values)
+            PyMem_DEL(mp->ma_values);
+        mp->ma_values = values;
+        mp->ma_fill = size;
+    }
+    MAINTAIN_TRACKING(mp, key, value);
+    mp->ma_version_tag = DICT_NEXT_VERSION();
+    old_value = mp->ma_values[ix];
+    Py_INCREF(value);
+    mp->ma_values[ix] = value;
+    if (old_value == NULL)
+        mp->ma_used++;
+    else
+        Py_DECREF(old_value); /* which **CAN** re-enter */
+    return 0;
+}
+
 /* Note that, for historical reasons, PyDict_GetItem() suppresses all errors
  * that may occur (originally dicts supported only string keys, and exceptions
  * weren't possible).  So, while the original intent was that a NULL return
@@ -711,6 +1017,10 @@ PyDict_GetItem(PyObject *op, PyObject *key)
             return NULL;
         }
     }
+    if (DICT_IS_SPLIT(mp) && PyString_CheckExact(key)) {
+        PyObject **pvalue = split_lookup(mp, key, hash);
+        return pvalue == NULL ? NULL : *pvalue;
+    }
 
     /* We can arrive here with a NULL tstate during initialization: try
        running "python -Wi" for an example related to string interning.
@@ -738,6 +1048,47 @@ PyDict_GetItem(PyObject *op, PyObject *key)
     return ep->me_value;
 }
 
+PyObject *
+_PyDict_GetItemHint(PyObject *op, PyObject *key, Py_ssize_t *hint)
+{
+    PyDictObject *mp = (PyDictObject *)op;
+    Py_ssize_t i = *hint;
+    PyDictEntry *ep;
+    long hash;
+
+    assert(PyDict_Check(op) && PyString_CheckExact(key));
+    if (DICT_IS_SPLIT(mp)) {
+        if (i >= 0 && i < mp->ma_fill && mp->ma_keys->sk_keys[i] == key)
+            return mp->ma_values[i];
+    }
+    else if (i >= 0 && i <= mp->ma_mask && mp->ma_table[i].me_key == key &&
+             mp->ma_table[i].me_value != NULL)
+        return mp->ma_table[i].me_value;
+    hash = ((PyStringObject *)key)->ob_shash;
+    if (hash == -1) {
+        hash = PyObject_Hash(key);
+        if (hash == -1) {
+            PyErr_Clear();
+            return NULL;
+        }
+    }
+    if (DICT_IS_SPLIT(mp)) {
+        i = sharedkeys_index(mp->ma_keys, key, hash);
+        if (i < 0 || i >= mp->ma_fill)
+            return NULL;
+        *hint = i;
+        return mp->ma_values[i];
+    }
+    ep = (mp->ma_lookup)(mp, key, hash);
+    if (ep == NULL) {
+        PyErr_Clear();
+        return NULL;
+    }
+    if (ep->me_value != NULL)
+        *hint = ep - mp->ma_table;
+    return ep->me_value;
+}
+
 /* CAUTION: PyDict_SetItem() must guarantee that it won't resize the
  * dictionary if it's merely replacing the value for an existing key.
  * This means that it's safe to loop over a dictionary with PyDict_Next()
@@ -768,6 +1119,15 @@ PyDict_SetItem(register PyObject *op, PyObject *key, PyObject *value)
         if (hash == -1)
             return -1;
     }
+    if (DICT_IS_SPLIT(mp)) {
+        int status = 1;
+        if (PyString_CheckExact(key))
+            status = split_setitem(mp, key, hash, value);
+        if (status <= 0)
+            return status;
+        if (dict_combine(mp) < 0)
+            return -1;
+    }
     assert(mp->ma_fill <= mp->ma_mask);  /* at least one empty slot */
     n_used = mp->ma_used;
     Py_INCREF(value);
@@ -813,7 +1173,26 @@ PyDict_DelItem(PyObject *op, PyObject *key)
             return -1;
     }
     mp = (PyDictObject *)op;
+    if (DICT_IS_SPLIT(mp) && PyString_CheckExact(key)) {
+        PyObject **pvalue = split_lookup(mp, key, hash);
+        if (pvalue == NULL || *pvalue == NULL) {
+            set_key_error(key);
+            return -1;
+        }
+        old_value = *pvalue;
+        *pvalue = NULL;
+        mp->ma_used--;
+        mp->ma_version_tag = DICT_NEXT_VERSION();
+        Py_DECREF(old_value);
+        return 0;
+    }
     ep = (mp->ma_lookup)(mp, key, hash);
+    if (ep != NULL && ep->me_value != NULL && DICT_IS_SPLIT(mp)) {
+        /* deleting a key of another type needs a table */
+        if (dict_combine(mp) < 0)
+            return -1;
+        ep = (mp->ma_lookup)(mp, key, hash);
+    }
     if (ep == NULL)
         return -1;
     if (ep->me_value == NULL) {
@@ -826,6 +1205,7 @@ PyDict_DelItem(PyObject *op, PyObject *key)
     old_value = ep->me_value;
     ep->me_value = NULL;
     mp->ma_used--;
+    mp->ma_version_tag = DICT_NEXT_VERSION();
     Py_DECREF(old_value);
     Py_DECREF(old_key);
     return 0;
@@ -851,6 +1231,20 @@ PyDict_Clear(PyObject *op)
     i = 0;
 #endif
 
+    if (DICT_IS_SPLIT(mp)) {
+        PyObject **values = mp->ma_values;
+        /* same game as below */
+        fill = mp->ma_fill;
+        mp->ma_values = empty_values;
+        mp->ma_fill = mp->ma_used = 0;
+        mp->ma_version_tag = DICT_NEXT_VERSION();
+        while (--fill >= 0)
+            Py_XDECREF(values[fill]);
+        if (values != empty_values)
+            PyMem_DEL(values);
+        return;
+    }
+
     table = mp->ma_table;
     assert(table != NULL);
     table_is_malloced = table != mp->ma_smalltable;
@@ -862,7 +1256,16 @@ PyDict_Clear(PyObject *op)
      * clearing.
      */
     fill = mp->ma_fill;
-    if (table_is_malloced)
+    if (DICT_IS_SHORT(mp)) {
+        /* there is no small table, split it again */
+        mp->ma_table = NULL;
+        mp->ma_mask = -1;
+        mp->ma_fill = mp->ma_used = 0;
+        mp->ma_lookup = lookdict_split;
+        mp->ma_values = empty_values;
+        mp->ma_version_tag = DICT_NEXT_VERSION();
+    }
+    else if (table_is_malloced)
         EMPTY_TO_MINSIZE(mp);
 
     else if (fill > 0) {
@@ -915,20 +1318,50 @@ PyDict_Clear(PyObject *op)
  * the values associated with the keys (but doesn't insert new keys or
  * delete keys), via PyDict_SetItem().
  */
+
+/* The values of a split dict are iterated in the order of the keys */
+static int
+split_next(PyDictObject *mp, Py_ssize_t *ppos, PyObject **pkey,
+           PyObject **pvalue, long *phash)
+{
+    Py_ssize_t i = *ppos;
+    Py_ssize_t n = mp->ma_fill;
+    PyObject **values = mp->ma_values;
+    PyObject *key;
+
+    while (i < n && values[i] == NULL)
+        i++;
+    *ppos = i+1;
+    if (i >= n)
+        return 0;
+    key = mp->ma_keys->sk_keys[i];
+    if (phash)
+        *phash = ((PyStringObject *)key)->ob_shash;
+    if (pkey)
+        *pkey = key;
+    if (pvalue)
+        *pvalue = values[i];
+    return 1;
+}
+
 int
 PyDict_Next(PyObject *op, Py_ssize_t *ppos, PyObject **pkey, PyObject **pvalue)
 {
     register Py_ssize_t i;
     register Py_ssize_t mask;
     register PyDictEntry *ep;
+    PyDictObject *mp;
 
     if (!PyDict_Check(op))
         return 0;
     i = *ppos;
     if (i < 0)
         return 0;
-    ep = ((PyDictObject *)op)->ma_table;
-    mask = ((PyDictObject *)op)->ma_mask;
+    mp = (PyDictObject *)op;
+    if (DICT_IS_SPLIT(mp))
+        return split_next(mp, ppos, pkey, pvalue, NULL);
+    ep = mp->ma_table;
+    mask = mp->ma_mask;
     while (i <= mask && ep[i].me_value == NULL)
         i++;
     *ppos = i+1;
@@ -948,14 +1381,18 @@ _PyDict_Next(PyObject *op, Py_ssize_t *ppos, PyObject **pkey, PyObject **pvalue,
     register Py_ssize_t i;
     register Py_ssize_t mask;
     register PyDictEntry *ep;
+    PyDictObject *mp;
 
     if (!PyDict_Check(op))
         return 0;
     i = *ppos;
     if (i < 0)
         return 0;
-    ep = ((PyDictObject *)op)->ma_table;
-    mask = ((PyDictObject *)op)->ma_mask;
+    mp = (PyDictObject *)op;
+    if (DICT_IS_SPLIT(mp))
+        return split_next(mp, ppos, pkey, pvalue, phash);
+    ep = mp->ma_table;
+    mask = mp->ma_mask;
     while (i <= mask && ep[i].me_value == NULL)
         i++;
     *ppos = i+1;
@@ -978,16 +1415,29 @@ dict_dealloc(register PyDictObject *mp)
     Py_ssize_t fill = mp->ma_fill;
     PyObject_GC_UnTrack(mp);
     Py_TRASHCAN_SAFE_BEGIN(mp)
-    for (ep = mp->ma_table; fill > 0; ep++) {
-        if (ep->me_key) {
-            --fill;
-            Py_DECREF(ep->me_key);
-            Py_XDECREF(ep->me_value);
+    if (DICT_IS_SPLIT(mp)) {
+        while (--fill >= 0)
+            Py_XDECREF(mp->ma_values[fill]);
+        if (mp->ma_values != empty_values)
+            PyMem_DEL(mp->ma_values);
+    }
+    else {
+        for (ep = mp->ma_table; fill > 0; ep++) {
+            if (ep->me_key) {
+                --fill;
+                Py_DECREF(ep->me_key);
+                Py_XDECREF(ep->me_value);
+            }
         }
+        if (mp->ma_table != mp->ma_smalltable)
+            PyMem_DEL(mp->ma_table);
     }
-    if (mp->ma_table != mp->ma_smalltable)
-        PyMem_DEL(mp->ma_table);
-    if (numfree < PyDict_MAXFREELIST && Py_TYPE(mp) == &PyDict_Type)
+    if (DICT_IS_SHORT(mp)) {
+        /* too short for the free list */
+        _PyDict_SharedKeysDecref(mp->ma_keys);
+        Py_TYPE(mp)->tp_free((PyObject *)mp);
+    }
+    else if (numfree < PyDict_MAXFREELIST && Py_TYPE(mp) == &PyDict_Type)
         free_list[numfree++] = mp;
     else
         Py_TYPE(mp)->tp_free((PyObject *)mp);
@@ -997,9 +1447,10 @@ dict_dealloc(register PyDictObject *mp)
 static int
 dict_print(register PyDictObject *mp, register FILE *fp, register int flags)
 {
-    register Py_ssize_t i;
+    Py_ssize_t i;
     register Py_ssize_t any;
     int status;
+    PyObject *key, *pvalue;
 
     status = Py_ReprEnter((PyObject*)mp);
     if (status != 0) {
@@ -1015,33 +1466,30 @@ dict_print(register PyDictObject *mp, register FILE *fp, register int flags)
     fprintf(fp, "{");
     Py_END_ALLOW_THREADS
     any = 0;
-    for (i = 0; i <= mp->ma_mask; i++) {
-        PyDictEntry *ep = mp->ma_table + i;
-        PyObject *pvalue = ep->me_value;
-        if (pvalue != NULL) {
-            /* Prevent PyObject_Repr from deleting value during
-               key format */
-            Py_INCREF(pvalue);
-            if (any++ > 0) {
-                Py_BEGIN_ALLOW_THREADS
-                fprintf(fp, ", ");
-                Py_END_ALLOW_THREADS
-            }
-            if (PyObject_Print((PyObject *)ep->me_key, fp, 0)!=0) {
-                Py_DECREF(pvalue);
-                Py_ReprLeave((PyObject*)mp);
-                return -1;
-            }
+    i = 0;
+    while (PyDict_Next((PyObject *)mp, &i, &key, &pvalue)) {
+        /* Prevent PyObject_Repr from deleting value during
+           key format */
+        Py_INCREF(pvalue);
+        if (any++ > 0) {
             Py_BEGIN_ALLOW_THREADS
-            fprintf(fp, ": ");
+            fprintf(fp, ", ");
             Py_END_ALLOW_THREADS
-            if (PyObject_Print(pvalue, fp, 0) != 0) {
-                Py_DECREF(pvalue);
-                Py_ReprLeave((PyObject*)mp);
-                return -1;
-            }
+        }
+        if (PyObject_Print(key, fp, 0)!=0) {
             Py_DECREF(pvalue);
+            Py_ReprLeave((PyObject*)mp);
+            return -1;
         }
+        Py_BEGIN_ALLOW_THREADS
+        fprintf(fp, ": ");
+        Py_END_ALLOW_THREADS
+        if (PyObject_Print(pvalue, fp, 0) != 0) {
+            Py_DECREF(pvalue);
+            Py_ReprLeave((PyObject*)mp);
+            return -1;
+        }
+        Py_DECREF(pvalue);
     }
     Py_BEGIN_ALLOW_THREADS
     fprintf(fp, "}");
@@ -1141,17 +1589,23 @@ dict_subscript(PyDictObject *mp, register PyObject *key)
     PyObject *v;
     long hash;
     PyDictEntry *ep;
-    assert(mp->ma_table != NULL);
+    assert(mp->ma_table != NULL || DICT_IS_SPLIT(mp));
     if (!PyString_CheckExact(key) ||
         (hash = ((PyStringObject *) key)->ob_shash) == -1) {
         hash = PyObject_Hash(key);
         if (hash == -1)
             return NULL;
     }
-    ep = (mp->ma_lookup)(mp, key, hash);
-    if (ep == NULL)
-        return NULL;
-    v = ep->me_value;
+    if (DICT_IS_SPLIT(mp) && PyString_CheckExact(key)) {
+        PyObject **pvalue = split_lookup(mp, key, hash);
+        v = pvalue == NULL ? NULL : *pvalue;
+    }
+    else {
+        ep = (mp->ma_lookup)(mp, key, hash);
+        if (ep == NULL)
+            return NULL;
+        v = ep->me_value;
+    }
     if (v == NULL) {
         if (!PyDict_CheckExact(mp)) {
             /* Look up __missing__ method if we're a subclass. */
@@ -1196,9 +1650,9 @@ static PyObject *
 dict_keys(register PyDictObject *mp)
 {
     register PyObject *v;
-    register Py_ssize_t i, j;
-    PyDictEntry *ep;
-    Py_ssize_t mask, n;
+    Py_ssize_t i, j;
+    PyObject *key;
+    Py_ssize_t n;
 
   again:
     n = mp->ma_used;
@@ -1212,15 +1666,9 @@ dict_keys(register PyDictObject *mp)
         Py_DECREF(v);
         goto again;
     }
-    ep = mp->ma_table;
-    mask = mp->ma_mask;
-    for (i = 0, j = 0; i <= mask; i++) {
-        if (ep[i].me_value != NULL) {
-            PyObject *key = ep[i].me_key;
-            Py_INCREF(key);
-            PyList_SET_ITEM(v, j, key);
-            j++;
-        }
+    for (i = 0, j = 0; PyDict_Next((PyObject *)mp, &i, &key, NULL); j++) {
+        Py_INCREF(key);
+        PyList_SET_ITEM(v, j, key);
     }
     assert(j == n);
     return v;
@@ -1230,9 +1678,9 @@ static PyObject *
 dict_values(register PyDictObject *mp)
 {
     register PyObject *v;
-    register Py_ssize_t i, j;
-    PyDictEntry *ep;
-    Py_ssize_t mask, n;
+    Py_ssize_t i, j;
+    PyObject *value;
+    Py_ssize_t n;
 
   again:
     n = mp->ma_used;
@@ -1246,15 +1694,9 @@ dict_values(register PyDictObject *mp)
         Py_DECREF(v);
         goto again;
     }
-    ep = mp->ma_table;
-    mask = mp->ma_mask;
-    for (i = 0, j = 0; i <= mask; i++) {
-        if (ep[i].me_value != NULL) {
-            PyObject *value = ep[i].me_value;
-            Py_INCREF(value);
-            PyList_SET_ITEM(v, j, value);
-            j++;
-        }
+    for (i = 0, j = 0; PyDict_Next((PyObject *)mp, &i, NULL, &value); j++) {
+        Py_INCREF(value);
+        PyList_SET_ITEM(v, j, value);
     }
     assert(j == n);
     return v;
@@ -1264,10 +1706,8 @@ static PyObject *
 dict_items(register PyDictObject *mp)
 {
     register PyObject *v;
-    register Py_ssize_t i, j, n;
-    Py_ssize_t mask;
+    Py_ssize_t i, j, n;
     PyObject *item, *key, *value;
-    PyDictEntry *ep;
 
     /* Preallocate the list of tuples, to avoid allocations during
      * the loop over the items, which could trigger GC, which
@@ -1294,18 +1734,12 @@ dict_items(register PyDictObject *mp)
         goto again;
     }
     /* Nothing we do below makes any function calls. */
-    ep = mp->ma_table;
-    mask = mp->ma_mask;
-    for (i = 0, j = 0; i <= mask; i++) {
-        if ((value=ep[i].me_value) != NULL) {
-            key = ep[i].me_key;
-            item = PyList_GET_ITEM(v, j);
-            Py_INCREF(key);
-            PyTuple_SET_ITEM(item, 0, key);
-            Py_INCREF(value);
-            PyTuple_SET_ITEM(item, 1, value);
-            j++;
-        }
+    for (i = 0, j = 0; PyDict_Next((PyObject *)mp, &i, &key, &value); j++) {
+        item = PyList_GET_ITEM(v, j);
+        Py_INCREF(key);
+        PyTuple_SET_ITEM(item, 0, key);
+        Py_INCREF(value);
+        PyTuple_SET_ITEM(item, 1, value);
     }
     assert(j == n);
     return v;
@@ -1529,7 +1963,29 @@ PyDict_Merge(PyObject *a, PyObject *b, int override)
         return -1;
     }
     mp = (PyDictObject*)a;
-    if (PyDict_Check(b)) {
+    if (PyDict_Check(b) && (DICT_IS_SPLIT(mp) ||
+                            DICT_IS_SPLIT((PyDictObject *)b))) {
+        /* Keep a split target split as long as possible */
+        Py_ssize_t pos = 0;
+        PyObject *key, *value;
+        int status;
+
+        if (b == a)
+            return 0;
+        while (PyDict_Next(b, &pos, &key, &value)) {
+            Py_INCREF(key);
+            Py_INCREF(value);
+            if (override || PyDict_GetItem(a, key) == NULL)
+                status = PyDict_SetItem(a, key, value);
+            else
+                status = 0;
+            Py_DECREF(key);
+            Py_DECREF(value);
+            if (status < 0)
+                return -1;
+        }
+    }
+    else if (PyDict_Check(b)) {
         other = (PyDictObject*)b;
         if (other == mp || other->ma_used == 0)
             /* a.update(a) or a.update({}); nothing to do */
@@ -1767,6 +2223,24 @@ dict_compare(PyDictObject *a, PyDictObject *b)
     else if (a->ma_used > b->ma_used)
         return 1;               /* b is shorter */
 
+    /* characterize() walks the tables, compare copies of split dicts */
+    if (DICT_IS_SPLIT(a) || DICT_IS_SPLIT(b)) {
+        PyObject *acopy, *bcopy;
+
+        acopy = PyDict_Copy((PyObject *)a);
+        if (acopy == NULL)
+            return -1;
+        bcopy = PyDict_Copy((PyObject *)b);
+        if (bcopy == NULL) {
+            Py_DECREF(acopy);
+            return -1;
+        }
+        res = dict_compare((PyDictObject *)acopy, (PyDictObject *)bcopy);
+        Py_DECREF(acopy);
+        Py_DECREF(bcopy);
+        return res;
+    }
+
     /* Same length -- check all keys */
     bdiff = bval = NULL;
     adiff = characterize(a, b, &aval);
@@ -1811,34 +2285,32 @@ static int
 dict_equal(PyDictObject *a, PyDictObject *b)
 {
     Py_ssize_t i;
+    PyObject *key, *aval;
 
     if (a->ma_used != b->ma_used)
         /* can't be equal if # of entries differ */
         return 0;
 
     /* Same # of entries -- check all of 'em.  Exit early on any diff. */
-    for (i = 0; i <= a->ma_mask; i++) {
-        PyObject *aval = a->ma_table[i].me_value;
-        if (aval != NULL) {
-            int cmp;
-            PyObject *bval;
-            PyObject *key = a->ma_table[i].me_key;
-            /* temporarily bump aval's refcount to ensure it stays
-               alive until we're done with it */
-            Py_INCREF(aval);
-            /* ditto for key */
-            Py_INCREF(key);
-            bval = PyDict_GetItem((PyObject *)b, key);
-            Py_DECREF(key);
-            if (bval == NULL) {
-                Py_DECREF(aval);
-                return 0;
-            }
-            cmp = PyObject_RichCompareBool(aval, bval, Py_EQ);
+    i = 0;
+    while (PyDict_Next((PyObject *)a, &i, &key, &aval)) {
+        int cmp;
+        PyObject *bval;
+        /* temporarily bump aval's refcount to ensure it stays
+           alive until we're done with it */
+        Py_INCREF(aval);
+        /* ditto for key */
+        Py_INCREF(key);
+        bval = PyDict_GetItem((PyObject *)b, key);
+        Py_DECREF(key);
+        if (bval == NULL) {
             Py_DECREF(aval);
-            if (cmp <= 0)  /* error or not equal */
-                return cmp;
+            return 0;
         }
+        cmp = PyObject_RichCompareBool(aval, bval, Py_EQ);
+        Py_DECREF(aval);
+        if (cmp <= 0)  /* error or not equal */
+            return cmp;
     }
     return 1;
  }
@@ -1882,6 +2354,10 @@ dict_contains(register PyDictObject *mp, PyObject *key)
         if (hash == -1)
             return NULL;
     }
+    if (DICT_IS_SPLIT(mp) && PyString_CheckExact(key)) {
+        PyObject **pvalue = split_lookup(mp, key, hash);
+        return PyBool_FromLong(pvalue != NULL && *pvalue != NULL);
+    }
     ep = (mp->ma_lookup)(mp, key, hash);
     if (ep == NULL)
         return NULL;
@@ -1898,7 +2374,7 @@ dict_has_key(register PyDictObject *mp, PyObject *key)
 }
 
 static PyObject *
-dict_get(register PyDictObject *mp, PyObject *args)
+dict_get(register PyDictObject *mp, PyObject **args, Py_ssize_t nargs)
 {
     PyObject *key;
     PyObject *failobj = Py_None;
@@ -1906,7 +2382,7 @@ dict_get(register PyDictObject *mp, PyObject *args)
     long hash;
     PyDictEntry *ep;
 
-    if (!PyArg_UnpackTuple(args, "get", 1, 2, &key, &failobj))
+    if (!_PyArg_UnpackStack(args, nargs, "get", 1, 2, &key, &failobj))
         return NULL;
 
     if (!PyString_CheckExact(key) ||
@@ -1915,10 +2391,16 @@ dict_get(register PyDictObject *mp, PyObject *args)
         if (hash == -1)
             return NULL;
     }
-    ep = (mp->ma_lookup)(mp, key, hash);
-    if (ep == NULL)
-        return NULL;
-    val = ep->me_value;
+    if (DICT_IS_SPLIT(mp) && PyString_CheckExact(key)) {
+        PyObject **pvalue = split_lookup(mp, key, hash);
+        val = pvalue == NULL ? NULL : *pvalue;
+    }
+    else {
+        ep = (mp->ma_lookup)(mp, key, hash);
+        if (ep == NULL)
+            return NULL;
+        val = ep->me_value;
+    }
     if (val == NULL)
         val = failobj;
     Py_INCREF(val);
@@ -1927,7 +2409,8 @@ dict_get(register PyDictObject *mp, PyObject *args)
 
 
 static PyObject *
-dict_setdefault(register PyDictObject *mp, PyObject *args)
+dict_setdefault(register PyDictObject *mp, PyObject **args,
+                Py_ssize_t nargs)
 {
     PyObject *key;
     PyObject *failobj = Py_None;
@@ -1935,7 +2418,8 @@ dict_setdefault(register PyDictObject *mp, PyObject *args)
     long hash;
     PyDictEntry *ep;
 
-    if (!PyArg_UnpackTuple(args, "setdefault", 1, 2, &key, &failobj))
+    if (!_PyArg_UnpackStack(args, nargs, "setdefault", 1, 2,
+                            &key, &failobj))
         return NULL;
 
     if (!PyString_CheckExact(key) ||
@@ -1966,14 +2450,14 @@ dict_clear(register PyDictObject *mp)
 }
 
 static PyObject *
-dict_pop(PyDictObject *mp, PyObject *args)
+dict_pop(PyDictObject *mp, PyObject **args, Py_ssize_t nargs)
 {
     long hash;
     PyDictEntry *ep;
     PyObject *old_value, *old_key;
     PyObject *key, *deflt = NULL;
 
-    if(!PyArg_UnpackTuple(args, "pop", 1, 2, &key, &deflt))
+    if(!_PyArg_UnpackStack(args, nargs, "pop", 1, 2, &key, &deflt))
         return NULL;
     if (mp->ma_used == 0) {
         if (deflt) {
@@ -1991,6 +2475,11 @@ dict_pop(PyDictObject *mp, PyObject *args)
             return NULL;
     }
     ep = (mp->ma_lookup)(mp, key, hash);
+    if (ep != NULL && ep->me_value != NULL && DICT_IS_SPLIT(mp)) {
+        if (dict_combine(mp) < 0)
+            return NULL;
+        ep = (mp->ma_lookup)(mp, key, hash);
+    }
     if (ep == NULL)
         return NULL;
     if (ep->me_value == NULL) {
@@ -2007,6 +2496,7 @@ dict_pop(PyDictObject *mp, PyObject *args)
     old_value = ep->me_value;
     ep->me_value = NULL;
     mp->ma_used--;
+    mp->ma_version_tag = DICT_NEXT_VERSION();
     Py_DECREF(old_key);
     return old_value;
 }
@@ -2036,6 +2526,10 @@ dict_popitem(PyDictObject *mp)
                         "popitem(): dictionary is empty");
         return NULL;
     }
+    if (DICT_IS_SPLIT(mp) && dict_combine(mp) < 0) {
+        Py_DECREF(res);
+        return NULL;
+    }
     /* Set ep to "the first" dict entry with a value.  We abuse the hash
      * field of slot 0 to hold a search finger:
      * If slot 0 has a value, use slot 0.
@@ -2064,6 +2558,7 @@ dict_popitem(PyDictObject *mp)
     ep->me_key = dummy;
     ep->me_value = NULL;
     mp->ma_used--;
+    mp->ma_version_tag = DICT_NEXT_VERSION();
     assert(mp->ma_table[0].me_value == NULL);
     mp->ma_table[0].me_hash = i + 1;  /* next place to start */
     return res;
@@ -2119,6 +2614,16 @@ dict_sizeof(PyDictObject *mp)
 {
     Py_ssize_t res;
 
+    if (DICT_IS_SHORT(mp)) {
+        res = SHORT_DICT_SIZE;
+        if (DICT_IS_SPLIT(mp)) {
+            if (mp->ma_values != empty_values)
+                res += mp->ma_fill * sizeof(PyObject *);
+        }
+        else
+            res += (mp->ma_mask + 1) * sizeof(PyDictEntry);
+        return PyInt_FromSsize_t(res);
+    }
     res = sizeof(PyDictObject);
     if (mp->ma_table != mp->ma_smalltable)
         res = res + (mp->ma_mask + 1) * sizeof(PyDictEntry);
@@ -2205,11 +2710,11 @@ static PyMethodDef mapp_methods[] = {
      sizeof__doc__},
     {"has_key",         (PyCFunction)dict_has_key,      METH_O,
      has_key__doc__},
-    {"get",         (PyCFunction)dict_get,          METH_VARARGS,
+    {"get",         (PyCFunction)dict_get,          METH_FASTCALL,
      get__doc__},
-    {"setdefault",  (PyCFunction)dict_setdefault,   METH_VARARGS,
+    {"setdefault",  (PyCFunction)dict_setdefault,   METH_FASTCALL,
      setdefault_doc__},
-    {"pop",         (PyCFunction)dict_pop,          METH_VARARGS,
+    {"pop",         (PyCFunction)dict_pop,          METH_FASTCALL,
      pop__doc__},
     {"popitem",         (PyCFunction)dict_popitem,      METH_NOARGS,
      popitem__doc__},
@@ -2247,8 +2752,6 @@ int
 PyDict_Contains(PyObject *op, PyObject *key)
 {
     long hash;
-    PyDictObject *mp = (PyDictObject *)op;
-    PyDictEntry *ep;
 
     if (!PyString_CheckExact(key) ||
         (hash = ((PyStringObject *) key)->ob_shash) == -1) {
@@ -2256,8 +2759,7 @@ PyDict_Contains(PyObject *op, PyObject *key)
         if (hash == -1)
             return -1;
     }
-    ep = (mp->ma_lookup)(mp, key, hash);
-    return ep == NULL ? -1 : (ep->me_value != NULL);
+    return _PyDict_Contains(op, key, hash);
 }
 
 /* Internal version of PyDict_Contains used when the hash value is already known */
@@ -2267,6 +2769,10 @@ _PyDict_Contains(PyObject *op, PyObject *key, long hash)
     PyDictObject *mp = (PyDictObject *)op;
     PyDictEntry *ep;
 
+    if (DICT_IS_SPLIT(mp) && PyString_CheckExact(key)) {
+        PyObject **pvalue = split_lookup(mp, key, hash);
+        return pvalue != NULL && *pvalue != NULL;
+    }
     ep = (mp->ma_lookup)(mp, key, hash);
     return ep == NULL ? -1 : (ep->me_value != NULL);
 }
@@ -2492,8 +2998,6 @@ static PyMethodDef dictiter_methods[] = {
 static PyObject *dictiter_iternextkey(dictiterobject *di)
 {
     PyObject *key;
-    register Py_ssize_t i, mask;
-    register PyDictEntry *ep;
     PyDictObject *d = di->di_dict;
 
     if (d == NULL)
@@ -2507,18 +3011,9 @@ static PyObject *dictiter_iternextkey(dictiterobject *di)
         return NULL;
     }
 
-    i = di->di_pos;
-    if (i < 0)
-        goto fail;
-    ep = d->ma_table;
-    mask = d->ma_mask;
-    while (i <= mask && ep[i].me_value == NULL)
-        i++;
-    di->di_pos = i+1;
-    if (i > mask)
+    if (!PyDict_Next((PyObject *)d, &di->di_pos, &key, NULL))
         goto fail;
     di->len--;
-    key = ep[i].me_key;
     Py_INCREF(key);
     return key;
 
@@ -2564,8 +3059,6 @@ PyTypeObject PyDictIterKey_Type = {
 static PyObject *dictiter_iternextvalue(dictiterobject *di)
 {
     PyObject *value;
-    register Py_ssize_t i, mask;
-    register PyDictEntry *ep;
     PyDictObject *d = di->di_dict;
 
     if (d == NULL)
@@ -2579,17 +3072,8 @@ static PyObject *dictiter_iternextvalue(dictiterobject *di)
         return NULL;
     }
 
-    i = di->di_pos;
-    mask = d->ma_mask;
-    if (i < 0 || i > mask)
+    if (!PyDict_Next((PyObject *)d, &di->di_pos, NULL, &value))
         goto fail;
-    ep = d->ma_table;
-    while ((value=ep[i].me_value) == NULL) {
-        i++;
-        if (i > mask)
-            goto fail;
-    }
-    di->di_pos = i+1;
     di->len--;
     Py_INCREF(value);
     return value;
@@ -2636,8 +3120,6 @@ PyTypeObject PyDictIterValue_Type = {
 static PyObject *dictiter_iternextitem(dictiterobject *di)
 {
     PyObject *key, *value, *result = di->di_result;
-    register Py_ssize_t i, mask;
-    register PyDictEntry *ep;
     PyDictObject *d = di->di_dict;
 
     if (d == NULL)
@@ -2651,15 +3133,7 @@ static PyObject *dictiter_iternextitem(dictiterobject *di)
         return NULL;
     }
 
-    i = di->di_pos;
-    if (i < 0)
-        goto fail;
-    ep = d->ma_table;
-    mask = d->ma_mask;
-    while (i <= mask && ep[i].me_value == NULL)
-        i++;
-    di->di_pos = i+1;
-    if (i > mask)
+    if (!PyDict_Next((PyObject *)d, &di->di_pos, &key, &value))
         goto fail;
 
     if (result->ob_refcnt == 1) {
@@ -2672,8 +3146,6 @@ static PyObject *dictiter_iternextitem(dictiterobject *di)
             return NULL;
     }
     di->len--;
-    key = ep[i].me_key;
-    value = ep[i].me_value;
     Py_INCREF(key);
     Py_INCREF(value);
     PyTuple_SET_ITEM(result, 0, key);
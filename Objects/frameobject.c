@@ -426,9 +426,9 @@ static PyGetSetDef frame_getsetlist[] = {
    1. Hold a single "zombie" frame on each code object. This retains
    the allocated and initialised frame object from an invocation of
    the code object. The zombie is reanimated the next time we need a
-   frame object for that code object. Doing this saves the malloc/
-   realloc required when using a free_list frame that isn't the
-   correct size. It also saves some field initialisation.
+   frame object for that code object. Doing this saves the lookup
+   in the frame pool described below. It also saves some field
+   initialisation.
 
    In zombie mode, no field of PyFrameObject holds a reference, but
    the following fields are still valid:
@@ -441,32 +441,33 @@ static PyGetSetDef frame_getsetlist[] = {
      * f_localsplus does not require re-allocation and
        the local variables in f_localsplus are NULL.
 
-   2. We also maintain a separate free list of stack frames (just like
-   integers are allocated in a special way -- see intobject.c).  When
-   a stack frame is on the free list, only the following members have
-   a meaning:
+   2. Every thread keeps a pool of free stack frames in its thread
+   state (tstate->frame_pool), with one free list per size class.  The
+   frames of class i have room for (i+1) * POOL_CLASSSIZE locals, cells
+   and stack entries; new frames are allocated with their size rounded
+   up to the next class, so a frame taken from a free list never needs
+   a realloc.  When a stack frame is on a free list, only the following
+   members have a meaning:
     ob_type             == &Frametype
     f_back              next item on free list, or NULL
-    f_stacksize         size of value stack
     ob_size             size of localsplus
-   Note that the value and block stacks are preserved -- this can save
-   another malloc() call or two (and two free() calls as well!).
-   Also note that, unlike for integers, each frame object is a
-   malloc'ed object in its own right -- it is only the actual calls to
-   malloc() that we are trying to save here, not the administration.
-   After all, while a typical program may make millions of calls, a
-   call depth of more than 20 or 30 is probably already exceptional
-   unless the program contains run-away recursion.  I hope.
-
-   Later, PyFrame_MAXFREELIST was added to bound the # of frames saved on
-   free_list.  Else programs creating lots of cyclic trash involving
-   frames could provoke free_list into growing without bound.
+   Note that, unlike for integers, each frame object is a malloc'ed
+   object in its own right -- it is only the actual calls to malloc()
+   that we are trying to save here, not the administration.
+
+   A frame goes back to the pool of the thread which frees it, and the
+   pool keeps at most fp_limit frames (see sys.setframepoollimit()).
+   Else programs creating lots of cyclic trash involving frames, or
+   tasklets keeping deep chains of frames alive, could make the pool
+   grow without bound.  Frames too large for the biggest class are
+   always freed.
 */
 
-static PyFrameObject *free_list = NULL;
-static int numfree = 0;         /* number of frames currently in free_list */
-/* max value for numfree */
-#define PyFrame_MAXFREELIST 200
+#define POOL_CLASSSIZE 8
+#define POOL_MAXSIZE (PyFrame_POOLCLASSES * POOL_CLASSSIZE)
+
+/* the pool limit of new threads */
+static int pool_limit = 200;
 
 static void
 frame_dealloc(PyFrameObject *f)
@@ -499,13 +500,28 @@ frame_dealloc(PyFrameObject *f)
     co = f->f_code;
     if (co->co_zombieframe == NULL)
         co->co_zombieframe = f;
-    else if (numfree < PyFrame_MAXFREELIST) {
-        ++numfree;
-        f->f_back = free_list;
-        free_list = f;
+    else {
+        PyThreadState *tstate = _PyThreadState_Current;
+
+        if (tstate == NULL)
+            PyObject_GC_Del(f);
+        else if (Py_SIZE(f) < POOL_CLASSSIZE ||
+                 Py_SIZE(f) > POOL_MAXSIZE)
+            PyObject_GC_Del(f);
+        else if (tstate->frame_pool.fp_count <
+                 tstate->frame_pool.fp_limit) {
+            PyFramePool *pool = &tstate->frame_pool;
+            int i = Py_SIZE(f) / POOL_CLASSSIZE - 1;
+
+            ++pool->fp_count;
+            f->f_back = pool->fp_free[i];
+            pool->fp_free[i] = f;
+        }
+        else {
+            ++tstate->frame_pool.fp_released;
+            PyObject_GC_Del(f);
+        }
     }
-    else
-        PyObject_GC_Del(f);
 
     Py_DECREF(co);
     Py_TRASHCAN_SAFE_END(f)
@@ -695,32 +711,36 @@ PyFrame_New(PyThreadState *tstate, PyCodeObject *code, PyObject *globals,
         assert(f->f_code == code);
     }
     else {
-        Py_ssize_t extras, ncells, nfrees;
+        PyFramePool *pool = &tstate->frame_pool;
+        Py_ssize_t extras, ncells, nfrees, size;
         ncells = PyTuple_GET_SIZE(code->co_cellvars);
         nfrees = PyTuple_GET_SIZE(code->co_freevars);
         extras = code->co_stacksize + code->co_nlocals + ncells +
             nfrees;
-        if (free_list == NULL) {
-            f = PyObject_GC_NewVar(PyFrameObject, &PyFrame_Type,
-            extras);
-            if (f == NULL) {
-                Py_DECREF(builtins);
-                return NULL;
+        f = NULL;
+        if (extras <= POOL_MAXSIZE) {
+            i = extras > 0 ? (extras - 1) / POOL_CLASSSIZE : 0;
+            size = (i + 1) * POOL_CLASSSIZE;
+            f = pool->fp_free[i];
+            if (f != NULL) {
+                assert(pool->fp_count > 0 && Py_SIZE(f) == size);
+                --pool->fp_count;
+                pool->fp_free[i] = f->f_back;
             }
         }
+        else
+            size = extras;
+        if (f != NULL) {
+            ++pool->fp_hits;
+            _Py_NewReference((PyObject *)f);
+        }
         else {
-            assert(numfree > 0);
-            --numfree;
-            f = free_list;
-            free_list = free_list->f_back;
-            if (Py_SIZE(f) < extras) {
-                f = PyObject_GC_Resize(PyFrameObject, f, extras);
-                if (f == NULL) {
-                    Py_DECREF(builtins);
-                    return NULL;
-                }
+            ++pool->fp_misses;
+            f = PyObject_GC_NewVar(PyFrameObject, &PyFrame_Type, size);
+            if (f == NULL) {
+                Py_DECREF(builtins);
+                return NULL;
             }
-            _Py_NewReference((PyObject *)f);
         }
 
         f->f_code = code;
@@ -984,22 +1004,65 @@ PyFrame_LocalsToFast(PyFrameObject *f, int clear)
     PyErr_Restore(error_type, error_value, error_traceback);
 }
 
-/* Clear out the free list */
-int
-PyFrame_ClearFreeList(void)
+void
+_PyFrame_InitPool(PyThreadState *tstate)
 {
-    int freelist_size = numfree;
+    memset(&tstate->frame_pool, 0, sizeof(PyFramePool));
+    tstate->frame_pool.fp_limit = pool_limit;
+}
 
-    while (free_list != NULL) {
-        PyFrameObject *f = free_list;
-        free_list = free_list->f_back;
-        PyObject_GC_Del(f);
-        --numfree;
+/* Free the frames kept by a thread */
+int
+_PyFrame_ClearPool(PyThreadState *tstate)
+{
+    PyFramePool *pool = &tstate->frame_pool;
+    int freelist_size = pool->fp_count;
+    int i;
+
+    for (i = 0; i < PyFrame_POOLCLASSES; i++) {
+        while (pool->fp_free[i] != NULL) {
+            PyFrameObject *f = pool->fp_free[i];
+            pool->fp_free[i] = f->f_back;
+            PyObject_GC_Del(f);
+            --pool->fp_count;
+        }
     }
-    assert(numfree == 0);
+    assert(pool->fp_count == 0);
     return freelist_size;
 }
 
+/* Set the pool limit of the current thread and of threads started
+   later.  Frames beyond the new limit are freed. */
+void
+_PyFrame_SetPoolLimit(int limit)
+{
+    PyThreadState *tstate = PyThreadState_GET();
+    PyFramePool *pool = &tstate->frame_pool;
+    int i;
+
+    pool_limit = limit;
+    pool->fp_limit = limit;
+    for (i = PyFrame_POOLCLASSES - 1; i >= 0; i--) {
+        while (pool->fp_count > limit && pool->fp_free[i] != NULL) {
+            PyFrameObject *f = pool->fp_free[i];
+            pool->fp_free[i] = f->f_back;
+            PyObject_GC_Del(f);
+            --pool->fp_count;
+        }
+    }
+}
+
+/* Clear out the free frames of the current thread */
+int
+PyFrame_ClearFreeList(void)
+{
+    PyThreadState *tstate = _PyThreadState_Current;
+
+    if (tstate == NULL)
+        return 0;
+    return _PyFrame_ClearPool(tstate);
+}
+
 void
 PyFrame_Fini(void)
 {
@@ -101,6 +101,12 @@ PyCFunction_Call(PyObject *func, PyObject *arg, PyObject *kw)
     case METH_VARARGS | METH_KEYWORDS:
     case METH_OLDARGS | METH_KEYWORDS:
         WRAP_RETURN( (*(PyCFunctionWithKeywords)meth)(self, arg, kw) )
+    case METH_FASTCALL:
+        if (kw == NULL || PyDict_Size(kw) == 0)
+            WRAP_RETURN( (*(PyCFunctionFast)meth)(self,
+                                &PyTuple_GET_ITEM(arg, 0),
+                                PyTuple_GET_SIZE(arg)) )
+        break;
     case METH_NOARGS:
         if (kw == NULL || PyDict_Size(kw) == 0) {
             size = PyTuple_GET_SIZE(arg);
@@ -143,6 +149,117 @@ PyCFunction_Call(PyObject *func, PyObject *arg, PyObject *kw)
     return NULL;
 }
 
+#ifdef STACKLESS
+#define ML_RETURN(call) { \
+    PyObject * retval; \
+    STACKLESS_PROMOTE_FLAG(ml->ml_flags & METH_STACKLESS); \
+    retval = (call); \
+    STACKLESS_ASSERT(); \
+    return retval; \
+}
+#else
+#define ML_RETURN(call) return (call);
+#endif
+
+/* Call the C function of ml with the arguments in C arrays, like
+   PyCFunction_Call() does with an argument tuple.  Only METH_VARARGS
+   and METH_OLDARGS functions need a tuple to be built. */
+PyObject *
+_PyMethodDef_FastCall(PyMethodDef *ml, PyObject *self, PyObject **args,
+                      Py_ssize_t nargs, PyObject **kws, Py_ssize_t nkws)
+{
+    STACKLESS_GETARG();
+    PyCFunction meth = ml->ml_meth;
+    PyObject *argtuple, *kwdict = NULL, *result;
+    int flags;
+
+    flags = ml->ml_flags & ~(METH_CLASS | METH_STATIC | METH_COEXIST |
+                             METH_STACKLESS);
+    switch (flags) {
+    case METH_NOARGS:
+        if (nkws > 0)
+            break;
+        if (nargs == 0)
+            ML_RETURN( (*meth)(self, NULL) )
+        PyErr_Format(PyExc_TypeError,
+            "%.200s() takes no arguments (%zd given)",
+            ml->ml_name, nargs);
+        return NULL;
+    case METH_O:
+        if (nkws > 0)
+            break;
+        if (nargs == 1)
+            ML_RETURN( (*meth)(self, args[0]) )
+        PyErr_Format(PyExc_TypeError,
+            "%.200s() takes exactly one argument (%zd given)",
+            ml->ml_name, nargs);
+        return NULL;
+    case METH_FASTCALL:
+        if (nkws > 0)
+            break;
+        ML_RETURN( (*(PyCFunctionFast)meth)(self, args, nargs) )
+    case METH_OLDARGS:
+        if (nkws > 0)
+            break;
+        /* the really old style */
+        if (nargs == 1)
+            ML_RETURN( (*meth)(self, args[0]) )
+        if (nargs == 0)
+            ML_RETURN( (*meth)(self, NULL) )
+        /* fall through */
+    case METH_VARARGS:
+        if (nkws > 0)
+            break;
+        /* fall through */
+    case METH_VARARGS | METH_KEYWORDS:
+    case METH_OLDARGS | METH_KEYWORDS:
+        argtuple = _PyStack_AsTuple(args, nargs);
+        if (argtuple == NULL)
+            return NULL;
+        if (flags & METH_KEYWORDS) {
+            if (nkws > 0) {
+                kwdict = _PyStack_AsDict(kws, nkws, NULL);
+                if (kwdict == NULL) {
+                    Py_DECREF(argtuple);
+                    return NULL;
+                }
+            }
+            STACKLESS_PROMOTE_FLAG(ml->ml_flags & METH_STACKLESS);
+            result = (*(PyCFunctionWithKeywords)meth)(self, argtuple,
+                                                      kwdict);
+        }
+        else {
+            STACKLESS_PROMOTE_FLAG(ml->ml_flags & METH_STACKLESS);
+            result = (*meth)(self, argtuple);
+        }
+        STACKLESS_ASSERT();
+        Py_DECREF(argtuple);
+        Py_XDECREF(kwdict);
+        return result;
+    default:
+        PyErr_BadInternalCall();
+        return NULL;
+    }
+    PyErr_Format(PyExc_TypeError, "%.200s() takes no keyword arguments",
+                 ml->ml_name);
+    return NULL;
+}
+
+PyObject *
+_PyCFunction_FastCall(PyObject *func, PyObject **args, Py_ssize_t nargs,
+                      PyObject **kws, Py_ssize_t nkws)
+{
+    STACKLESS_GETARG();
+    PyObject *result;
+
+    STACKLESS_PROMOTE_ALL();
+    result = _PyMethodDef_FastCall(((PyCFunctionObject *)func)->m_ml,
+                                   PyCFunction_GET_SELF(func),
+                                   args, nargs, kws, nkws);
+    STACKLESS_ASSERT();
+    return result;
+}
+
 /* Methods (the standard built-in methods, that is) */
 
 static void
@@ -1498,7 +1498,7 @@ PyObject_GenericSetAttr(PyObject *obj, PyObject *name, PyObject *value)
     if (dictptr != NULL) {
         PyObject *dict = *dictptr;
         if (dict == NULL && value != NULL) {
-            dict = PyDict_New();
+            dict = _PyDict_NewShared(tp);
             if (dict == NULL)
                 goto done;
             *dictptr = dict;
@@ -1536,6 +1536,215 @@ PyObject_GenericSetAttr(PyObject *obj, PyObject *name, PyObject *value)
     return res;
 }
 
+/* Cached versions of the generic attribute functions. They do what
+   PyObject_GenericGetAttr() and PyObject_GenericSetAttr() do, but take
+   the type lookup from the cache, and try the hint before searching
+   the instance dict. Other types, like classic instances, fall back to
+   PyObject_GetAttr() and PyObject_SetAttr(). */
+
+static PyAttrCacheEntry *
+attrcache_lookup(PyAttrCache *cache, PyTypeObject *tp, PyObject *name)
+{
+    PyAttrCacheEntry *e;
+    PyObject *descr;
+    int i;
+
+    if (PyType_HasFeature(tp, Py_TPFLAGS_VALID_VERSION_TAG)) {
+        for (i = 0; i < PY_ATTRCACHE_WAYS; i++) {
+            e = &cache->ac_entries[i];
+            if (e->ac_type == tp && e->ac_version == tp->tp_version_tag)
+                return e;
+        }
+    }
+    if (tp->tp_dict == NULL)
+        return NULL;
+    descr = _PyType_Lookup(tp, name);
+    if (!PyType_HasFeature(tp, Py_TPFLAGS_VALID_VERSION_TAG))
+        return NULL;
+    e = &cache->ac_entries[cache->ac_next];
+    cache->ac_next = (cache->ac_next + 1) % PY_ATTRCACHE_WAYS;
+    e->ac_type = tp;
+    e->ac_version = tp->tp_version_tag;
+    e->ac_descr = descr;
+    e->ac_hint = -1;
+    return e;
+}
+
+PyObject *
+_PyObject_GetAttrCached(PyObject *obj, PyObject *name, PyAttrCache *cache)
+{
+    PyTypeObject *tp = Py_TYPE(obj);
+    PyAttrCacheEntry *e;
+    PyObject *descr, *res, **dictptr;
+    descrgetfunc f;
+
+    if (tp->tp_getattro != PyObject_GenericGetAttr ||
+        !PyString_CheckExact(name) ||
+        (e = attrcache_lookup(cache, tp, name)) == NULL)
+        return PyObject_GetAttr(obj, name);
+
+    descr = e->ac_descr;
+    Py_XINCREF(descr);
+
+    f = NULL;
+    if (descr != NULL &&
+        PyType_HasFeature(descr->ob_type, Py_TPFLAGS_HAVE_CLASS)) {
+        f = descr->ob_type->tp_descr_get;
+        if (f != NULL && PyDescr_IsData(descr)) {
+            res = f(descr, obj, (PyObject *)tp);
+            Py_DECREF(descr);
+            return res;
+        }
+    }
+
+    if (tp->tp_dictoffset > 0)
+        dictptr = (PyObject **) ((char *)obj + tp->tp_dictoffset);
+    else
+        dictptr = _PyObject_GetDictPtr(obj);
+    if (dictptr != NULL && *dictptr != NULL) {
+        PyObject *dict = *dictptr;
+        /* e may be reused meanwhile, the hint is only a hint */
+        Py_ssize_t hint = e->ac_hint;
+
+        Py_INCREF(dict);
+        res = _PyDict_GetItemHint(dict, name, &hint);
+        e->ac_hint = hint;
+        if (res != NULL) {
+            Py_INCREF(res);
+            Py_XDECREF(descr);
+            Py_DECREF(dict);
+            return res;
+        }
+        Py_DECREF(dict);
+    }
+
+    if (f != NULL) {
+        res = f(descr, obj, (PyObject *)tp);
+        Py_DECREF(descr);
+        return res;
+    }
+
+    if (descr != NULL) {
+        /* descr was already increfed above */
+        return descr;
+    }
+
+    PyErr_Format(PyExc_AttributeError,
+                 "'%.50s' object has no attribute '%.400s'",
+                 tp->tp_name, PyString_AS_STRING(name));
+    return NULL;
+}
+
+int
+_PyObject_SetAttrCached(PyObject *obj, PyObject *name, PyObject *value,
+                        PyAttrCache *cache)
+{
+    PyTypeObject *tp = Py_TYPE(obj);
+    PyAttrCacheEntry *e;
+    PyObject *descr, **dictptr;
+    descrsetfunc f;
+    int res;
+
+    if (tp->tp_setattro != PyObject_GenericSetAttr || value == NULL ||
+        !PyString_CheckExact(name) ||
+        (e = attrcache_lookup(cache, tp, name)) == NULL)
+        return PyObject_SetAttr(obj, name, value);
+
+    descr = e->ac_descr;
+    f = NULL;
+    if (descr != NULL &&
+        PyType_HasFeature(descr->ob_type, Py_TPFLAGS_HAVE_CLASS)) {
+        f = descr->ob_type->tp_descr_set;
+        if (f != NULL && PyDescr_IsData(descr))
+            return f(descr, obj, value);
+    }
+
+    if (tp->tp_dictoffset > 0)
+        dictptr = (PyObject **) ((char *)obj + tp->tp_dictoffset);
+    else
+        dictptr = _PyObject_GetDictPtr(obj);
+    if (dictptr != NULL) {
+        PyObject *dict = *dictptr;
+        if (dict == NULL) {
+            dict = _PyDict_NewShared(tp);
+            if (dict == NULL)
+                return -1;
+            *dictptr = dict;
+        }
+        Py_INCREF(dict);
+        res = PyDict_SetItem(dict, name, value);
+        Py_DECREF(dict);
+        return res;
+    }
+
+    if (f != NULL)
+        return f(descr, obj, value);
+
+    if (descr == NULL) {
+        PyErr_Format(PyExc_AttributeError,
+                     "'%.100s' object has no attribute '%.200s'",
+                     tp->tp_name, PyString_AS_STRING(name));
+        return -1;
+    }
+
+    PyErr_Format(PyExc_AttributeError,
+                 "'%.50s' object attribute '%.400s' is read-only",
+                 tp->tp_name, PyString_AS_STRING(name));
+    return -1;
+}
+
+int
+_PyObject_GetMethod(PyObject *obj, PyObject *name, PyAttrCache *cache,
+                    PyObject **method)
+{
+    PyTypeObject *tp = Py_TYPE(obj);
+    PyAttrCacheEntry *e;
+    PyObject *descr, **dictptr;
+
+    if (tp->tp_getattro != PyObject_GenericGetAttr ||
+        !PyString_CheckExact(name) || tp->tp_dict == NULL)
+        goto attribute;
+    if (cache != NULL) {
+        if ((e = attrcache_lookup(cache, tp, name)) == NULL)
+            goto attribute;
+        descr = e->ac_descr;
+    }
+    else
+        descr = _PyType_Lookup(tp, name);
+    /* only functions and methods of builtin types, other descriptors
+       have faster bound forms */
+    if (descr == NULL ||
+        !(PyFunction_Check(descr) || PyMethodDescr_Check(descr)))
+        goto attribute;
+
+    Py_INCREF(descr);
+    dictptr = _PyObject_GetDictPtr(obj);
+    if (dictptr != NULL && *dictptr != NULL) {
+        PyObject *dict = *dictptr, *res;
+
+        Py_INCREF(dict);
+        res = PyDict_GetItem(dict, name);
+        if (res != NULL) {
+            /* shadowed by an instance attribute, borrowed from dict */
+            Py_INCREF(res);
+            Py_DECREF(dict);
+            Py_DECREF(descr);
+            *method = res;
+            return 0;
+        }
+        Py_DECREF(dict);
+    }
+    *method = descr;
+    return 1;
+
+  attribute:
+    if (cache != NULL)
+        *method = _PyObject_GetAttrCached(obj, name, cache);
+    else
+        *method = PyObject_GetAttr(obj, name);
+    return 0;
+}
+
 /* Test a value used as condition, e.g., in a for or if statement.
    Return -1 if an error occurred */
 
@@ -1,4 +1,7 @@
 #include "Python.h"
+#ifdef STACKLESS
+#include "core/stackless_impl.h"
+#endif
 
 #ifdef WITH_PYMALLOC
 
@@ -734,9 +737,24 @@ int Py_ADDRESS_IN_RANGE(void *P, poolp pool) Py_NO_INLINE;
  * Unless the optimizer reorders everything, being too smart...
  */
 
+#ifdef STACKLESS
+/* the public entry points add tasklet accounting, see below */
+static void *pymalloc_malloc(size_t nbytes);
+static void pymalloc_free(void *p);
+static void *pymalloc_realloc(void *p, size_t nbytes);
+#else
+#define pymalloc_malloc PyObject_Malloc
+#define pymalloc_free PyObject_Free
+#define pymalloc_realloc PyObject_Realloc
+#endif
+
 #undef PyObject_Malloc
+#ifdef STACKLESS
+static void *
+#else
 void *
-PyObject_Malloc(size_t nbytes)
+#endif
+pymalloc_malloc(size_t nbytes)
 {
     block *bp;
     poolp pool;
@@ -938,8 +956,12 @@ redirect:
 /* free */
 
 #undef PyObject_Free
+#ifdef STACKLESS
+static void
+#else
 void
-PyObject_Free(void *p)
+#endif
+pymalloc_free(void *p)
 {
     poolp pool;
     block *lastfree;
@@ -1161,15 +1183,19 @@ redirect:
  */
 
 #undef PyObject_Realloc
+#ifdef STACKLESS
+static void *
+#else
 void *
-PyObject_Realloc(void *p, size_t nbytes)
+#endif
+pymalloc_realloc(void *p, size_t nbytes)
 {
     void *bp;
     poolp pool;
     size_t size;
 
     if (p == NULL)
-        return PyObject_Malloc(nbytes);
+        return pymalloc_malloc(nbytes);
 
     /*
      * Limit ourselves to PY_SSIZE_T_MAX bytes to prevent security holes.
@@ -1206,10 +1232,10 @@ PyObject_Realloc(void *p, size_t nbytes)
             }
             size = nbytes;
         }
-        bp = PyObject_Malloc(nbytes);
+        bp = pymalloc_malloc(nbytes);
         if (bp != NULL) {
             memcpy(bp, p, size);
-            PyObject_Free(p);
+            pymalloc_free(p);
         }
         return bp;
     }
@@ -1238,6 +1264,321 @@ PyObject_Realloc(void *p, size_t nbytes)
     return bp ? bp : p;
 }
 
+#ifdef STACKLESS
+
+/*==========================================================================*/
+/* Tasklet memory accounting.
+ *
+ * If PYTHONTASKLETMEMORY is set when the first block is requested, every
+ * block gets a header in front, which tells the account of the tasklet
+ * that allocated it and the requested size. The account is charged on
+ * allocation and credited on free, no matter which tasklet frees the
+ * block. The mode is fixed at the first call, since the blocks handed
+ * out before would lack the header.
+ *
+ * Like the plain allocator, PyObject_Free and PyObject_Realloc accept
+ * memory which came from elsewhere, typically PyMem_MALLOC, so whether
+ * a pointer is ours is decided from our own state, never from the bytes
+ * in front of it. In this mode every block in pymalloc's pools carries
+ * a header, and Py_ADDRESS_IN_RANGE finds those. The blocks which
+ * pymalloc passes on to malloc, the large ones, are kept in a small hash
+ * table by address. Anything else is passed on to pymalloc as is.
+ *
+ * Blocks allocated outside of any tasklet are charged to the head of
+ * the account ring, slp_memaccounts, which has no tasklet.
+ */
+
+typedef struct {
+    PySlpMemAccount *account;
+    size_t size;
+} memaccount_header;
+
+#define MA_HEADER_SIZE sizeof(memaccount_header)
+#define MA_HEADER(p) ((memaccount_header *) (p) - 1)
+
+PySlpMemAccount slp_memaccounts = {
+    &slp_memaccounts, &slp_memaccounts, NULL, 0, 0
+};
+
+static int memaccount_mode = -1;        /* -1: not yet decided */
+
+int
+slp_memaccount_enabled(void)
+{
+    if (memaccount_mode < 0)
+        memaccount_mode = Py_GETENV("PYTHONTASKLETMEMORY") != NULL;
+    return memaccount_mode;
+}
+
+static PySlpMemAccount *
+memaccount_current(void)
+{
+    PyThreadState *ts = _PyThreadState_Current;
+    PyTaskletObject *t;
+    PySlpMemAccount *a;
+
+    /* a tasklet in its deallocator must not get a new account */
+    if (ts == NULL || (t = ts->st.current) == NULL || Py_REFCNT(t) <= 0)
+        return &slp_memaccounts;
+    a = t->memaccount;
+    if (a == NULL) {
+        a = (PySlpMemAccount *) malloc(sizeof(PySlpMemAccount));
+        if (a == NULL)
+            return &slp_memaccounts;
+        a->task = t;
+        a->live = a->peak = 0;
+        a->prev = &slp_memaccounts;
+        a->next = slp_memaccounts.next;
+        a->next->prev = a;
+        slp_memaccounts.next = a;
+        t->memaccount = a;
+    }
+    return a;
+}
+
+static void
+memaccount_charge(PySlpMemAccount *a, size_t size)
+{
+    a->live += size;
+    if (a->live > a->peak)
+        a->peak = a->live;
+}
+
+static void
+memaccount_credit(PySlpMemAccount *a, size_t size)
+{
+    a->live -= size;
+    if (a->live == 0 && a->task == NULL && a != &slp_memaccounts) {
+        a->prev->next = a->next;
+        a->next->prev = a->prev;
+        free(a);
+    }
+}
+
+void
+slp_memaccount_release(PyTaskletObject *task)
+{
+    PySlpMemAccount *a = task->memaccount;
+
+    if (a != NULL) {
+        task->memaccount = NULL;
+        a->task = NULL;
+        /* an empty credit drops the account if nothing is left */
+        memaccount_credit(a, 0);
+    }
+}
+
+/* The accounted blocks outside of the pools, by the address of their
+   data: open addressing with linear probing, at most 2/3 full. */
+
+#define MA_DUMMY ((void *) 1)
+
+static void **memaccount_table = NULL;
+static size_t memaccount_table_mask = 0;
+static size_t memaccount_table_fill = 0;       /* used or dummy slots */
+static size_t memaccount_table_used = 0;
+
+/* the slot of p in table, or the slot to put it */
+static void **
+memaccount_table_slot(void **table, size_t mask, void *p)
+{
+    size_t i = ((uptr) p >> ALIGNMENT_SHIFT) & mask;
+    void **freeslot = NULL;
+
+    for (;;) {
+        void *q = table[i];
+
+        if (q == p)
+            return &table[i];
+        if (q == NULL)
+            return freeslot != NULL ? freeslot : &table[i];
+        if (q == MA_DUMMY && freeslot == NULL)
+            freeslot = &table[i];
+        i = (i + 1) & mask;
+    }
+}
+
+/* make sure that one more address fits */
+static int
+memaccount_table_reserve(void)
+{
+    void **table;
+    size_t i, size = 64;
+
+    if (3 * (memaccount_table_fill + 1) < 2 * (memaccount_table_mask + 1))
+        return 0;
+    while (size <= 4 * memaccount_table_used)
+        size <<= 1;
+    table = (void **) calloc(size, sizeof(void *));
+    if (table == NULL)
+        return -1;
+    for (i = 0; memaccount_table != NULL && i <= memaccount_table_mask; i++) {
+        void *q = memaccount_table[i];
+
+        if (q != NULL && q != MA_DUMMY)
+            *memaccount_table_slot(table, size - 1, q) = q;
+    }
+    free(memaccount_table);
+    memaccount_table = table;
+    memaccount_table_mask = size - 1;
+    memaccount_table_fill = memaccount_table_used;
+    return 0;
+}
+
+/* only after memaccount_table_reserve() */
+static void
+memaccount_table_add(void *p)
+{
+    void **slot = memaccount_table_slot(memaccount_table,
+                                        memaccount_table_mask, p);
+
+    if (*slot == NULL)
+        memaccount_table_fill++;
+    *slot = p;
+    memaccount_table_used++;
+}
+
+/* remove p, return 0 if it was not there */
+static int
+memaccount_table_remove(void *p)
+{
+    void **slot;
+
+    if (memaccount_table == NULL)
+        return 0;
+    slot = memaccount_table_slot(memaccount_table, memaccount_table_mask, p);
+    if (*slot != p)
+        return 0;
+    *slot = MA_DUMMY;
+    memaccount_table_used--;
+    return 1;
+}
+
+/* In this mode, the blocks in the pools all have a header.  Test the
+   data, which is never empty, so that it is in the pool of its header
+   and no byte in front of a foreign pointer is read. */
+#define MA_IN_POOLS(p) Py_ADDRESS_IN_RANGE((p), POOL_ADDR(p))
+
+/* is p a block of memaccount_alloc()? */
+#define MA_OURS(p) (MA_IN_POOLS(p) || memaccount_table_has(p))
+
+static int
+memaccount_table_has(void *p)
+{
+    if (memaccount_table == NULL)
+        return 0;
+    return *memaccount_table_slot(memaccount_table,
+                                  memaccount_table_mask, p) == p;
+}
+
+static void *
+memaccount_alloc(PySlpMemAccount *a, size_t nbytes)
+{
+    memaccount_header *h;
+
+    if (nbytes > PY_SSIZE_T_MAX - MA_HEADER_SIZE)
+        return NULL;
+    if (memaccount_table_reserve())
+        return NULL;
+    h = (memaccount_header *) pymalloc_malloc(
+        (nbytes ? nbytes : 1) + MA_HEADER_SIZE);
+    if (h == NULL)
+        return NULL;
+    if (!MA_IN_POOLS(h + 1))
+        memaccount_table_add(h + 1);
+    h->account = a;
+    h->size = nbytes;
+    memaccount_charge(a, nbytes);
+    return h + 1;
+}
+
+static void
+memaccount_free(void *p)
+{
+    memaccount_header *h = MA_HEADER(p);
+
+    if (!MA_IN_POOLS(p))
+        memaccount_table_remove(p);
+    memaccount_credit(h->account, h->size);
+    pymalloc_free(h);
+}
+
+static void *
+memaccount_realloc(void *p, size_t nbytes)
+{
+    memaccount_header *h = MA_HEADER(p);
+    PySlpMemAccount *a = h->account;
+    size_t size = h->size;
+
+    if (nbytes > PY_SSIZE_T_MAX - MA_HEADER_SIZE)
+        return NULL;
+    if (MA_IN_POOLS(p)) {
+        /* like pymalloc_realloc: stay in the block, unless it shrinks
+           by more than a quarter */
+        size_t room = INDEX2SIZE(POOL_ADDR(p)->szidx) - MA_HEADER_SIZE;
+
+        if (nbytes <= room && 4 * nbytes > 3 * room) {
+            h->size = nbytes;
+            a->live -= size;
+            memaccount_charge(a, nbytes);
+            return p;
+        }
+        p = memaccount_alloc(a, nbytes);
+        if (p != NULL) {
+            memcpy(p, h + 1, nbytes < size ? nbytes : size);
+            memaccount_free(h + 1);
+        }
+        return p;
+    }
+    /* a block of malloc, which may resize it in place */
+    if (memaccount_table_reserve())
+        return NULL;
+    h = (memaccount_header *) realloc(h, nbytes + MA_HEADER_SIZE);
+    if (h == NULL)
+        return NULL;
+    if (h + 1 != p) {
+        memaccount_table_remove(p);
+        memaccount_table_add(h + 1);
+    }
+    h->size = nbytes;
+    a->live -= size;
+    memaccount_charge(a, nbytes);
+    return h + 1;
+}
+
+void *
+PyObject_Malloc(size_t nbytes)
+{
+    if (memaccount_mode && slp_memaccount_enabled())
+        return memaccount_alloc(memaccount_current(), nbytes);
+    return pymalloc_malloc(nbytes);
+}
+
+void
+PyObject_Free(void *p)
+{
+    if (memaccount_mode && slp_memaccount_enabled() && p != NULL &&
+        MA_OURS(p)) {
+        memaccount_free(p);
+        return;
+    }
+    pymalloc_free(p);
+}
+
+void *
+PyObject_Realloc(void *p, size_t nbytes)
+{
+    if (memaccount_mode && slp_memaccount_enabled()) {
+        if (p == NULL)
+            return memaccount_alloc(memaccount_current(), nbytes);
+        if (MA_OURS(p))
+            return memaccount_realloc(p, nbytes);
+    }
+    return pymalloc_realloc(p, nbytes);
+}
+
+#endif /* STACKLESS */
+
 #else   /* ! WITH_PYMALLOC */
 
 /*==========================================================================*/
@@ -1261,6 +1602,25 @@ PyObject_Free(void *p)
 {
     PyMem_FREE(p);
 }
+
+#ifdef STACKLESS
+/* tasklet memory accounting needs pymalloc */
+
+PySlpMemAccount slp_memaccounts = {
+    &slp_memaccounts, &slp_memaccounts, NULL, 0, 0
+};
+
+int
+slp_memaccount_enabled(void)
+{
+    return 0;
+}
+
+void
+slp_memaccount_release(PyTaskletObject *task)
+{
+}
+#endif
 #endif /* WITH_PYMALLOC */
 
 #ifdef PYMALLOC_DEBUG
@@ -1844,7 +1844,7 @@ subtype_dict(PyObject *obj, void *context)
     }
     dict = *dictptr;
     if (dict == NULL)
-        *dictptr = dict = PyDict_New();
+        *dictptr = dict = _PyDict_NewShared(Py_TYPE(obj));
     Py_XINCREF(dict);
     return dict;
 }
@@ -2645,6 +2645,7 @@ type_dealloc(PyTypeObject *type)
     PyObject_Free((char *)type->tp_doc);
     Py_XDECREF(et->ht_name);
     Py_XDECREF(et->ht_slots);
+    _PyDict_SharedKeysDecref(et->ht_cached_keys);
     Py_TYPE(type)->tp_free((PyObject *)type);
 }
 
@@ -5777,6 +5778,70 @@ slot_tp_init(PyObject *self, PyObject *args, PyObject *kwds)
     return 0;
 }
 
+/* Call a type with the arguments in C arrays.  Instances of classes
+   which only define __init__, as a Python function, are created and
+   initialised without building an argument tuple; other calls go
+   through the tp_call slot of the metatype. */
+PyObject *
+_PyType_FastCall(PyTypeObject *type, PyObject **args, Py_ssize_t nargs,
+                 PyObject **kws, Py_ssize_t nkws)
+{
+    static PyObject *init_str;
+    PyObject *obj, *init, *res, *argtuple, *kwdict = NULL;
+
+    if (init_str == NULL) {
+        init_str = PyString_InternFromString("__init__");
+        if (init_str == NULL)
+            return NULL;
+    }
+    if (Py_TYPE(type)->tp_call == (ternaryfunc)type_call &&
+        type->tp_new == object_new && type->tp_init == slot_tp_init &&
+        !(type->tp_flags & Py_TPFLAGS_IS_ABSTRACT) &&
+        (init = _PyType_Lookup(type, init_str)) != NULL &&
+        PyFunction_Check(init)) {
+        Py_INCREF(init);
+        obj = type->tp_alloc(type, 0);
+        if (obj == NULL) {
+            Py_DECREF(init);
+            return NULL;
+        }
+        res = _PyObject_FastCallPrepend(init, obj, args, nargs, kws, nkws);
+        Py_DECREF(init);
+        if (res != Py_None) {
+            if (res != NULL) {
+                PyErr_Format(PyExc_TypeError,
+                             "__init__() should return None, not '%.200s'",
+                             Py_TYPE(res)->tp_name);
+                Py_DECREF(res);
+            }
+            Py_DECREF(obj);
+            return NULL;
+        }
+        Py_DECREF(res);
+        return obj;
+    }
+
+    if (Py_TYPE(type)->tp_call == NULL) {
+        PyErr_Format(PyExc_TypeError, "'%.200s' object is not callable",
+                     Py_TYPE(type)->tp_name);
+        return NULL;
+    }
+    argtuple = _PyStack_AsTuple(args, nargs);
+    if (argtuple == NULL)
+        return NULL;
+    if (nkws > 0) {
+        kwdict = _PyStack_AsDict(kws, nkws, (PyObject *)type);
+        if (kwdict == NULL) {
+            Py_DECREF(argtuple);
+            return NULL;
+        }
+    }
+    res = (*Py_TYPE(type)->tp_call)((PyObject *)type, argtuple, kwdict);
+    Py_DECREF(argtuple);
+    Py_XDECREF(kwdict);
+    return res;
+}
+
 static PyObject *
 slot_tp_new(PyTypeObject *type, PyObject *args, PyObject *kwds)
 {
@@ -23,6 +23,10 @@
 int Py_DebugFlag;
 int Py_VerboseFlag;
 int Py_IgnoreEnvironmentFlag;
+#ifdef STACKLESS
+/* the tasklet memory accounting in obmalloc looks at the thread state */
+PyThreadState *_PyThreadState_Current = NULL;
+#endif
 
 /* Forward */
 grammar *getgrammar(char *filename);
@@ -160,15 +160,14 @@ static PyObject * special_lookup(PyObject *, char *, PyObject **);
     "free variable '%.200s' referenced before assignment" \
     " in enclosing scope"
 
-/* Dynamic execution profile */
-#ifdef DYNAMIC_EXECUTION_PROFILE
-#ifdef DXPAIRS
-static long dxpairs[257][256];
-#define dxp dxpairs[256]
-#else
+/* Dynamic execution profile, switched on by sys.setopcodeprofile().
+   While it is off, the only cost is the test of opcode_profiling in
+   FAST_DISPATCH().  The pair counts are by the previously executed
+   opcode, which belongs to the calling frame at the start of a call. */
+static int opcode_profiling = 0;
 static long dxp[256];
-#endif
-#endif
+static long (*dxpairs)[256] = NULL;     /* allocated when asked for */
+static int dxp_lastopcode = 0;
 
 /* Function call profile */
 #ifdef CALL_PROFILE
@@ -234,10 +233,28 @@ PyEval_GetCallStats(PyObject *self)
 #endif
 #include "pythread.h"
 
-static PyThread_type_lock interpreter_lock = 0; /* This is the GIL */
+static PyThread_type_gil interpreter_lock = 0; /* This is the GIL */
 static PyThread_type_lock pending_lock = 0; /* for pending calls */
 static long main_thread = 0;
 
+/* Set by a thread that waited for the GIL a whole switch interval; it
+   also zeroes _Py_Ticker, so the holder drops the GIL at its next
+   instruction. */
+static volatile int gil_drop_request = 0;
+static long switch_interval = 5000; /* microseconds */
+
+void
+_PyEval_SetSwitchInterval(long microseconds)
+{
+    switch_interval = microseconds;
+}
+
+long
+_PyEval_GetSwitchInterval(void)
+{
+    return switch_interval;
+}
+
 int
 PyEval_ThreadsInitialized(void)
 {
@@ -249,21 +266,21 @@ PyEval_InitThreads(void)
 {
     if (interpreter_lock)
         return;
-    interpreter_lock = PyThread_allocate_lock();
-    PyThread_acquire_lock(interpreter_lock, 1);
+    interpreter_lock = PyThread_allocate_gil(&gil_drop_request, &_Py_Ticker);
+    PyThread_take_gil(interpreter_lock, switch_interval);
     main_thread = PyThread_get_thread_ident();
 }
 
 void
 PyEval_AcquireLock(void)
 {
-    PyThread_acquire_lock(interpreter_lock, 1);
+    PyThread_take_gil(interpreter_lock, switch_interval);
 }
 
 void
 PyEval_ReleaseLock(void)
 {
-    PyThread_release_lock(interpreter_lock);
+    PyThread_drop_gil(interpreter_lock, 0);
 }
 
 void
@@ -273,7 +290,7 @@ PyEval_AcquireThread(PyThreadState *tstate)
         Py_FatalError("PyEval_AcquireThread: NULL new thread state");
     /* Check someone has called PyEval_InitThreads() to create the lock */
     assert(interpreter_lock);
-    PyThread_acquire_lock(interpreter_lock, 1);
+    PyThread_take_gil(interpreter_lock, switch_interval);
     if (PyThreadState_Swap(tstate) != NULL)
         Py_FatalError(
             "PyEval_AcquireThread: non-NULL old thread state");
@@ -286,7 +303,7 @@ PyEval_ReleaseThread(PyThreadState *tstate)
         Py_FatalError("PyEval_ReleaseThread: NULL thread state");
     if (PyThreadState_Swap(NULL) != tstate)
         Py_FatalError("PyEval_ReleaseThread: wrong thread state");
-    PyThread_release_lock(interpreter_lock);
+    PyThread_drop_gil(interpreter_lock, 0);
 }
 
 /* This function is called from PyOS_AfterFork to ensure that newly
@@ -306,10 +323,14 @@ PyEval_ReInitThreads(void)
       much error-checking.  Doing this cleanly would require
       adding a new function to each thread_*.h.  Instead, just
       create a new lock and waste a little bit of memory */
-    interpreter_lock = PyThread_allocate_lock();
+    gil_drop_request = 0;
+    interpreter_lock = PyThread_allocate_gil(&gil_drop_request, &_Py_Ticker);
     pending_lock = PyThread_allocate_lock();
-    PyThread_acquire_lock(interpreter_lock, 1);
+    PyThread_take_gil(interpreter_lock, switch_interval);
     main_thread = PyThread_get_thread_ident();
+#ifdef STACKLESS
+    slp_pool_after_fork();
+#endif
 
     /* Update the threading module with the new state.
      */
@@ -342,7 +363,7 @@ PyEval_SaveThread(void)
         Py_FatalError("PyEval_SaveThread: NULL tstate");
 #ifdef WITH_THREAD
     if (interpreter_lock)
-        PyThread_release_lock(interpreter_lock);
+        PyThread_drop_gil(interpreter_lock, 0);
 #endif
     return tstate;
 }
@@ -355,7 +376,7 @@ PyEval_RestoreThread(PyThreadState *tstate)
 #ifdef WITH_THREAD
     if (interpreter_lock) {
         int err = errno;
-        PyThread_acquire_lock(interpreter_lock, 1);
+        PyThread_take_gil(interpreter_lock, switch_interval);
         errno = err;
     }
 #endif
@@ -657,11 +678,31 @@ static int unpack_iterable(PyObject *, int, PyObject **);
    fast_next_opcode*/
 static int _Py_TracingPossible = 0;
 
-/* for manipulating the thread switch and periodic "stuff" - used to be
-   per thread, now just a pair o' globals */
+/* for manipulating the periodic "stuff" - used to be per thread, now
+   just a pair o' globals.  Thread switches are requested by the waiting
+   thread instead, see gil_drop_request. */
 int _Py_CheckInterval = 100;
 volatile int _Py_Ticker = 0; /* so that we hit a "tick" first thing */
 
+/* Executions in a row asking for the same specialized form, after which
+   an instruction of quickened code is rewritten to it */
+#define QUICKEN_STABLE 8
+
+/* Count an execution of the generic instruction at offset in quickened
+   code, whose operands ask for the specialized form kind, 0 for none. */
+static void
+quicken_instr(PyQuickenedCode *quick, int offset, int kind)
+{
+    if (kind != quick->qc_kinds[offset]) {
+        quick->qc_kinds[offset] = kind;
+        quick->qc_hits[offset] = 0;
+    }
+    else if (kind != 0 && ++quick->qc_hits[offset] >= QUICKEN_STABLE) {
+        quick->qc_code[offset] = kind;
+        quick->qc_hits[offset] = 0;
+    }
+}
+
 PyObject *
 PyEval_EvalCode(PyCodeObject *co, PyObject *globals, PyObject *locals)
 {
@@ -706,9 +747,6 @@ PyEval_EvalFrame(PyFrameObject *f) {
 PyObject *
 PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
 {
-#ifdef DXPAIRS
-    int lastopcode = 0;
-#endif
     register PyObject **stack_pointer;  /* Next free slot in value stack */
     register unsigned char *next_instr;
     register int opcode;        /* Current opcode */
@@ -736,6 +774,7 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
     int instr_ub = -1, instr_lb = 0, instr_prev = -1;
 
     unsigned char *first_instr;
+    PyQuickenedCode *quick;     /* NULL unless running quickened code */
     PyObject *names;
     PyObject *consts;
 #if defined(Py_DEBUG) || defined(LLTRACE)
@@ -794,6 +833,105 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
     opcode = 0;
 #endif
 
+/* Computed GOTOs, or
+       the-optimization-commonly-but-improperly-known-as-"threaded code"
+   using gcc's labels-as-values extension
+   (http://gcc.gnu.org/onlinedocs/gcc/Labels-as-Values.html).
+
+   The traditional bytecode evaluation loop uses a "switch" statement, which
+   decent compilers will optimize as a single indirect branch instruction
+   combined with a lookup table of jump addresses. However, since the
+   indirect jump instruction is shared by all opcodes, the CPU will have a
+   hard time making the right prediction for where to jump next (actually,
+   it will be always wrong except in the uncommon case of a sequence of
+   several identical opcodes).
+
+   "Threaded code" in contrast, uses an explicit jump table and an explicit
+   indirect jump instruction at the end of each opcode. Since the jump
+   instruction is at a different address for each opcode, the CPU will make a
+   separate prediction for each of these instructions, which is equivalent to
+   predicting the second opcode of each opcode pair. These predictions have
+   a much better chance to turn out valid, especially in small bytecode loops.
+
+   A mispredicted branch on a modern CPU flushes the whole pipeline and
+   can cost several CPU cycles (depending on the pipeline depth),
+   and potentially many more instructions (depending on the pipeline width).
+   A correctly predicted branch, however, is nearly free.
+
+   The PREDICT() macros are turned off in this mode, because every opcode
+   already ends with its own indirect jump.
+
+   Frames which are resumed by Stackless enter the loop at its top, as
+   with the switch, so only the dispatch between opcodes is threaded.
+*/
+
+#ifdef HAVE_COMPUTED_GOTOS
+    #ifndef USE_COMPUTED_GOTOS
+    #define USE_COMPUTED_GOTOS 1
+    #endif
+#else
+    #if defined(USE_COMPUTED_GOTOS) && USE_COMPUTED_GOTOS
+    #error "Computed gotos are not supported on this compiler."
+    #endif
+    #undef USE_COMPUTED_GOTOS
+    #define USE_COMPUTED_GOTOS 0
+#endif
+
+#if USE_COMPUTED_GOTOS
+#define TARGET(op) \
+    TARGET_##op: \
+    opcode = op; \
+    if (HAS_ARG(op)) \
+        oparg = NEXTARG(); \
+    case op:
+
+/* for opcodes like SLICE+1, whose label is TARGET_SLICE_1 */
+#define TARGET_WITH_NAME(name, op) \
+    TARGET_##name: \
+    opcode = op; \
+    if (HAS_ARG(op)) \
+        oparg = NEXTARG(); \
+    case op:
+
+/* the ticker is checked at the top of the loop, as before */
+#define DISPATCH() \
+    { \
+        if (_Py_Ticker > 0) { \
+            _Py_Ticker--; \
+            FAST_DISPATCH(); \
+        } \
+        continue; \
+    }
+
+#ifdef LLTRACE
+#define FAST_DISPATCH() \
+    { \
+        if (!lltrace && !(_Py_TracingPossible | opcode_profiling)) { \
+            f->f_lasti = INSTR_OFFSET(); \
+            goto *opcode_targets[*next_instr++]; \
+        } \
+        goto fast_next_opcode; \
+    }
+#else
+#define FAST_DISPATCH() \
+    { \
+        if (!(_Py_TracingPossible | opcode_profiling)) { \
+            f->f_lasti = INSTR_OFFSET(); \
+            goto *opcode_targets[*next_instr++]; \
+        } \
+        goto fast_next_opcode; \
+    }
+#endif
+
+#else
+#define TARGET(op) \
+    case op:
+#define TARGET_WITH_NAME(name, op) \
+    case op:
+#define DISPATCH() continue
+#define FAST_DISPATCH() goto fast_next_opcode
+#endif
+
 /* Code access macros */
 
 #define INSTR_OFFSET()  ((int)(next_instr - first_instr))
@@ -803,6 +941,14 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
 #define JUMPTO(x)       (next_instr = first_instr + (x))
 #define JUMPBY(x)       (next_instr += (x))
 
+/* The cache of the current LOAD_ATTR, STORE_ATTR or LOAD_METHOD, whose
+   argument has just been fetched */
+#define ATTR_SITE()     (co->co_attrcache != NULL ? \
+                         co->co_attrcache->at_index[INSTR_OFFSET() - 3] : 0)
+#define ATTR_CACHE()    (ATTR_SITE() != 0 ? \
+                         &co->co_attrcache->at_sites[ATTR_SITE() - 1] : \
+                         _PyCode_GetAttrCache(co, INSTR_OFFSET() - 3))
+
 /* OpCode prediction macros
     Some opcodes tend to come in pairs thus making it possible to
     predict the second code when the first is run.  For example,
@@ -819,21 +965,75 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
     a successful PREDICT has the effect of making the two opcodes run as if
     they were a single new opcode with the bodies combined.
 
-    If collecting opcode statistics, your choices are to either keep the
-    predictions turned-on and interpret the results as if some opcodes
-    had been combined or turn-off predictions so that the opcode frequency
-    counter updates for both opcodes.
+    Predictions are not taken while opcode statistics are collected,
+    so that the opcode frequency counter updates for both opcodes.
 */
 
-#ifdef DYNAMIC_EXECUTION_PROFILE
+#if USE_COMPUTED_GOTOS
 #define PREDICT(op)             if (0) goto PRED_##op
 #else
-#define PREDICT(op)             if (*next_instr == op) goto PRED_##op
+#define PREDICT(op) \
+    if (*next_instr == op && !opcode_profiling) goto PRED_##op
 #endif
 
 #define PREDICTED(op)           PRED_##op: next_instr++
 #define PREDICTED_WITH_ARG(op)  PRED_##op: oparg = PEEKARG(); next_instr += 3
 
+/* Superinstructions
+    The peephole optimizer replaces the first instruction of some common
+    pairs by a superinstruction, which does the work of the first one and
+    goes on with the body of the second one, saving a dispatch.  The
+    second instruction stays in place behind it, so the addresses in the
+    code don't change and jumps to the second instruction still work.
+    Unlike with PREDICT(), f->f_lasti is updated in between, so errors,
+    tracebacks and pickled frames see the instruction that runs.
+*/
+
+/* Quickening
+    When a code object has been called or has looped often enough, its
+    frames go on in a copy of its code (see _PyCode_Quicken()).  There,
+    the generic BINARY_ADD, BINARY_SUBSCR and COMPARE_OP count which
+    specialized form their operands ask for, and an instruction which
+    asks for the same one QUICKEN_STABLE times in a row is rewritten to
+    it.  A specialized instruction meeting other types writes back the
+    instruction from co_code and runs that.  Offsets are the same in
+    both copies, so f->f_lasti, tracing and pickled frames, which all
+    refer to co_code, are not affected.
+*/
+
+#define QUICKEN(offset, kind) \
+    if (quick != NULL) quicken_instr(quick, (offset), (kind))
+#define DEOPTIMIZE(offset) \
+    { \
+        quick->qc_code[offset] = \
+            ((unsigned char *)PyString_AS_STRING(co->co_code))[offset]; \
+        quick->qc_hits[offset] = 0; \
+    }
+
+#define BINARY_ADD_KIND(v, w) \
+    (PyInt_CheckExact(v) && PyInt_CheckExact(w) ? BINARY_ADD_INT : \
+     PyFloat_CheckExact(v) && PyFloat_CheckExact(w) ? BINARY_ADD_FLOAT : 0)
+#define BINARY_SUBSCR_KIND(v, w) \
+    (PyList_CheckExact(v) && PyInt_CheckExact(w) ? BINARY_SUBSCR_LIST_INT : \
+     PyDict_CheckExact(v) && PyString_CheckExact(w) ? \
+     BINARY_SUBSCR_DICT_STR : 0)
+#define COMPARE_OP_KIND(v, w, oparg) \
+    (PyFloat_CheckExact(v) && PyFloat_CheckExact(w) && oparg <= PyCmp_GE ? \
+     COMPARE_OP_FLOAT : \
+     PyString_CheckExact(v) && PyString_CheckExact(w) && \
+     (oparg == PyCmp_EQ || oparg == PyCmp_NE) ? COMPARE_OP_STR : 0)
+
+#define SUPER_TARGET(op)        SUPER_##op:
+#define SUPER_NEXT(op) \
+    { \
+        f->f_lasti = INSTR_OFFSET(); \
+        opcode = op; \
+        next_instr++; \
+        if (HAS_ARG(op)) \
+            oparg = NEXTARG(); \
+        goto SUPER_##op; \
+    }
+
 #ifdef STACKLESS
 #ifdef STACKLESS_USE_ENDIAN
 
@@ -922,6 +1122,12 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
 #endif /* STACKLESS */
 
     tstate->frame = f;
+    if (f->f_lasti == -1) {
+        /* a call, not a generator resuming */
+        f->f_code->co_execcount++;
+        if (f->f_code->co_warmup > 0 && --f->f_code->co_warmup == 0)
+            _PyCode_Quicken(f->f_code);
+    }
 
     if (tstate->use_tracing) {
         if (tstate->c_tracefunc != NULL) {
@@ -1006,9 +1212,6 @@ PyObject *
 PyEval_EvalFrame_value(PyFrameObject *f, int throwflag, PyObject *retval)
 {
     /* unfortunately we repeat all the variables here... */
-#ifdef DXPAIRS
-    int lastopcode = 0;
-#endif
     register PyObject **stack_pointer;   /* Next free slot in value stack */
     register unsigned char *next_instr;
     register int opcode;        /* Current opcode */
@@ -1035,6 +1238,7 @@ PyEval_EvalFrame_value(PyFrameObject *f, int throwflag, PyObject *retval)
     int instr_ub = -1, instr_lb = 0, instr_prev = -1;
 
     unsigned char *first_instr;
+    PyQuickenedCode *quick;     /* NULL unless running quickened code */
     PyObject *names;
     PyObject *consts;
 #if defined(Py_DEBUG) || defined(LLTRACE)
@@ -1044,12 +1248,20 @@ PyEval_EvalFrame_value(PyFrameObject *f, int throwflag, PyObject *retval)
 
 #endif /* STACKLESS */
 
+#if USE_COMPUTED_GOTOS
+/* Import the static jump table */
+#include "opcode_targets.h"
+#endif
+
     co = f->f_code;
     names = co->co_names;
     consts = co->co_consts;
     fastlocals = f->f_localsplus;
     freevars = f->f_localsplus + co->co_nlocals;
     first_instr = (unsigned char*) PyString_AS_STRING(co->co_code);
+    quick = co->co_quickened;
+    if (quick != NULL)
+        first_instr = quick->qc_code;
     /* An explanation is in order for the next line.
 
        f->f_lasti now refers to the index of the last instruction
@@ -1217,29 +1429,30 @@ PyEval_EvalFrame_value(PyFrameObject *f, int throwflag, PyObject *retval)
                     _Py_Ticker = 0;
             }
 #ifdef WITH_THREAD
-            if (interpreter_lock) {
-                /* Give another thread a chance */
+            if (interpreter_lock && gil_drop_request) {
+                /* Another thread waited a whole switch interval;
+                   give it the GIL and wait until it took it */
 
                 if (PyThreadState_Swap(NULL) != tstate)
                     Py_FatalError("ceval: tstate mix-up");
-                PyThread_release_lock(interpreter_lock);
+                PyThread_drop_gil(interpreter_lock, 1);
 
                 /* Other threads may run now */
 
-                PyThread_acquire_lock(interpreter_lock, 1);
+                PyThread_take_gil(interpreter_lock, switch_interval);
                 if (PyThreadState_Swap(tstate) != NULL)
                     Py_FatalError("ceval: orphan tstate");
+            }
 
-                /* Check for thread interrupts */
+            /* Check for thread interrupts */
 
-                if (tstate->async_exc != NULL) {
-                    x = tstate->async_exc;
-                    tstate->async_exc = NULL;
-                    PyErr_SetNone(x);
-                    Py_DECREF(x);
-                    why = WHY_EXCEPTION;
-                    goto on_error;
-                }
+            if (tstate->async_exc != NULL) {
+                x = tstate->async_exc;
+                tstate->async_exc = NULL;
+                PyErr_SetNone(x);
+                Py_DECREF(x);
+                why = WHY_EXCEPTION;
+                goto on_error;
             }
 #endif
         }
@@ -1279,13 +1492,12 @@ PyEval_EvalFrame_value(PyFrameObject *f, int throwflag, PyObject *retval)
         if (HAS_ARG(opcode))
             oparg = NEXTARG();
     dispatch_opcode:
-#ifdef DYNAMIC_EXECUTION_PROFILE
-#ifdef DXPAIRS
-        dxpairs[lastopcode][opcode]++;
-        lastopcode = opcode;
-#endif
-        dxp[opcode]++;
-#endif
+        if (opcode_profiling) {
+            dxp[opcode]++;
+            if (dxpairs != NULL)
+                dxpairs[dxp_lastopcode][opcode]++;
+            dxp_lastopcode = opcode;
+        }
 
 #ifdef LLTRACE
         /* Instruction tracing */
@@ -1314,55 +1526,100 @@ PyEval_EvalFrame_value(PyFrameObject *f, int throwflag, PyObject *retval)
 
         /* case STOP_CODE: this is an error! */
 
-        case NOP:
-            goto fast_next_opcode;
+        TARGET(NOP)
+            FAST_DISPATCH();
 
-        case LOAD_FAST:
+        TARGET(LOAD_FAST)
+        SUPER_TARGET(LOAD_FAST)
             x = GETLOCAL(oparg);
             if (x != NULL) {
                 Py_INCREF(x);
                 PUSH(x);
-                goto fast_next_opcode;
+                FAST_DISPATCH();
             }
             format_exc_check_arg(PyExc_UnboundLocalError,
                 UNBOUNDLOCAL_ERROR_MSG,
                 PyTuple_GetItem(co->co_varnames, oparg));
             break;
 
-        case LOAD_CONST:
+        TARGET(LOAD_CONST)
+        SUPER_TARGET(LOAD_CONST)
             x = GETITEM(consts, oparg);
             Py_INCREF(x);
             PUSH(x);
-            goto fast_next_opcode;
+            FAST_DISPATCH();
 
         PREDICTED_WITH_ARG(STORE_FAST);
-        case STORE_FAST:
+        TARGET(STORE_FAST)
+            v = POP();
+            SETLOCAL(oparg, v);
+            FAST_DISPATCH();
+
+        TARGET(LOAD_FAST_LOAD_FAST)
+            x = GETLOCAL(oparg);
+            if (x == NULL)
+                goto SUPER_LOAD_FAST;   /* for the error */
+            Py_INCREF(x);
+            PUSH(x);
+            SUPER_NEXT(LOAD_FAST);
+
+        TARGET(LOAD_FAST_LOAD_CONST)
+            x = GETLOCAL(oparg);
+            if (x == NULL)
+                goto SUPER_LOAD_FAST;   /* for the error */
+            Py_INCREF(x);
+            PUSH(x);
+            SUPER_NEXT(LOAD_CONST);
+
+        TARGET(LOAD_FAST_LOAD_ATTR)
+            x = GETLOCAL(oparg);
+            if (x == NULL)
+                goto SUPER_LOAD_FAST;   /* for the error */
+            Py_INCREF(x);
+            PUSH(x);
+            SUPER_NEXT(LOAD_ATTR);
+
+        TARGET(LOAD_FAST_LOAD_METHOD)
+            x = GETLOCAL(oparg);
+            if (x == NULL)
+                goto SUPER_LOAD_FAST;   /* for the error */
+            Py_INCREF(x);
+            PUSH(x);
+            SUPER_NEXT(LOAD_METHOD);
+
+        TARGET(STORE_FAST_LOAD_FAST)
             v = POP();
             SETLOCAL(oparg, v);
-            goto fast_next_opcode;
+            SUPER_NEXT(LOAD_FAST);
 
-        case POP_TOP:
+        TARGET(LOAD_CONST_RETURN_VALUE)
+            x = GETITEM(consts, oparg);
+            Py_INCREF(x);
+            PUSH(x);
+            SUPER_NEXT(RETURN_VALUE);
+
+        TARGET(POP_TOP)
             v = POP();
             Py_DECREF(v);
-            goto fast_next_opcode;
+            FAST_DISPATCH();
 
-        case ROT_TWO:
+        TARGET(ROT_TWO)
             v = TOP();
             w = SECOND();
             SET_TOP(w);
             SET_SECOND(v);
-            goto fast_next_opcode;
+            FAST_DISPATCH();
 
-        case ROT_THREE:
+        TARGET(ROT_THREE)
             v = TOP();
             w = SECOND();
             x = THIRD();
             SET_TOP(w);
             SET_SECOND(x);
             SET_THIRD(v);
-            goto fast_next_opcode;
+            FAST_DISPATCH();
 
-        case ROT_FOUR:
+        TARGET(ROT_FOUR)
             u = TOP();
             v = SECOND();
             w = THIRD();
@@ -1371,15 +1628,15 @@ PyEval_EvalFrame_value(PyFrameObject *f, int throwflag, PyObject *retval)
             SET_SECOND(w);
             SET_THIRD(x);
             SET_FOURTH(u);
-            goto fast_next_opcode;
+            FAST_DISPATCH();
 
-        case DUP_TOP:
+        TARGET(DUP_TOP)
             v = TOP();
             Py_INCREF(v);
             PUSH(v);
-            goto fast_next_opcode;
+            FAST_DISPATCH();
 
-        case DUP_TOPX:
+        TARGET(DUP_TOPX)
             if (oparg == 2) {
                 x = TOP();
                 Py_INCREF(x);
@@ -1388,7 +1645,7 @@ PyEval_EvalFrame_value(PyFrameObject *f, int throwflag, PyObject *retval)
                 STACKADJ(2);
                 SET_TOP(x);
                 SET_SECOND(w);
-                goto fast_next_opcode;
+                FAST_DISPATCH();
             } else if (oparg == 3) {
                 x = TOP();
                 Py_INCREF(x);
@@ -1400,84 +1657,84 @@ PyEval_EvalFrame_value(PyFrameObject *f, int throwflag, PyObject *retval)
                 SET_TOP(x);
                 SET_SECOND(w);
                 SET_THIRD(v);
-                goto fast_next_opcode;
+                FAST_DISPATCH();
             }
             Py_FatalError("invalid argument to DUP_TOPX"
                           " (bytecode corruption?)");
             /* Never returns, so don't bother to set why. */
             break;
 
-        case UNARY_POSITIVE:
+        TARGET(UNARY_POSITIVE)
             v = TOP();
             x = PyNumber_Positive(v);
             Py_DECREF(v);
             SET_TOP(x);
-            if (x != NULL) continue;
+            if (x != NULL) DISPATCH();
             break;
 
-        case UNARY_NEGATIVE:
+        TARGET(UNARY_NEGATIVE)
             v = TOP();
             x = PyNumber_Negative(v);
             Py_DECREF(v);
             SET_TOP(x);
-            if (x != NULL) continue;
+            if (x != NULL) DISPATCH();
             break;
 
-        case UNARY_NOT:
+        TARGET(UNARY_NOT)
             v = TOP();
             err = PyObject_IsTrue(v);
             Py_DECREF(v);
             if (err == 0) {
                 Py_INCREF(Py_True);
                 SET_TOP(Py_True);
-                continue;
+                DISPATCH();
             }
             else if (err > 0) {
                 Py_INCREF(Py_False);
                 SET_TOP(Py_False);
                 err = 0;
-                continue;
+                DISPATCH();
             }
             STACKADJ(-1);
             break;
 
-        case UNARY_CONVERT:
+        TARGET(UNARY_CONVERT)
             v = TOP();
             x = PyObject_Repr(v);
             Py_DECREF(v);
             SET_TOP(x);
-            if (x != NULL) continue;
+            if (x != NULL) DISPATCH();
             break;
 
-        case UNARY_INVERT:
+        TARGET(UNARY_INVERT)
             v = TOP();
             x = PyNumber_Invert(v);
             Py_DECREF(v);
             SET_TOP(x);
-            if (x != NULL) continue;
+            if (x != NULL) DISPATCH();
             break;
 
-        case BINARY_POWER:
+        TARGET(BINARY_POWER)
             w = POP();
             v = TOP();
             x = PyNumber_Power(v, w, Py_None);
             Py_DECREF(v);
             Py_DECREF(w);
             SET_TOP(x);
-            if (x != NULL) continue;
+            if (x != NULL) DISPATCH();
             break;
 
-        case BINARY_MULTIPLY:
+        TARGET(BINARY_MULTIPLY)
             w = POP();
             v = TOP();
             x = PyNumber_Multiply(v, w);
             Py_DECREF(v);
             Py_DECREF(w);
             SET_TOP(x);
-            if (x != NULL) continue;
+            if (x != NULL) DISPATCH();
             break;
 
-        case BINARY_DIVIDE:
+        TARGET(BINARY_DIVIDE)
             if (!_Py_QnewFlag) {
                 w = POP();
                 v = TOP();
@@ -1485,32 +1742,32 @@ PyEval_EvalFrame_value(PyFrameObject *f, int throwflag, PyObject *retval)
                 Py_DECREF(v);
                 Py_DECREF(w);
                 SET_TOP(x);
-                if (x != NULL) continue;
+                if (x != NULL) DISPATCH();
                 break;
             }
             /* -Qnew is in effect:  fall through to
                BINARY_TRUE_DIVIDE */
-        case BINARY_TRUE_DIVIDE:
+        TARGET(BINARY_TRUE_DIVIDE)
             w = POP();
             v = TOP();
             x = PyNumber_TrueDivide(v, w);
             Py_DECREF(v);
             Py_DECREF(w);
             SET_TOP(x);
-            if (x != NULL) continue;
+            if (x != NULL) DISPATCH();
             break;
 
-        case BINARY_FLOOR_DIVIDE:
+        TARGET(BINARY_FLOOR_DIVIDE)
             w = POP();
             v = TOP();
             x = PyNumber_FloorDivide(v, w);
             Py_DECREF(v);
             Py_DECREF(w);
             SET_TOP(x);
-            if (x != NULL) continue;
+            if (x != NULL) DISPATCH();
             break;
 
-        case BINARY_MODULO:
+        TARGET(BINARY_MODULO)
             w = POP();
             v = TOP();
             if (PyString_CheckExact(v))
@@ -1520,12 +1777,14 @@ PyEval_EvalFrame_value(PyFrameObject *f, int throwflag, PyObject *retval)
             Py_DECREF(v);
             Py_DECREF(w);
             SET_TOP(x);
-            if (x != NULL) continue;
+            if (x != NULL) DISPATCH();
             break;
 
-        case BINARY_ADD:
+        TARGET(BINARY_ADD)
+        binary_add:
             w = POP();
             v = TOP();
+            QUICKEN(INSTR_OFFSET() - 1, BINARY_ADD_KIND(v, w));
             if (PyInt_CheckExact(v) && PyInt_CheckExact(w)) {
                 /* INLINE: int + int */
                 register long a, b, i;
@@ -1552,10 +1811,49 @@ PyEval_EvalFrame_value(PyFrameObject *f, int throwflag, PyObject *retval)
           skip_decref_vx:
             Py_DECREF(w);
             SET_TOP(x);
-            if (x != NULL) continue;
+            if (x != NULL) DISPATCH();
             break;
 
-        case BINARY_SUBTRACT:
+        TARGET(BINARY_ADD_INT)
+            w = TOP();
+            v = SECOND();
+            if (!PyInt_CheckExact(v) || !PyInt_CheckExact(w)) {
+                DEOPTIMIZE(INSTR_OFFSET() - 1);
+                goto binary_add;
+            }
+            {
+                register long a, b, i;
+                a = PyInt_AS_LONG(v);
+                b = PyInt_AS_LONG(w);
+                i = (long)((unsigned long)a + b);
+                if ((i^a) < 0 && (i^b) < 0)
+                    goto binary_add;
+                x = PyInt_FromLong(i);
+            }
+            STACKADJ(-1);
+            Py_DECREF(v);
+            Py_DECREF(w);
+            SET_TOP(x);
+            if (x != NULL) DISPATCH();
+            break;
+
+        TARGET(BINARY_ADD_FLOAT)
+            w = TOP();
+            v = SECOND();
+            if (!PyFloat_CheckExact(v) || !PyFloat_CheckExact(w)) {
+                DEOPTIMIZE(INSTR_OFFSET() - 1);
+                goto binary_add;
+            }
+            x = PyFloat_FromDouble(PyFloat_AS_DOUBLE(v) +
+                                   PyFloat_AS_DOUBLE(w));
+            STACKADJ(-1);
+            Py_DECREF(v);
+            Py_DECREF(w);
+            SET_TOP(x);
+            if (x != NULL) DISPATCH();
+            break;
+
+        TARGET(BINARY_SUBTRACT)
             w = POP();
             v = TOP();
             if (PyInt_CheckExact(v) && PyInt_CheckExact(w)) {
@@ -1577,12 +1875,14 @@ PyEval_EvalFrame_value(PyFrameObject *f, int throwflag, PyObject *retval)
             Py_DECREF(v);
             Py_DECREF(w);
             SET_TOP(x);
-            if (x != NULL) continue;
+            if (x != NULL) DISPATCH();
             break;
 
-        case BINARY_SUBSCR:
+        TARGET(BINARY_SUBSCR)
+        binary_subscr:
             w = POP();
             v = TOP();
+            QUICKEN(INSTR_OFFSET() - 1, BINARY_SUBSCR_KIND(v, w));
             if (PyList_CheckExact(v) && PyInt_CheckExact(w)) {
                 /* INLINE: list[int] */
                 Py_ssize_t i = PyInt_AsSsize_t(w);
@@ -1601,102 +1901,141 @@ PyEval_EvalFrame_value(PyFrameObject *f, int throwflag, PyObject *retval)
             Py_DECREF(v);
             Py_DECREF(w);
             SET_TOP(x);
-            if (x != NULL) continue;
+            if (x != NULL) DISPATCH();
             break;
 
-        case BINARY_LSHIFT:
+        TARGET(BINARY_SUBSCR_LIST_INT)
+            w = TOP();
+            v = SECOND();
+            if (!PyList_CheckExact(v) || !PyInt_CheckExact(w)) {
+                DEOPTIMIZE(INSTR_OFFSET() - 1);
+                goto binary_subscr;
+            }
+            {
+                Py_ssize_t i = PyInt_AsSsize_t(w);
+                if (i < 0)
+                    i += PyList_GET_SIZE(v);
+                if (i < 0 || i >= PyList_GET_SIZE(v))
+                    goto binary_subscr;
+                x = PyList_GET_ITEM(v, i);
+                Py_INCREF(x);
+            }
+            STACKADJ(-1);
+            Py_DECREF(v);
+            Py_DECREF(w);
+            SET_TOP(x);
+            DISPATCH();
+
+        TARGET(BINARY_SUBSCR_DICT_STR)
+            w = TOP();
+            v = SECOND();
+            if (!PyDict_CheckExact(v) || !PyString_CheckExact(w)) {
+                DEOPTIMIZE(INSTR_OFFSET() - 1);
+                goto binary_subscr;
+            }
+            x = PyDict_GetItem(v, w);
+            if (x == NULL)
+                goto binary_subscr;     /* for the KeyError */
+            Py_INCREF(x);
+            STACKADJ(-1);
+            Py_DECREF(v);
+            Py_DECREF(w);
+            SET_TOP(x);
+            DISPATCH();
+
+        TARGET(BINARY_LSHIFT)
             w = POP();
             v = TOP();
             x = PyNumber_Lshift(v, w);
             Py_DECREF(v);
             Py_DECREF(w);
             SET_TOP(x);
-            if (x != NULL) continue;
+            if (x != NULL) DISPATCH();
             break;
 
-        case BINARY_RSHIFT:
+        TARGET(BINARY_RSHIFT)
             w = POP();
             v = TOP();
             x = PyNumber_Rshift(v, w);
             Py_DECREF(v);
             Py_DECREF(w);
             SET_TOP(x);
-            if (x != NULL) continue;
+            if (x != NULL) DISPATCH();
             break;
 
-        case BINARY_AND:
+        TARGET(BINARY_AND)
             w = POP();
             v = TOP();
             x = PyNumber_And(v, w);
             Py_DECREF(v);
             Py_DECREF(w);
             SET_TOP(x);
-            if (x != NULL) continue;
+            if (x != NULL) DISPATCH();
             break;
 
-        case BINARY_XOR:
+        TARGET(BINARY_XOR)
             w = POP();
             v = TOP();
             x = PyNumber_Xor(v, w);
             Py_DECREF(v);
             Py_DECREF(w);
             SET_TOP(x);
-            if (x != NULL) continue;
+            if (x != NULL) DISPATCH();
             break;
 
-        case BINARY_OR:
+        TARGET(BINARY_OR)
             w = POP();
             v = TOP();
             x = PyNumber_Or(v, w);
             Py_DECREF(v);
             Py_DECREF(w);
             SET_TOP(x);
-            if (x != NULL) continue;
+            if (x != NULL) DISPATCH();
             break;
 
-        case LIST_APPEND:
+        TARGET(LIST_APPEND)
             w = POP();
             v = PEEK(oparg);
             err = PyList_Append(v, w);
             Py_DECREF(w);
             if (err == 0) {
                 PREDICT(JUMP_ABSOLUTE);
-                continue;
+                DISPATCH();
             }
             break;
 
-        case SET_ADD:
+        TARGET(SET_ADD)
             w = POP();
             v = stack_pointer[-oparg];
             err = PySet_Add(v, w);
             Py_DECREF(w);
             if (err == 0) {
                 PREDICT(JUMP_ABSOLUTE);
-                continue;
+                DISPATCH();
             }
             break;
 
-        case INPLACE_POWER:
+        TARGET(INPLACE_POWER)
             w = POP();
             v = TOP();
             x = PyNumber_InPlacePower(v, w, Py_None);
             Py_DECREF(v);
             Py_DECREF(w);
             SET_TOP(x);
-            if (x != NULL) continue;
+            if (x != NULL) DISPATCH();
             break;
 
-        case INPLACE_MULTIPLY:
+        TARGET(INPLACE_MULTIPLY)
             w = POP();
             v = TOP();
             x = PyNumber_InPlaceMultiply(v, w);
             Py_DECREF(v);
             Py_DECREF(w);
             SET_TOP(x);
-            if (x != NULL) continue;
+            if (x != NULL) DISPATCH();
             break;
 
-        case INPLACE_DIVIDE:
+        TARGET(INPLACE_DIVIDE)
             if (!_Py_QnewFlag) {
                 w = POP();
                 v = TOP();
@@ -1704,42 +2043,42 @@ PyEval_EvalFrame_value(PyFrameObject *f, int throwflag, PyObject *retval)
                 Py_DECREF(v);
                 Py_DECREF(w);
                 SET_TOP(x);
-                if (x != NULL) continue;
+                if (x != NULL) DISPATCH();
                 break;
             }
             /* -Qnew is in effect:  fall through to
                INPLACE_TRUE_DIVIDE */
-        case INPLACE_TRUE_DIVIDE:
+        TARGET(INPLACE_TRUE_DIVIDE)
             w = POP();
             v = TOP();
             x = PyNumber_InPlaceTrueDivide(v, w);
             Py_DECREF(v);
             Py_DECREF(w);
             SET_TOP(x);
-            if (x != NULL) continue;
+            if (x != NULL) DISPATCH();
             break;
 
-        case INPLACE_FLOOR_DIVIDE:
+        TARGET(INPLACE_FLOOR_DIVIDE)
             w = POP();
             v = TOP();
             x = PyNumber_InPlaceFloorDivide(v, w);
             Py_DECREF(v);
             Py_DECREF(w);
             SET_TOP(x);
-            if (x != NULL) continue;
+            if (x != NULL) DISPATCH();
             break;
 
-        case INPLACE_MODULO:
+        TARGET(INPLACE_MODULO)
             w = POP();
             v = TOP();
             x = PyNumber_InPlaceRemainder(v, w);
             Py_DECREF(v);
             Py_DECREF(w);
             SET_TOP(x);
-            if (x != NULL) continue;
+            if (x != NULL) DISPATCH();
             break;
 
-        case INPLACE_ADD:
+        TARGET(INPLACE_ADD)
             w = POP();
             v = TOP();
             if (PyInt_CheckExact(v) && PyInt_CheckExact(w)) {
@@ -1766,10 +2105,10 @@ PyEval_EvalFrame_value(PyFrameObject *f, int throwflag, PyObject *retval)
           skip_decref_v:
             Py_DECREF(w);
             SET_TOP(x);
-            if (x != NULL) continue;
+            if (x != NULL) DISPATCH();
             break;
 
-        case INPLACE_SUBTRACT:
+        TARGET(INPLACE_SUBTRACT)
             w = POP();
             v = TOP();
             if (PyInt_CheckExact(v) && PyInt_CheckExact(w)) {
@@ -1789,63 +2128,67 @@ PyEval_EvalFrame_value(PyFrameObject *f, int throwflag, PyObject *retval)
             Py_DECREF(v);
             Py_DECREF(w);
             SET_TOP(x);
-            if (x != NULL) continue;
+            if (x != NULL) DISPATCH();
             break;
 
-        case INPLACE_LSHIFT:
+        TARGET(INPLACE_LSHIFT)
             w = POP();
             v = TOP();
             x = PyNumber_InPlaceLshift(v, w);
             Py_DECREF(v);
             Py_DECREF(w);
             SET_TOP(x);
-            if (x != NULL) continue;
+            if (x != NULL) DISPATCH();
             break;
 
-        case INPLACE_RSHIFT:
+        TARGET(INPLACE_RSHIFT)
             w = POP();
             v = TOP();
             x = PyNumber_InPlaceRshift(v, w);
             Py_DECREF(v);
             Py_DECREF(w);
             SET_TOP(x);
-            if (x != NULL) continue;
+            if (x != NULL) DISPATCH();
             break;
 
-        case INPLACE_AND:
+        TARGET(INPLACE_AND)
             w = POP();
             v = TOP();
             x = PyNumber_InPlaceAnd(v, w);
             Py_DECREF(v);
             Py_DECREF(w);
             SET_TOP(x);
-            if (x != NULL) continue;
+            if (x != NULL) DISPATCH();
             break;
 
-        case INPLACE_XOR:
+        TARGET(INPLACE_XOR)
             w = POP();
             v = TOP();
             x = PyNumber_InPlaceXor(v, w);
             Py_DECREF(v);
             Py_DECREF(w);
             SET_TOP(x);
-            if (x != NULL) continue;
+            if (x != NULL) DISPATCH();
             break;
 
-        case INPLACE_OR:
+        TARGET(INPLACE_OR)
             w = POP();
             v = TOP();
             x = PyNumber_InPlaceOr(v, w);
             Py_DECREF(v);
             Py_DECREF(w);
             SET_TOP(x);
-            if (x != NULL) continue;
+            if (x != NULL) DISPATCH();
             break;
 
-        case SLICE+0:
-        case SLICE+1:
-        case SLICE+2:
-        case SLICE+3:
+        TARGET_WITH_NAME(SLICE_0, SLICE+0)
+            goto _slice;
+        TARGET_WITH_NAME(SLICE_1, SLICE+1)
+            goto _slice;
+        TARGET_WITH_NAME(SLICE_2, SLICE+2)
+            goto _slice;
+        TARGET_WITH_NAME(SLICE_3, SLICE+3)
+        _slice:
             if ((opcode-SLICE) & 2)
                 w = POP();
             else
@@ -1860,13 +2203,17 @@ PyEval_EvalFrame_value(PyFrameObject *f, int throwflag, PyObject *retval)
             Py_XDECREF(v);
             Py_XDECREF(w);
             SET_TOP(x);
-            if (x != NULL) continue;
+            if (x != NULL) DISPATCH();
             break;
 
-        case STORE_SLICE+0:
-        case STORE_SLICE+1:
-        case STORE_SLICE+2:
-        case STORE_SLICE+3:
+        TARGET_WITH_NAME(STORE_SLICE_0, STORE_SLICE+0)
+            goto _store_slice;
+        TARGET_WITH_NAME(STORE_SLICE_1, STORE_SLICE+1)
+            goto _store_slice;
+        TARGET_WITH_NAME(STORE_SLICE_2, STORE_SLICE+2)
+            goto _store_slice;
+        TARGET_WITH_NAME(STORE_SLICE_3, STORE_SLICE+3)
+        _store_slice:
             if ((opcode-STORE_SLICE) & 2)
                 w = POP();
             else
@@ -1882,13 +2229,17 @@ PyEval_EvalFrame_value(PyFrameObject *f, int throwflag, PyObject *retval)
             Py_DECREF(u);
             Py_XDECREF(v);
             Py_XDECREF(w);
-            if (err == 0) continue;
+            if (err == 0) DISPATCH();
             break;
 
-        case DELETE_SLICE+0:
-        case DELETE_SLICE+1:
-        case DELETE_SLICE+2:
-        case DELETE_SLICE+3:
+        TARGET_WITH_NAME(DELETE_SLICE_0, DELETE_SLICE+0)
+            goto _delete_slice;
+        TARGET_WITH_NAME(DELETE_SLICE_1, DELETE_SLICE+1)
+            goto _delete_slice;
+        TARGET_WITH_NAME(DELETE_SLICE_2, DELETE_SLICE+2)
+            goto _delete_slice;
+        TARGET_WITH_NAME(DELETE_SLICE_3, DELETE_SLICE+3)
+        _delete_slice:
             if ((opcode-DELETE_SLICE) & 2)
                 w = POP();
             else
@@ -1903,10 +2254,10 @@ PyEval_EvalFrame_value(PyFrameObject *f, int throwflag, PyObject *retval)
             Py_DECREF(u);
             Py_XDECREF(v);
             Py_XDECREF(w);
-            if (err == 0) continue;
+            if (err == 0) DISPATCH();
             break;
 
-        case STORE_SUBSCR:
+        TARGET(STORE_SUBSCR)
             w = TOP();
             v = SECOND();
             u = THIRD();
@@ -1916,10 +2267,10 @@ PyEval_EvalFrame_value(PyFrameObject *f, int throwflag, PyObject *retval)
             Py_DECREF(u);
             Py_DECREF(v);
             Py_DECREF(w);
-            if (err == 0) continue;
+            if (err == 0) DISPATCH();
             break;
 
-        case DELETE_SUBSCR:
+        TARGET(DELETE_SUBSCR)
             w = TOP();
             v = SECOND();
             STACKADJ(-2);
@@ -1927,10 +2278,10 @@ PyEval_EvalFrame_value(PyFrameObject *f, int throwflag, PyObject *retval)
             err = PyObject_DelItem(v, w);
             Py_DECREF(v);
             Py_DECREF(w);
-            if (err == 0) continue;
+            if (err == 0) DISPATCH();
             break;
 
-        case PRINT_EXPR:
+        TARGET(PRINT_EXPR)
             v = POP();
             w = PySys_GetObject("displayhook");
             if (w == NULL) {
@@ -1954,11 +2305,11 @@ PyEval_EvalFrame_value(PyFrameObject *f, int throwflag, PyObject *retval)
             Py_XDECREF(x);
             break;
 
-        case PRINT_ITEM_TO:
+        TARGET(PRINT_ITEM_TO)
             w = stream = POP();
             /* fall through to PRINT_ITEM */
 
-        case PRINT_ITEM:
+        TARGET(PRINT_ITEM)
             v = POP();
             if (stream == NULL || stream == Py_None) {
                 w = PySys_GetObject("stdout");
@@ -2005,14 +2356,14 @@ PyEval_EvalFrame_value(PyFrameObject *f, int throwflag, PyObject *retval)
             Py_XDECREF(stream);
             stream = NULL;
             if (err == 0)
-                continue;
+                DISPATCH();
             break;
 
-        case PRINT_NEWLINE_TO:
+        TARGET(PRINT_NEWLINE_TO)
             w = stream = POP();
             /* fall through to PRINT_NEWLINE */
 
-        case PRINT_NEWLINE:
+        TARGET(PRINT_NEWLINE)
             if (stream == NULL || stream == Py_None) {
                 w = PySys_GetObject("stdout");
                 if (w == NULL) {
@@ -2038,7 +2389,7 @@ PyEval_EvalFrame_value(PyFrameObject *f, int throwflag, PyObject *retval)
 #ifdef CASE_TOO_BIG
         default: switch (opcode) {
 #endif
-        case RAISE_VARARGS:
+        TARGET(RAISE_VARARGS)
             u = v = w = NULL;
             switch (oparg) {
             case 3:
@@ -2060,27 +2411,28 @@ PyEval_EvalFrame_value(PyFrameObject *f, int throwflag, PyObject *retval)
             }
             break;
 
-        case LOAD_LOCALS:
+        TARGET(LOAD_LOCALS)
             if ((x = f->f_locals) != NULL) {
                 Py_INCREF(x);
                 PUSH(x);
-                continue;
+                DISPATCH();
             }
             PyErr_SetString(PyExc_SystemError, "no locals");
             break;
 
-        case RETURN_VALUE:
+        TARGET(RETURN_VALUE)
+        SUPER_TARGET(RETURN_VALUE)
             retval = POP();
             why = WHY_RETURN;
             goto fast_block_end;
 
-        case YIELD_VALUE:
+        TARGET(YIELD_VALUE)
             retval = POP();
             f->f_stacktop = stack_pointer;
             why = WHY_YIELD;
             goto fast_yield;
 
-        case EXEC_STMT:
+        TARGET(EXEC_STMT)
             w = TOP();
             v = SECOND();
             u = THIRD();
@@ -2093,7 +2445,7 @@ PyEval_EvalFrame_value(PyFrameObject *f, int throwflag, PyObject *retval)
             Py_DECREF(w);
             break;
 
-        case POP_BLOCK:
+        TARGET(POP_BLOCK)
             {
                 PyTryBlock *b = PyFrame_BlockPop(f);
                 while (STACK_LEVEL() > b->b_level) {
@@ -2101,10 +2453,10 @@ PyEval_EvalFrame_value(PyFrameObject *f, int throwflag, PyObject *retval)
                     Py_DECREF(v);
                 }
             }
-            continue;
+            DISPATCH();
 
         PREDICTED(END_FINALLY);
-        case END_FINALLY:
+        TARGET(END_FINALLY)
             v = POP();
             if (PyInt_Check(v)) {
                 why = (enum why_code) PyInt_AS_LONG(v);
@@ -2129,7 +2481,7 @@ PyEval_EvalFrame_value(PyFrameObject *f, int throwflag, PyObject *retval)
             Py_DECREF(v);
             break;
 
-        case BUILD_CLASS:
+        TARGET(BUILD_CLASS)
             u = TOP();
             v = SECOND();
             w = THIRD();
@@ -2141,7 +2493,7 @@ PyEval_EvalFrame_value(PyFrameObject *f, int throwflag, PyObject *retval)
             Py_DECREF(w);
             break;
 
-        case STORE_NAME:
+        TARGET(STORE_NAME)
             w = GETITEM(names, oparg);
             v = POP();
             if ((x = f->f_locals) != NULL) {
@@ -2150,7 +2502,7 @@ PyEval_EvalFrame_value(PyFrameObject *f, int throwflag, PyObject *retval)
                 else
                     err = PyObject_SetItem(x, w, v);
                 Py_DECREF(v);
-                if (err == 0) continue;
+                if (err == 0) DISPATCH();
                 break;
             }
             PyErr_Format(PyExc_SystemError,
@@ -2158,7 +2510,7 @@ PyEval_EvalFrame_value(PyFrameObject *f, int throwflag, PyObject *retval)
                          PyObject_REPR(w));
             break;
 
-        case DELETE_NAME:
+        TARGET(DELETE_NAME)
             w = GETITEM(names, oparg);
             if ((x = f->f_locals) != NULL) {
                 if ((err = PyObject_DelItem(x, w)) != 0)
@@ -2173,7 +2525,7 @@ PyEval_EvalFrame_value(PyFrameObject *f, int throwflag, PyObject *retval)
             break;
 
         PREDICTED_WITH_ARG(UNPACK_SEQUENCE);
-        case UNPACK_SEQUENCE:
+        TARGET(UNPACK_SEQUENCE)
             v = POP();
             if (PyTuple_CheckExact(v) &&
                 PyTuple_GET_SIZE(v) == oparg) {
@@ -2185,7 +2537,7 @@ PyEval_EvalFrame_value(PyFrameObject *f, int throwflag, PyObject *retval)
                     PUSH(w);
                 }
                 Py_DECREF(v);
-                continue;
+                DISPATCH();
             } else if (PyList_CheckExact(v) &&
                        PyList_GET_SIZE(v) == oparg) {
                 PyObject **items = \
@@ -2205,18 +2557,24 @@ PyEval_EvalFrame_value(PyFrameObject *f, int throwflag, PyObject *retval)
             Py_DECREF(v);
             break;
 
-        case STORE_ATTR:
+        TARGET(STORE_ATTR)
             w = GETITEM(names, oparg);
             v = TOP();
             u = SECOND();
             STACKADJ(-2);
-            err = PyObject_SetAttr(v, w, u); /* v.w = u */
+            {
+                PyAttrCache *ac = ATTR_CACHE();
+                if (ac != NULL)
+                    err = _PyObject_SetAttrCached(v, w, u, ac);
+                else
+                    err = PyObject_SetAttr(v, w, u); /* v.w = u */
+            }
             Py_DECREF(v);
             Py_DECREF(u);
-            if (err == 0) continue;
+            if (err == 0) DISPATCH();
             break;
 
-        case DELETE_ATTR:
+        TARGET(DELETE_ATTR)
             w = GETITEM(names, oparg);
             v = POP();
             err = PyObject_SetAttr(v, w, (PyObject *)NULL);
@@ -2224,22 +2582,22 @@ PyEval_EvalFrame_value(PyFrameObject *f, int throwflag, PyObject *retval)
             Py_DECREF(v);
             break;
 
-        case STORE_GLOBAL:
+        TARGET(STORE_GLOBAL)
             w = GETITEM(names, oparg);
             v = POP();
             err = PyDict_SetItem(f->f_globals, w, v);
             Py_DECREF(v);
-            if (err == 0) continue;
+            if (err == 0) DISPATCH();
             break;
 
-        case DELETE_GLOBAL:
+        TARGET(DELETE_GLOBAL)
             w = GETITEM(names, oparg);
             if ((err = PyDict_DelItem(f->f_globals, w)) != 0)
                 format_exc_check_arg(
                     PyExc_NameError, GLOBAL_NAME_ERROR_MSG, w);
             break;
 
-        case LOAD_NAME:
+        TARGET(LOAD_NAME)
             w = GETITEM(names, oparg);
             if ((v = f->f_locals) == NULL) {
                 PyErr_Format(PyExc_SystemError,
@@ -2275,9 +2633,9 @@ PyEval_EvalFrame_value(PyFrameObject *f, int throwflag, PyObject *retval)
                 Py_INCREF(x);
             }
             PUSH(x);
-            continue;
+            DISPATCH();
 
-        case LOAD_GLOBAL:
+        TARGET(LOAD_GLOBAL)
             w = GETITEM(names, oparg);
             if (PyString_CheckExact(w)) {
                 /* Inline the PyDict_GetItem() calls.
@@ -2287,31 +2645,52 @@ PyEval_EvalFrame_value(PyFrameObject *f, int throwflag, PyObject *retval)
                 if (hash != -1) {
                     PyDictObject *d;
                     PyDictEntry *e;
-                    d = (PyDictObject *)(f->f_globals);
+                    PyDictObject *g = (PyDictObject *)(f->f_globals);
+                    PyDictObject *b = (PyDictObject *)(f->f_builtins);
+                    PyGlobalCacheEntry *c = co->co_globalcache;
+
+                    /* Unchanged dicts still hold the value we found */
+                    if (c != NULL) {
+                        c += oparg;
+                        if (c->gc_globals_version == g->ma_version_tag &&
+                            c->gc_builtins_version == b->ma_version_tag) {
+                            x = c->gc_value;
+                            Py_INCREF(x);
+                            PUSH(x);
+                            DISPATCH();
+                        }
+                    }
+                    d = g;
                     e = d->ma_lookup(d, w, hash);
                     if (e == NULL) {
                         x = NULL;
                         break;
                     }
                     x = e->me_value;
-                    if (x != NULL) {
-                        Py_INCREF(x);
-                        PUSH(x);
-                        continue;
+                    if (x == NULL) {
+                        d = b;
+                        e = d->ma_lookup(d, w, hash);
+                        if (e == NULL) {
+                            x = NULL;
+                            break;
+                        }
+                        x = e->me_value;
+                        if (x == NULL)
+                            goto load_global_error;
                     }
-                    d = (PyDictObject *)(f->f_builtins);
-                    e = d->ma_lookup(d, w, hash);
-                    if (e == NULL) {
-                        x = NULL;
-                        break;
+                    if (c == NULL) {
+                        c = _PyCode_GetGlobalCache(co);
+                        if (c != NULL)
+                            c += oparg;
                     }
-                    x = e->me_value;
-                    if (x != NULL) {
-                        Py_INCREF(x);
-                        PUSH(x);
-                        continue;
+                    if (c != NULL) {
+                        c->gc_globals_version = g->ma_version_tag;
+                        c->gc_builtins_version = b->ma_version_tag;
+                        c->gc_value = x;
                     }
-                    goto load_global_error;
+                    Py_INCREF(x);
+                    PUSH(x);
+                    DISPATCH();
                 }
             }
             /* This is the un-inlined version of the code above */
@@ -2328,13 +2707,13 @@ PyEval_EvalFrame_value(PyFrameObject *f, int throwflag, PyObject *retval)
             }
             Py_INCREF(x);
             PUSH(x);
-            continue;
+            DISPATCH();
 
-        case DELETE_FAST:
+        TARGET(DELETE_FAST)
             x = GETLOCAL(oparg);
             if (x != NULL) {
                 SETLOCAL(oparg, NULL);
-                continue;
+                DISPATCH();
             }
             format_exc_check_arg(
                 PyExc_UnboundLocalError,
@@ -2343,19 +2722,19 @@ PyEval_EvalFrame_value(PyFrameObject *f, int throwflag, PyObject *retval)
                 );
             break;
 
-        case LOAD_CLOSURE:
+        TARGET(LOAD_CLOSURE)
             x = freevars[oparg];
             Py_INCREF(x);
             PUSH(x);
-            if (x != NULL) continue;
+            if (x != NULL) DISPATCH();
             break;
 
-        case LOAD_DEREF:
+        TARGET(LOAD_DEREF)
             x = freevars[oparg];
             w = PyCell_Get(x);
             if (w != NULL) {
                 PUSH(w);
-                continue;
+                DISPATCH();
             }
             err = -1;
             /* Don't stomp existing exception */
@@ -2376,14 +2755,14 @@ PyEval_EvalFrame_value(PyFrameObject *f, int throwflag, PyObject *retval)
             }
             break;
 
-        case STORE_DEREF:
+        TARGET(STORE_DEREF)
             w = POP();
             x = freevars[oparg];
             PyCell_Set(x, w);
             Py_DECREF(w);
-            continue;
+            DISPATCH();
 
-        case BUILD_TUPLE:
+        TARGET(BUILD_TUPLE)
             x = PyTuple_New(oparg);
             if (x != NULL) {
                 for (; --oparg >= 0;) {
@@ -2391,11 +2770,11 @@ PyEval_EvalFrame_value(PyFrameObject *f, int throwflag, PyObject *retval)
                     PyTuple_SET_ITEM(x, oparg, w);
                 }
                 PUSH(x);
-                continue;
+                DISPATCH();
             }
             break;
 
-        case BUILD_LIST:
+        TARGET(BUILD_LIST)
             x =  PyList_New(oparg);
             if (x != NULL) {
                 for (; --oparg >= 0;) {
@@ -2403,11 +2782,11 @@ PyEval_EvalFrame_value(PyFrameObject *f, int throwflag, PyObject *retval)
                     PyList_SET_ITEM(x, oparg, w);
                 }
                 PUSH(x);
-                continue;
+                DISPATCH();
             }
             break;
 
-        case BUILD_SET:
+        TARGET(BUILD_SET)
             x = PySet_New(NULL);
             if (x != NULL) {
                 for (; --oparg >= 0;) {
@@ -2421,18 +2800,18 @@ PyEval_EvalFrame_value(PyFrameObject *f, int throwflag, PyObject *retval)
                     break;
                 }
                 PUSH(x);
-                continue;
+                DISPATCH();
             }
             break;
 
 
-        case BUILD_MAP:
+        TARGET(BUILD_MAP)
             x = _PyDict_NewPresized((Py_ssize_t)oparg);
             PUSH(x);
-            if (x != NULL) continue;
+            if (x != NULL) DISPATCH();
             break;
 
-        case STORE_MAP:
+        TARGET(STORE_MAP)
             w = TOP();     /* key */
             u = SECOND();  /* value */
             v = THIRD();   /* dict */
@@ -2441,10 +2820,10 @@ PyEval_EvalFrame_value(PyFrameObject *f, int throwflag, PyObject *retval)
             err = PyDict_SetItem(v, w, u);  /* v[w] = u */
             Py_DECREF(u);
             Py_DECREF(w);
-            if (err == 0) continue;
+            if (err == 0) DISPATCH();
             break;
 
-        case MAP_ADD:
+        TARGET(MAP_ADD)
             w = TOP();     /* key */
             u = SECOND();  /* value */
             STACKADJ(-2);
@@ -2455,22 +2834,64 @@ PyEval_EvalFrame_value(PyFrameObject *f, int throwflag, PyObject *retval)
             Py_DECREF(w);
             if (err == 0) {
                 PREDICT(JUMP_ABSOLUTE);
-                continue;
+                DISPATCH();
             }
             break;
 
-        case LOAD_ATTR:
+        TARGET(LOAD_ATTR)
+        SUPER_TARGET(LOAD_ATTR)
             w = GETITEM(names, oparg);
             v = TOP();
-            x = PyObject_GetAttr(v, w);
+            {
+                PyAttrCache *ac = ATTR_CACHE();
+                if (ac != NULL)
+                    x = _PyObject_GetAttrCached(v, w, ac);
+                else
+                    x = PyObject_GetAttr(v, w);
+            }
             Py_DECREF(v);
             SET_TOP(x);
-            if (x != NULL) continue;
+            if (x != NULL) DISPATCH();
             break;
 
-        case COMPARE_OP:
+        TARGET(LOAD_METHOD)
+        SUPER_TARGET(LOAD_METHOD)
+        {
+            PyObject *meth;
+            int unbound;
+            w = GETITEM(names, oparg);
+            v = TOP();
+            unbound = _PyObject_GetMethod(v, w, ATTR_CACHE(), &meth);
+            x = meth;
+            if (unbound && PyMethodDescr_Check(meth) &&
+                tstate->use_tracing && tstate->c_profilefunc != NULL) {
+                /* profilers only see calls of bound builtin methods */
+                x = Py_TYPE(meth)->tp_descr_get(meth, v,
+                                                (PyObject *)Py_TYPE(v));
+                Py_DECREF(meth);
+                unbound = 0;
+            }
+            if (unbound) {
+                /* v becomes the first argument of the function */
+                SET_TOP(x);
+                PUSH(v);
+                DISPATCH();
+            }
+            Py_DECREF(v);
+            SET_TOP(NULL);
+            PUSH(x);
+            if (x != NULL) DISPATCH();
+            break;
+        }
+
+        TARGET(COMPARE_OP_POP_JUMP_IF_FALSE)
+            goto compare_op;
+
+        TARGET(COMPARE_OP)
+        compare_op:
             w = POP();
             v = TOP();
+            QUICKEN(INSTR_OFFSET() - 3, COMPARE_OP_KIND(v, w, oparg));
             if (PyInt_CheckExact(w) && PyInt_CheckExact(v)) {
                 /* INLINE: cmp(int, int) */
                 register long a, b;
@@ -2499,11 +2920,70 @@ PyEval_EvalFrame_value(PyFrameObject *f, int throwflag, PyObject *retval)
             Py_DECREF(w);
             SET_TOP(x);
             if (x == NULL) break;
+            if (opcode == COMPARE_OP_POP_JUMP_IF_FALSE)
+                SUPER_NEXT(POP_JUMP_IF_FALSE);
             PREDICT(POP_JUMP_IF_FALSE);
             PREDICT(POP_JUMP_IF_TRUE);
-            continue;
+            DISPATCH();
+
+        TARGET(COMPARE_OP_FLOAT)
+        {
+            double a, b;
+            int res;
+
+            w = TOP();
+            v = SECOND();
+            if (!PyFloat_CheckExact(v) || !PyFloat_CheckExact(w)) {
+                DEOPTIMIZE(INSTR_OFFSET() - 3);
+                goto compare_op;
+            }
+            a = PyFloat_AS_DOUBLE(v);
+            b = PyFloat_AS_DOUBLE(w);
+            switch (oparg) {
+            case PyCmp_LT: res = a <  b; break;
+            case PyCmp_LE: res = a <= b; break;
+            case PyCmp_EQ: res = a == b; break;
+            case PyCmp_NE: res = a != b; break;
+            case PyCmp_GT: res = a >  b; break;
+            case PyCmp_GE: res = a >= b; break;
+            default: goto compare_op;
+            }
+            x = res ? Py_True : Py_False;
+            Py_INCREF(x);
+            STACKADJ(-1);
+            Py_DECREF(v);
+            Py_DECREF(w);
+            SET_TOP(x);
+            PREDICT(POP_JUMP_IF_FALSE);
+            PREDICT(POP_JUMP_IF_TRUE);
+            DISPATCH();
+        }
+
+        TARGET(COMPARE_OP_STR)
+        {
+            int res;
+
+            w = TOP();
+            v = SECOND();
+            if (!PyString_CheckExact(v) || !PyString_CheckExact(w)) {
+                DEOPTIMIZE(INSTR_OFFSET() - 3);
+                goto compare_op;
+            }
+            res = v == w || _PyString_Eq(v, w);
+            if (oparg == PyCmp_NE)
+                res = !res;
+            x = res ? Py_True : Py_False;
+            Py_INCREF(x);
+            STACKADJ(-1);
+            Py_DECREF(v);
+            Py_DECREF(w);
+            SET_TOP(x);
+            PREDICT(POP_JUMP_IF_FALSE);
+            PREDICT(POP_JUMP_IF_TRUE);
+            DISPATCH();
+        }
 
-        case IMPORT_NAME:
+        TARGET(IMPORT_NAME)
             w = GETITEM(names, oparg);
             x = PyDict_GetItemString(f->f_builtins, "__import__");
             if (x == NULL) {
@@ -2544,10 +3024,10 @@ PyEval_EvalFrame_value(PyFrameObject *f, int throwflag, PyObject *retval)
             READ_TIMESTAMP(intr1);
             Py_DECREF(w);
             SET_TOP(x);
-            if (x != NULL) continue;
+            if (x != NULL) DISPATCH();
             break;
 
-        case IMPORT_STAR:
+        TARGET(IMPORT_STAR)
             v = POP();
             PyFrame_FastToLocals(f);
             if ((x = f->f_locals) == NULL) {
@@ -2560,34 +3040,35 @@ PyEval_EvalFrame_value(PyFrameObject *f, int throwflag, PyObject *retval)
             READ_TIMESTAMP(intr1);
             PyFrame_LocalsToFast(f, 0);
             Py_DECREF(v);
-            if (err == 0) continue;
+            if (err == 0) DISPATCH();
             break;
 
-        case IMPORT_FROM:
+        TARGET(IMPORT_FROM)
             w = GETITEM(names, oparg);
             v = TOP();
             READ_TIMESTAMP(intr0);
             x = import_from(v, w);
             READ_TIMESTAMP(intr1);
             PUSH(x);
-            if (x != NULL) continue;
+            if (x != NULL) DISPATCH();
             break;
 
-        case JUMP_FORWARD:
+        TARGET(JUMP_FORWARD)
             JUMPBY(oparg);
-            goto fast_next_opcode;
+            FAST_DISPATCH();
 
         PREDICTED_WITH_ARG(POP_JUMP_IF_FALSE);
-        case POP_JUMP_IF_FALSE:
+        TARGET(POP_JUMP_IF_FALSE)
+        SUPER_TARGET(POP_JUMP_IF_FALSE)
             w = POP();
             if (w == Py_True) {
                 Py_DECREF(w);
-                goto fast_next_opcode;
+                FAST_DISPATCH();
             }
             if (w == Py_False) {
                 Py_DECREF(w);
                 JUMPTO(oparg);
-                goto fast_next_opcode;
+                FAST_DISPATCH();
             }
             err = PyObject_IsTrue(w);
             Py_DECREF(w);
@@ -2597,19 +3078,19 @@ PyEval_EvalFrame_value(PyFrameObject *f, int throwflag, PyObject *retval)
                 JUMPTO(oparg);
             else
                 break;
-            continue;
+            DISPATCH();
 
         PREDICTED_WITH_ARG(POP_JUMP_IF_TRUE);
-        case POP_JUMP_IF_TRUE:
+        TARGET(POP_JUMP_IF_TRUE)
             w = POP();
             if (w == Py_False) {
                 Py_DECREF(w);
-                goto fast_next_opcode;
+                FAST_DISPATCH();
             }
             if (w == Py_True) {
                 Py_DECREF(w);
                 JUMPTO(oparg);
-                goto fast_next_opcode;
+                FAST_DISPATCH();
             }
             err = PyObject_IsTrue(w);
             Py_DECREF(w);
@@ -2621,18 +3102,18 @@ PyEval_EvalFrame_value(PyFrameObject *f, int throwflag, PyObject *retval)
                 ;
             else
                 break;
-            continue;
+            DISPATCH();
 
-        case JUMP_IF_FALSE_OR_POP:
+        TARGET(JUMP_IF_FALSE_OR_POP)
             w = TOP();
             if (w == Py_True) {
                 STACKADJ(-1);
                 Py_DECREF(w);
-                goto fast_next_opcode;
+                FAST_DISPATCH();
             }
             if (w == Py_False) {
                 JUMPTO(oparg);
-                goto fast_next_opcode;
+                FAST_DISPATCH();
             }
             err = PyObject_IsTrue(w);
             if (err > 0) {
@@ -2644,18 +3125,18 @@ PyEval_EvalFrame_value(PyFrameObject *f, int throwflag, PyObject *retval)
                 JUMPTO(oparg);
             else
                 break;
-            continue;
+            DISPATCH();
 
-        case JUMP_IF_TRUE_OR_POP:
+        TARGET(JUMP_IF_TRUE_OR_POP)
             w = TOP();
             if (w == Py_False) {
                 STACKADJ(-1);
                 Py_DECREF(w);
-                goto fast_next_opcode;
+                FAST_DISPATCH();
             }
             if (w == Py_True) {
                 JUMPTO(oparg);
-                goto fast_next_opcode;
+                FAST_DISPATCH();
             }
             err = PyObject_IsTrue(w);
             if (err > 0) {
@@ -2668,11 +3149,21 @@ PyEval_EvalFrame_value(PyFrameObject *f, int throwflag, PyObject *retval)
             }
             else
                 break;
-            continue;
+            DISPATCH();
 
         PREDICTED_WITH_ARG(JUMP_ABSOLUTE);
-        case JUMP_ABSOLUTE:
+        TARGET(JUMP_ABSOLUTE)
             JUMPTO(oparg);
+            if (quick == NULL) {
+                /* a loop counts towards quickening, too */
+                if (co->co_warmup > 0 && --co->co_warmup == 0)
+                    _PyCode_Quicken(co);
+                if (co->co_quickened != NULL) {
+                    quick = co->co_quickened;
+                    first_instr = quick->qc_code;
+                    JUMPTO(oparg);
+                }
+            }
 #if FAST_LOOPS
             /* Enabling this path speeds-up all while and for-loops by bypassing
                the per-loop checks for signals.  By default, this should be turned-off
@@ -2681,12 +3172,12 @@ PyEval_EvalFrame_value(PyFrameObject *f, int throwflag, PyObject *retval)
                the speed-up and do not need break checking inside tight loops (ones
                that contain only instructions ending with goto fast_next_opcode).
             */
-            goto fast_next_opcode;
+            FAST_DISPATCH();
 #else
-            continue;
+            DISPATCH();
 #endif
 
-        case GET_ITER:
+        TARGET(GET_ITER)
             /* before: [obj]; after [getiter(obj)] */
             v = TOP();
             x = PyObject_GetIter(v);
@@ -2694,13 +3185,13 @@ PyEval_EvalFrame_value(PyFrameObject *f, int throwflag, PyObject *retval)
             if (x != NULL) {
                 SET_TOP(x);
                 PREDICT(FOR_ITER);
-                continue;
+                DISPATCH();
             }
             STACKADJ(-1);
             break;
 
         PREDICTED_WITH_ARG(FOR_ITER);
-        case FOR_ITER:
+        TARGET(FOR_ITER)
             /* before: [iter]; after: [iter, iter()] *or* [] */
             v = TOP();
 #ifdef STACKLESS
@@ -2719,7 +3210,7 @@ stackless_iter_return:
                 PUSH(x);
                 PREDICT(STORE_FAST);
                 PREDICT(UNPACK_SEQUENCE);
-                continue;
+                DISPATCH();
             }
             if (PyErr_Occurred()) {
                 if (!PyErr_ExceptionMatches(
@@ -2731,13 +3222,13 @@ stackless_iter_return:
             x = v = POP();
             Py_DECREF(v);
             JUMPBY(oparg);
-            continue;
+            DISPATCH();
 
-        case BREAK_LOOP:
+        TARGET(BREAK_LOOP)
             why = WHY_BREAK;
             goto fast_block_end;
 
-        case CONTINUE_LOOP:
+        TARGET(CONTINUE_LOOP)
             retval = PyInt_FromLong(oparg);
             if (!retval) {
                 x = NULL;
@@ -2746,9 +3237,12 @@ stackless_iter_return:
             why = WHY_CONTINUE;
             goto fast_block_end;
 
-        case SETUP_LOOP:
-        case SETUP_EXCEPT:
-        case SETUP_FINALLY:
+        TARGET(SETUP_LOOP)
+            goto _setup_finally;
+        TARGET(SETUP_EXCEPT)
+            goto _setup_finally;
+        TARGET(SETUP_FINALLY)
+        _setup_finally:
             /* NOTE: If you add any new block-setup opcodes that
                are not try/except/finally handlers, you may need
                to update the PyGen_NeedsFinalizing() function.
@@ -2756,9 +3250,9 @@ stackless_iter_return:
 
             PyFrame_BlockSetup(f, opcode, INSTR_OFFSET() + oparg,
                                STACK_LEVEL());
-            continue;
+            DISPATCH();
 
-        case SETUP_WITH:
+        TARGET(SETUP_WITH)
         {
             static PyObject *exit, *enter;
             w = TOP();
@@ -2784,10 +3278,10 @@ stackless_iter_return:
                                STACK_LEVEL());
 
             PUSH(x);
-            continue;
+            DISPATCH();
         }
 
-        case WITH_CLEANUP:
+        TARGET(WITH_CLEANUP)
         {
             /* At the top of the stack are 1-3 values indicating
                how/why we entered the finally clause:
@@ -2875,7 +3369,22 @@ stackless_iter_return:
             break;
         }
 
-        case CALL_FUNCTION:
+        TARGET(CALL_METHOD)
+        {
+            /* LOAD_METHOD left either the function and self, or NULL
+               and the callable below the arguments */
+            PyObject **base = stack_pointer - oparg - 2;
+            if (*base == NULL) {
+                memmove(base, base + 1, (oparg + 1) * sizeof(PyObject *));
+                stack_pointer--;
+            }
+            else
+                oparg++;
+            goto _call_function;
+        }
+
+        TARGET(CALL_FUNCTION)
+        _call_function:
         {
             PyObject **sp;
             PCALL(PCALL_ALL);
@@ -2894,13 +3403,16 @@ stackless_call_return:
 #endif
             PUSH(x);
             if (x != NULL)
-                continue;
+                DISPATCH();
             break;
         }
 
-        case CALL_FUNCTION_VAR:
-        case CALL_FUNCTION_KW:
-        case CALL_FUNCTION_VAR_KW:
+        TARGET(CALL_FUNCTION_VAR)
+            goto _call_function_var_kw;
+        TARGET(CALL_FUNCTION_KW)
+            goto _call_function_var_kw;
+        TARGET(CALL_FUNCTION_VAR_KW)
+        _call_function_var_kw:
         {
             int na = oparg & 0xff;
             int nk = (oparg>>8) & 0xff;
@@ -2944,11 +3456,11 @@ stackless_call_return:
 #endif
             PUSH(x);
             if (x != NULL)
-                continue;
+                DISPATCH();
             break;
         }
 
-        case MAKE_FUNCTION:
+        TARGET(MAKE_FUNCTION)
             v = POP(); /* code object */
             x = PyFunction_New(v, f->f_globals);
             Py_DECREF(v);
@@ -2970,7 +3482,7 @@ stackless_call_return:
             PUSH(x);
             break;
 
-        case MAKE_CLOSURE:
+        TARGET(MAKE_CLOSURE)
         {
             v = POP(); /* code object */
             x = PyFunction_New(v, f->f_globals);
@@ -3005,7 +3517,7 @@ stackless_call_return:
             break;
         }
 
-        case BUILD_SLICE:
+        TARGET(BUILD_SLICE)
             if (oparg == 3)
                 w = POP();
             else
@@ -3017,14 +3529,17 @@ stackless_call_return:
             Py_DECREF(v);
             Py_XDECREF(w);
             SET_TOP(x);
-            if (x != NULL) continue;
+            if (x != NULL) DISPATCH();
             break;
 
-        case EXTENDED_ARG:
+        TARGET(EXTENDED_ARG)
             opcode = NEXTOP();
             oparg = oparg<<16 | NEXTARG();
             goto dispatch_opcode;
 
+#if USE_COMPUTED_GOTOS
+        _unknown_opcode:
+#endif
         default:
             fprintf(stderr,
                 "XXX lineno: %d, opcode: %d\n",
@@ -4333,6 +4848,13 @@ call_function(PyObject ***pp_stack, int oparg
                 x = NULL;
             }
         }
+        else if (flags & METH_FASTCALL) {
+            PyCFunctionFast meth =
+                (PyCFunctionFast)PyCFunction_GET_FUNCTION(func);
+            PyObject *self = PyCFunction_GET_SELF(func);
+            STACKLESS_PROPOSE_FLAG(flags & METH_STACKLESS);
+            C_TRACE(x, (*meth)(self, (*pp_stack) - na, na));
+        }
         else {
             PyObject *callargs;
             callargs = load_args(pp_stack, na);
@@ -4343,6 +4865,14 @@ call_function(PyObject ***pp_stack, int oparg
             Py_XDECREF(callargs);
         }
         STACKLESS_ASSERT();
+    } else if (PyMethodDescr_Check(func)) {
+        /* a method of a builtin type, as left by LOAD_METHOD */
+        PCALL(PCALL_CFUNCTION);
+        STACKLESS_PROPOSE_FLAG(((PyMethodDescrObject *)func)->d_method->
+                               ml_flags & METH_STACKLESS);
+        x = _PyMethodDescr_FastCall(func, (*pp_stack) - n, na,
+                                    (*pp_stack) - 2*nk, nk);
+        STACKLESS_ASSERT();
     } else {
         if (PyMethod_Check(func) && PyMethod_GET_SELF(func) != NULL) {
             /* optimize access to bound methods */
@@ -4361,6 +4891,11 @@ call_function(PyObject ***pp_stack, int oparg
         READ_TIMESTAMP(*pintr0);
         if (PyFunction_Check(func))
             x = fast_function(func, pp_stack, n, na, nk);
+        else if (PyType_CheckExact(func)) {
+            PCALL(PCALL_TYPE);
+            x = _PyObject_FastCall(func, (*pp_stack) - n, na,
+                                   (*pp_stack) - 2*nk, nk);
+        }
         else
             x = do_call(func, pp_stack, na, nk);
         READ_TIMESTAMP(*pintr1);
@@ -4369,7 +4904,8 @@ call_function(PyObject ***pp_stack, int oparg
 
     /* Clear the stack of the function object.  Also removes
        the arguments in case they weren't consumed already
-       (fast_function() and err_args() leave them on the stack).
+       (the calls with the arguments in place on the stack and
+       err_args() leave them there).
      */
     while ((*pp_stack) > pfunc) {
         w = EXT_POP(*pp_stack);
@@ -4379,18 +4915,21 @@ call_function(PyObject ***pp_stack, int oparg
     return x;
 }
 
-/* The fast_function() function optimize calls for which no argument
-   tuple is necessary; the objects are passed directly from the stack.
-   For the simplest case -- a function that takes only positional
-   arguments and is called with only positional arguments -- it
-   inlines the most primitive frame setup code from
+/* _PyFunction_FastCall() calls a function with the arguments in C
+   arrays, so that no argument tuple is necessary; from the eval loop
+   they are passed directly from the stack.  For the simplest case -- a
+   function that takes only positional arguments, some of which may
+   have default values, and is called with only positional arguments
+   -- it inlines the most primitive frame setup code from
    PyEval_EvalCodeEx(), which vastly reduces the checks that must be
    done before evaluating the frame.
 */
 
-static PyObject *
-fast_function(PyObject *func, PyObject ***pp_stack, int n, int na, int nk)
+PyObject *
+_PyFunction_FastCall(PyObject *func, PyObject **args, Py_ssize_t nargs,
+                     PyObject **kws, Py_ssize_t nkws)
 {
+    STACKLESS_GETARG();
     PyCodeObject *co = (PyCodeObject *)PyFunction_GET_CODE(func);
     PyObject *globals = PyFunction_GET_GLOBALS(func);
     PyObject *argdefs = PyFunction_GET_DEFAULTS(func);
@@ -4399,12 +4938,17 @@ fast_function(PyObject *func, PyObject ***pp_stack, int n, int na, int nk)
 
     PCALL(PCALL_FUNCTION);
     PCALL(PCALL_FAST_FUNCTION);
-    if (argdefs == NULL && co->co_argcount == n && nk==0 &&
+    if (argdefs != NULL) {
+        d = &PyTuple_GET_ITEM(argdefs, 0);
+        nd = Py_SIZE(argdefs);
+    }
+    if (nkws == 0 && nargs <= co->co_argcount &&
+        nargs + nd >= co->co_argcount &&
         co->co_flags == (CO_OPTIMIZED | CO_NEWLOCALS | CO_NOFREE)) {
         PyFrameObject *f;
         PyObject *retval = NULL;
         PyThreadState *tstate = PyThreadState_GET();
-        PyObject **fastlocals, **stack;
+        PyObject **fastlocals;
         int i;
 
         PCALL(PCALL_FASTER_FUNCTION);
@@ -4419,15 +4963,21 @@ fast_function(PyObject *func, PyObject ***pp_stack, int n, int na, int nk)
             return NULL;
 
         fastlocals = f->f_localsplus;
-        stack = (*pp_stack) - n;
-
-        for (i = 0; i < n; i++) {
-            Py_INCREF(*stack);
-            fastlocals[i] = *stack++;
+        for (i = 0; i < nargs; i++) {
+            Py_INCREF(args[i]);
+            fastlocals[i] = args[i];
+        }
+        if (i < co->co_argcount) {
+            /* the missing arguments have default values */
+            d += nd - co->co_argcount;
+            for (; i < co->co_argcount; i++) {
+                Py_INCREF(d[i]);
+                fastlocals[i] = d[i];
+            }
         }
 #ifdef STACKLESS
         f->f_execute = PyEval_EvalFrameEx_slp;
-        if (STACKLESS_POSSIBLE()) {
+        if (stackless) {
             Py_INCREF(Py_None);
             retval = Py_None;
             tstate->frame = f;
@@ -4442,17 +4992,21 @@ fast_function(PyObject *func, PyObject ***pp_stack, int n, int na, int nk)
         --tstate->recursion_depth;
         return retval;
     }
-    if (argdefs != NULL) {
-        d = &PyTuple_GET_ITEM(argdefs, 0);
-        nd = Py_SIZE(argdefs);
-    }
-    STACKLESS_PROPOSE_ALL();
+    STACKLESS_PROMOTE_ALL();
     return PyEval_EvalCodeEx(co, globals,
-                             (PyObject *)NULL, (*pp_stack)-n, na,
-                             (*pp_stack)-2*nk, nk, d, nd,
+                             (PyObject *)NULL, args, (int)nargs,
+                             kws, (int)nkws, d, nd,
                              PyFunction_GET_CLOSURE(func));
 }
 
+static PyObject *
+fast_function(PyObject *func, PyObject ***pp_stack, int n, int na, int nk)
+{
+    STACKLESS_PROPOSE_ALL();
+    return _PyFunction_FastCall(func, (*pp_stack) - n, na,
+                                (*pp_stack) - 2*nk, nk);
+}
+
 static PyObject *
 update_keyword_args(PyObject *orig_kwdict, int nk, PyObject ***pp_stack,
                     PyObject *func)
@@ -5138,6 +5692,7 @@ string_concatenate(PyObject *v, PyObject *w,
          */
         switch (*next_instr) {
         case STORE_FAST:
+        case STORE_FAST_LOAD_FAST:
         {
             int oparg = PEEKARG();
             PyObject **fastlocals = f->f_localsplus;
@@ -5195,8 +5750,6 @@ string_concatenate(PyObject *v, PyObject *w,
     }
 }
 
-#ifdef DYNAMIC_EXECUTION_PROFILE
-
 static PyObject *
 getarray(long a[256])
 {
@@ -5219,14 +5772,15 @@ getarray(long a[256])
 PyObject *
 _Py_GetDXProfile(PyObject *self, PyObject *args)
 {
-#ifndef DXPAIRS
-    return getarray(dxp);
-#else
     int i;
-    PyObject *l = PyList_New(257);
+    PyObject *l;
+
+    if (dxpairs == NULL)
+        return getarray(dxp);
+    l = PyList_New(257);
     if (l == NULL) return NULL;
     for (i = 0; i < 257; i++) {
-        PyObject *x = getarray(dxpairs[i]);
+        PyObject *x = getarray(i < 256 ? dxpairs[i] : dxp);
         if (x == NULL) {
             Py_DECREF(l);
             return NULL;
@@ -5234,7 +5788,26 @@ _Py_GetDXProfile(PyObject *self, PyObject *args)
         PyList_SetItem(l, i, x);
     }
     return l;
-#endif
 }
 
-#endif
+PyObject *
+_Py_SetDXProfile(PyObject *self, PyObject *args)
+{
+    int on, pairs = 0;
+
+    if (!PyArg_ParseTuple(args, "i|i:setopcodeprofile", &on, &pairs))
+        return NULL;
+    if (on && pairs && dxpairs == NULL) {
+        dxpairs = (long (*)[256])PyMem_MALLOC(256 * sizeof(*dxpairs));
+        if (dxpairs == NULL)
+            return PyErr_NoMemory();
+        memset(dxpairs, 0, 256 * sizeof(*dxpairs));
+        dxp_lastopcode = 0;
+    }
+    else if (on && !pairs && dxpairs != NULL) {
+        PyMem_FREE(dxpairs);
+        dxpairs = NULL;
+    }
+    opcode_profiling = on != 0;
+    Py_RETURN_NONE;
+}
@@ -824,6 +824,8 @@ opcode_stack_effect(int opcode, int oparg)
             return 1;
         case LOAD_ATTR:
             return 0;
+        case LOAD_METHOD:
+            return 1;
         case COMPARE_OP:
             return -1;
         case IMPORT_NAME:
@@ -868,6 +870,8 @@ opcode_stack_effect(int opcode, int oparg)
             return -NARGS(oparg)-1;
         case CALL_FUNCTION_VAR_KW:
             return -NARGS(oparg)-2;
+        case CALL_METHOD:
+            return -oparg-1;
 #undef NARGS
         case MAKE_FUNCTION:
             return -oparg;
@@ -2558,6 +2562,23 @@ compiler_call(struct compiler *c, expr_ty e)
 {
     int n, code = 0;
 
+    /* obj.meth(args) with only positional arguments: LOAD_METHOD leaves
+       the function and obj on the stack, so that CALL_METHOD does not
+       need a bound method */
+    if (e->v.Call.func->kind == Attribute_kind &&
+        e->v.Call.func->v.Attribute.ctx == Load &&
+        asdl_seq_LEN(e->v.Call.keywords) == 0 &&
+        !e->v.Call.starargs && !e->v.Call.kwargs &&
+        asdl_seq_LEN(e->v.Call.args) < 255) {
+        expr_ty meth = e->v.Call.func;
+
+        VISIT(c, expr, meth->v.Attribute.value);
+        ADDOP_NAME(c, LOAD_METHOD, meth->v.Attribute.attr, names);
+        VISIT_SEQ(c, expr, e->v.Call.args);
+        ADDOP_I(c, CALL_METHOD, asdl_seq_LEN(e->v.Call.args));
+        return 1;
+    }
+
     VISIT(c, expr, e->v.Call.func);
     n = asdl_seq_LEN(e->v.Call.args);
     VISIT_SEQ(c, expr, e->v.Call.args);
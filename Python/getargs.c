@@ -1869,6 +1869,40 @@ PyArg_UnpackTuple(PyObject *args, const char *name, Py_ssize_t min, Py_ssize_t m
     return 1;
 }
 
+/* Like PyArg_UnpackTuple(), for the arguments of a METH_FASTCALL
+   function */
+int
+_PyArg_UnpackStack(PyObject **args, Py_ssize_t l, const char *name,
+                   Py_ssize_t min, Py_ssize_t max, ...)
+{
+    Py_ssize_t i;
+    PyObject **o;
+    va_list vargs;
+
+    assert(min >= 0);
+    assert(min <= max);
+    assert(name != NULL);
+    if (l < min || l > max) {
+        PyErr_Format(
+            PyExc_TypeError,
+            "%s expected %s%zd arguments, got %zd",
+            name, (min == max ? "" : l < min ? "at least " : "at most "),
+            l < min ? min : max, l);
+        return 0;
+    }
+#ifdef HAVE_STDARG_PROTOTYPES
+    va_start(vargs, max);
+#else
+    va_start(vargs);
+#endif
+    for (i = 0; i < l; i++) {
+        o = va_arg(vargs, PyObject **);
+        *o = args[i];
+    }
+    va_end(vargs);
+    return 1;
+}
+
 
 /* For type constructors that don't take keyword args
  *
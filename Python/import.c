@@ -77,9 +77,11 @@ typedef unsigned short mode_t;
        Python 2.7a0  62191 (introduce SETUP_WITH)
        Python 2.7a0  62201 (introduce BUILD_SET)
        Python 2.7a0  62211 (introduce MAP_ADD and SET_ADD)
+       Python 2.7a0  62221 (introduce LOAD_METHOD and CALL_METHOD)
+       Python 2.7a0  62231 (introduce superinstructions)
 .
 */
-#define MAGIC (62211 | ((long)'\r'<<16) | ((long)'\n'<<24))
+#define MAGIC (62231 | ((long)'\r'<<16) | ((long)'\n'<<24))
 
 /* Magic word as global; note that _PyImport_Init() can change the
    value of this global to accommodate for alterations of how the
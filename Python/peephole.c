@@ -273,6 +273,37 @@ markblocks(unsigned char *code, Py_ssize_t len)
     return blocks;
 }
 
+/* Return the superinstruction executing first and second in one go,
+   or 0 if there is none for the pair.  The pairs were picked from
+   opcode pair counts (see DXPAIRS in ceval.c). */
+static int
+superinstruction(int first, int second)
+{
+    switch (first) {
+        case LOAD_FAST:
+            switch (second) {
+                case LOAD_FAST: return LOAD_FAST_LOAD_FAST;
+                case LOAD_CONST: return LOAD_FAST_LOAD_CONST;
+                case LOAD_ATTR: return LOAD_FAST_LOAD_ATTR;
+                case LOAD_METHOD: return LOAD_FAST_LOAD_METHOD;
+            }
+            break;
+        case STORE_FAST:
+            if (second == LOAD_FAST)
+                return STORE_FAST_LOAD_FAST;
+            break;
+        case LOAD_CONST:
+            if (second == RETURN_VALUE)
+                return LOAD_CONST_RETURN_VALUE;
+            break;
+        case COMPARE_OP:
+            if (second == POP_JUMP_IF_FALSE)
+                return COMPARE_OP_POP_JUMP_IF_FALSE;
+            break;
+    }
+    return 0;
+}
+
 /* Perform basic peephole optimizations to components of a code object.
    The consts object should still be in list form to allow new constants
    to be appended.
@@ -641,6 +672,27 @@ PyCode_Optimize(PyObject *code, PyObject* consts, PyObject *names,
     }
     assert(h + nops == codelen);
 
+    /* Fuse instruction pairs into superinstructions.  Only the opcode of
+       the first instruction changes: the second one stays in place, so
+       jumps into it, the line number table and a frame's f_lasti remain
+       valid.  Pairs whose second half starts a line are left alone, so
+       that tracing sees every line. */
+    memset(blocks, 0, h*sizeof(int));
+    for (i=0, j=0 ; i < tabsiz ; i+=2) {
+        j += lineno[i];
+        if (lineno[i+1] && j < h)
+            blocks[j] = 1;
+    }
+    for (i=0 ; i+3 < h ; i += CODESIZE(codestr[i])) {
+        if (!HAS_ARG(codestr[i]) || blocks[i+3])
+            continue;
+        opcode = superinstruction(codestr[i], codestr[i+3]);
+        if (opcode) {
+            codestr[i] = opcode;
+            i += 3;
+        }
+    }
+
     code = PyString_FromStringAndSize((char *)codestr, h);
     PyMem_Free(addrmap);
     PyMem_Free(codestr);
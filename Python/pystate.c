@@ -205,6 +205,8 @@ new_threadstate(PyInterpreterState *interp, int init)
         tstate->c_tracefunc = NULL;
         tstate->c_profileobj = NULL;
         tstate->c_traceobj = NULL;
+
+        _PyFrame_InitPool(tstate);
 #ifdef STACKLESS
         STACKLESS_PYSTATE_NEW;
 #endif
@@ -244,6 +246,8 @@ _PyThreadState_Init(PyThreadState *tstate)
 void
 PyThreadState_Clear(PyThreadState *tstate)
 {
+    /* frames freed by the thread from now on are not kept */
+    tstate->frame_pool.fp_limit = 0;
 #ifdef STACKLESS
     STACKLESS_PYSTATE_CLEAR;
 #endif
@@ -268,6 +272,8 @@ PyThreadState_Clear(PyThreadState *tstate)
     tstate->c_tracefunc = NULL;
     Py_CLEAR(tstate->c_profileobj);
     Py_CLEAR(tstate->c_traceobj);
+
+    (void)_PyFrame_ClearPool(tstate);
 }
 
 
@@ -424,6 +424,9 @@ Py_Finalize(void)
     call_sys_exitfunc();
 #ifdef STACKLESS
     PyStackless_kill_tasks_with_stacks(1);
+#ifdef WITH_THREAD
+    slp_pool_fini();
+#endif
 #endif
     initialized = 0;
 
@@ -474,7 +474,7 @@ PyDoc_STRVAR(setcheckinterval_doc,
 "setcheckinterval(n)\n\
 \n\
 Tell the Python interpreter to check for asynchronous events every\n\
-n instructions.  This also affects how often thread switches occur."
+n instructions.  Thread switches are controlled by setswitchinterval()."
 );
 
 static PyObject *
@@ -487,6 +487,50 @@ PyDoc_STRVAR(getcheckinterval_doc,
 "getcheckinterval() -> current check interval; see setcheckinterval()."
 );
 
+#ifdef WITH_THREAD
+static PyObject *
+sys_setswitchinterval(PyObject *self, PyObject *args)
+{
+    double d;
+
+    if (!PyArg_ParseTuple(args, "d:setswitchinterval", &d))
+        return NULL;
+    if (!(d > 0.0)) {
+        PyErr_SetString(PyExc_ValueError,
+                        "switch interval must be strictly positive");
+        return NULL;
+    }
+    if (d * 1e6 >= (double)LONG_MAX) {
+        PyErr_SetString(PyExc_OverflowError,
+                        "switch interval too large");
+        return NULL;
+    }
+    _PyEval_SetSwitchInterval(d * 1e6 < 1.0 ? 1 : (long)(d * 1e6));
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+PyDoc_STRVAR(setswitchinterval_doc,
+"setswitchinterval(n)\n\
+\n\
+Set the ideal thread switching delay inside the Python interpreter.\n\
+A thread waiting for the interpreter lock longer than n seconds asks\n\
+the running thread to let go of it at its next check (see\n\
+setcheckinterval()).  The actual switch may take longer, e.g. while\n\
+a C function runs."
+);
+
+static PyObject *
+sys_getswitchinterval(PyObject *self, PyObject *args)
+{
+    return PyFloat_FromDouble(1e-6 * _PyEval_GetSwitchInterval());
+}
+
+PyDoc_STRVAR(getswitchinterval_doc,
+"getswitchinterval() -> current thread switch interval; see setswitchinterval()."
+);
+#endif
+
 #ifdef WITH_TSC
 static PyObject *
 sys_settscdump(PyObject *self, PyObject *args)
@@ -553,6 +597,50 @@ of the Python interpreter stack.  This limit prevents infinite\n\
 recursion from causing an overflow of the C stack and crashing Python."
 );
 
+static PyObject *
+sys_setframepoollimit(PyObject *self, PyObject *args)
+{
+    int new_limit;
+    if (!PyArg_ParseTuple(args, "i:setframepoollimit", &new_limit))
+        return NULL;
+    if (new_limit < 0) {
+        PyErr_SetString(PyExc_ValueError,
+                        "frame pool limit must not be negative");
+        return NULL;
+    }
+    _PyFrame_SetPoolLimit(new_limit);
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+PyDoc_STRVAR(setframepoollimit_doc,
+"setframepoollimit(n)\n\
+\n\
+Set the number of free frames which the current thread, and threads\n\
+started later, keep for reuse.  Frames beyond the new limit are freed."
+);
+
+static PyObject *
+sys_getframepoolstats(PyObject *self)
+{
+    PyFramePool *pool = &PyThreadState_GET()->frame_pool;
+    return Py_BuildValue("{sisislslsl}",
+                         "limit", pool->fp_limit,
+                         "count", pool->fp_count,
+                         "hits", pool->fp_hits,
+                         "misses", pool->fp_misses,
+                         "released", pool->fp_released);
+}
+
+PyDoc_STRVAR(getframepoolstats_doc,
+"getframepoolstats() -> dict\n\
+\n\
+Return the statistics of the frame pool of the current thread: its\n\
+limit, the number of free frames it holds, the number of frames taken\n\
+from it (hits) and allocated anew (misses), and the number of frames\n\
+freed because it was full (released)."
+);
+
 #ifdef MS_WINDOWS
 PyDoc_STRVAR(getwindowsversion_doc,
 "getwindowsversion()\n\
@@ -881,10 +969,24 @@ extern "C" {
 extern PyObject *_Py_GetObjects(PyObject *, PyObject *);
 #endif
 
-#ifdef DYNAMIC_EXECUTION_PROFILE
-/* Defined in ceval.c because it uses static globals if that file */
+/* Defined in ceval.c because they use static globals of that file */
 extern PyObject *_Py_GetDXProfile(PyObject *,  PyObject *);
-#endif
+extern PyObject *_Py_SetDXProfile(PyObject *,  PyObject *);
+
+PyDoc_STRVAR(setopcodeprofile_doc,
+"setopcodeprofile(on[, pairs])\n\
+\n\
+Start or stop counting the executed opcodes, and with pairs true\n\
+the executed pairs of opcodes as well.  See getopcodeprofile()."
+);
+
+PyDoc_STRVAR(getopcodeprofile_doc,
+"getopcodeprofile() -> list\n\
+\n\
+Return the opcode counts collected since the last call, by opcode.\n\
+When opcode pairs are counted, return a list of 257 such lists instead:\n\
+the pair counts by their first opcode, followed by the opcode counts."
+);
 
 #ifdef __cplusplus
 }
@@ -926,16 +1028,17 @@ static PyMethodDef sys_methods[] = {
 #ifdef COUNT_ALLOCS
     {"getcounts",       (PyCFunction)sys_getcounts, METH_NOARGS},
 #endif
-#ifdef DYNAMIC_EXECUTION_PROFILE
-    {"getdxp",          _Py_GetDXProfile, METH_VARARGS},
-#endif
 #ifdef Py_USING_UNICODE
     {"getfilesystemencoding", (PyCFunction)sys_getfilesystemencoding,
      METH_NOARGS, getfilesystemencoding_doc},
 #endif
+    {"getframepoolstats", (PyCFunction)sys_getframepoolstats, METH_NOARGS,
+     getframepoolstats_doc},
 #ifdef Py_TRACE_REFS
     {"getobjects",      _Py_GetObjects, METH_VARARGS},
 #endif
+    {"getopcodeprofile", _Py_GetDXProfile, METH_NOARGS,
+     getopcodeprofile_doc},
 #ifdef Py_REF_DEBUG
     {"gettotalrefcount", (PyCFunction)sys_gettotalrefcount, METH_NOARGS},
 #endif
@@ -960,10 +1063,20 @@ static PyMethodDef sys_methods[] = {
      setcheckinterval_doc},
     {"getcheckinterval",        sys_getcheckinterval, METH_NOARGS,
      getcheckinterval_doc},
+#ifdef WITH_THREAD
+    {"setswitchinterval",       sys_setswitchinterval, METH_VARARGS,
+     setswitchinterval_doc},
+    {"getswitchinterval",       sys_getswitchinterval, METH_NOARGS,
+     getswitchinterval_doc},
+#endif
 #ifdef HAVE_DLOPEN
     {"setdlopenflags", sys_setdlopenflags, METH_VARARGS,
      setdlopenflags_doc},
 #endif
+    {"setframepoollimit", sys_setframepoollimit, METH_VARARGS,
+     setframepoollimit_doc},
+    {"setopcodeprofile", _Py_SetDXProfile, METH_VARARGS,
+     setopcodeprofile_doc},
     {"setprofile",      sys_setprofile, METH_O, setprofile_doc},
     {"getprofile",      sys_getprofile, METH_NOARGS, getprofile_doc},
     {"setrecursionlimit", sys_setrecursionlimit, METH_VARARGS,
@@ -1125,15 +1238,21 @@ exc_info() -- return thread-safe information about the current exception\n\
 exc_clear() -- clear the exception state for the current thread\n\
 exit() -- exit the interpreter by raising SystemExit\n\
 getdlopenflags() -- returns flags to be used for dlopen() calls\n\
+getframepoolstats() -- return the frame pool statistics of the thread\n\
+getopcodeprofile() -- return and reset the opcode execution counts\n\
 getprofile() -- get the global profiling function\n\
 getrefcount() -- return the reference count for an object (plus one :-)\n\
 getrecursionlimit() -- return the max recursion depth for the interpreter\n\
 getsizeof() -- return the size of an object in bytes\n\
+getswitchinterval() -- return the thread switch interval in seconds\n\
 gettrace() -- get the global debug tracing function\n\
 setcheckinterval() -- control how often the interpreter checks for events\n\
 setdlopenflags() -- set the flags to be used for dlopen() calls\n\
+setframepoollimit() -- set the number of free frames a thread keeps\n\
+setopcodeprofile() -- start or stop counting the executed opcodes\n\
 setprofile() -- set the global profiling function\n\
 setrecursionlimit() -- set the max recursion depth for the interpreter\n\
+setswitchinterval() -- control how often the interpreter switches threads\n\
 settrace() -- set the global debug tracing function\n\
 "
 )
@@ -173,6 +173,55 @@ PyThread_set_stacksize(size_t size)
 #endif
 }
 
+#ifndef Py_HAVE_NATIVE_GIL
+/* If the platform has not supplied an interpreter lock with switch
+   requests, build one on an ordinary lock.  A thread finding the lock
+   taken asks for a drop right away; which thread gets the lock after the
+   drop is left to the platform. */
+
+typedef struct {
+    PyThread_type_lock lock;
+    volatile int *drop_request;
+    volatile int *ticker;
+} lock_gil;
+
+PyThread_type_gil
+PyThread_allocate_gil(volatile int *drop_request, volatile int *ticker)
+{
+    lock_gil *gil = (lock_gil *)malloc(sizeof(lock_gil));
+
+    if (gil == NULL)
+        return NULL;
+    gil->lock = PyThread_allocate_lock();
+    if (gil->lock == NULL) {
+        free(gil);
+        return NULL;
+    }
+    gil->drop_request = drop_request;
+    gil->ticker = ticker;
+    return (PyThread_type_gil)gil;
+}
+
+void
+PyThread_take_gil(PyThread_type_gil g, long interval)
+{
+    lock_gil *gil = (lock_gil *)g;
+
+    if (!PyThread_acquire_lock(gil->lock, NOWAIT_LOCK)) {
+        *gil->drop_request = 1;
+        *gil->ticker = 0;
+        PyThread_acquire_lock(gil->lock, WAIT_LOCK);
+    }
+    *gil->drop_request = 0;
+}
+
+void
+PyThread_drop_gil(PyThread_type_gil g, int forced)
+{
+    PyThread_release_lock(((lock_gil *)g)->lock);
+}
+#endif /* Py_HAVE_NATIVE_GIL */
+
 #ifndef Py_HAVE_NATIVE_TLS
 /* If the platform has not supplied a platform specific
    TLS implementation, provide our own.
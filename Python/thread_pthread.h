@@ -447,6 +447,165 @@ PyThread_release_lock(PyThread_type_lock lock)
 
 #endif /* USE_SEMAPHORES */
 
+/*
+ * Interpreter lock support.
+ *
+ * The interpreter lock is a "locked?" bit guarded by a <condition, mutex>
+ * pair, like the emulated lock above, but a waiting thread uses a timed
+ * wait.  If the lock did not change hands during a whole interval, the
+ * waiter sets *drop_request and zeroes *ticker, and the eval loop lets go
+ * of the lock at its next instruction.  Such
+ * a forced drop then waits on a second pair until another thread took
+ * the lock, so that a CPU bound thread cannot grab it right back before
+ * the waiter was even scheduled.
+ */
+
+typedef struct {
+    char             locked;        /* 0=unlocked, 1=locked */
+    unsigned long    switch_number; /* incremented whenever taken */
+    long             last_holder;   /* ident of the thread that took it */
+    volatile int    *drop_request;
+    volatile int    *ticker;
+    /* a <cond, mutex> pair to handle a take of a locked lock */
+    pthread_cond_t   released;
+    pthread_mutex_t  mut;
+    /* a <cond, mutex> pair to wait for another thread taking the lock */
+    pthread_cond_t   switched;
+    pthread_mutex_t  switch_mut;
+} pthread_gil;
+
+#define Py_HAVE_NATIVE_GIL
+
+PyThread_type_gil
+PyThread_allocate_gil(volatile int *drop_request, volatile int *ticker)
+{
+    pthread_gil *gil;
+    int status, error = 0;
+
+    dprintf(("PyThread_allocate_gil called\n"));
+    if (!initialized)
+        PyThread_init_thread();
+
+    gil = (pthread_gil *) malloc(sizeof(pthread_gil));
+    if (gil) {
+        memset((void *)gil, '\0', sizeof(pthread_gil));
+        gil->drop_request = drop_request;
+        gil->ticker = ticker;
+
+        status = pthread_mutex_init(&gil->mut,
+                                    pthread_mutexattr_default);
+        CHECK_STATUS("pthread_mutex_init");
+        status = pthread_cond_init(&gil->released,
+                                   pthread_condattr_default);
+        CHECK_STATUS("pthread_cond_init");
+        status = pthread_mutex_init(&gil->switch_mut,
+                                    pthread_mutexattr_default);
+        CHECK_STATUS("pthread_mutex_init");
+        status = pthread_cond_init(&gil->switched,
+                                   pthread_condattr_default);
+        CHECK_STATUS("pthread_cond_init");
+
+        if (error) {
+            free((void *)gil);
+            gil = 0;
+        }
+    }
+
+    dprintf(("PyThread_allocate_gil() -> %p\n", gil));
+    return (PyThread_type_gil) gil;
+}
+
+void
+PyThread_take_gil(PyThread_type_gil g, long interval)
+{
+    pthread_gil *gil = (pthread_gil *)g;
+    struct timeval now;
+    struct timespec deadline;
+    unsigned long switch_number;
+    long usec;
+    int status, error = 0;
+
+    dprintf(("PyThread_take_gil(%p, %ld) called\n", g, interval));
+
+    status = pthread_mutex_lock( &gil->mut );
+    CHECK_STATUS("pthread_mutex_lock[4]");
+
+    while (gil->locked) {
+        switch_number = gil->switch_number;
+#ifdef GETTIMEOFDAY_NO_TZ
+        gettimeofday(&now);
+#else
+        gettimeofday(&now, (struct timezone *)NULL);
+#endif
+        usec = now.tv_usec + interval % 1000000;
+        deadline.tv_sec = now.tv_sec + interval / 1000000 + usec / 1000000;
+        deadline.tv_nsec = (usec % 1000000) * 1000;
+
+        status = pthread_cond_timedwait(&gil->released, &gil->mut,
+                                        &deadline);
+        if (status == ETIMEDOUT) {
+            /* the holder kept the lock for a whole interval */
+            if (gil->locked && gil->switch_number == switch_number) {
+                *gil->drop_request = 1;
+                *gil->ticker = 0;
+            }
+        }
+        else {
+            CHECK_STATUS("pthread_cond_timedwait");
+        }
+    }
+
+    /* tell a thread in a forced drop that the lock changed hands */
+    status = pthread_mutex_lock( &gil->switch_mut );
+    CHECK_STATUS("pthread_mutex_lock[5]");
+    gil->locked = 1;
+    gil->switch_number++;
+    gil->last_holder = PyThread_get_thread_ident();
+    status = pthread_cond_signal( &gil->switched );
+    CHECK_STATUS("pthread_cond_signal");
+    status = pthread_mutex_unlock( &gil->switch_mut );
+    CHECK_STATUS("pthread_mutex_unlock[5]");
+
+    *gil->drop_request = 0;
+
+    status = pthread_mutex_unlock( &gil->mut );
+    CHECK_STATUS("pthread_mutex_unlock[4]");
+}
+
+void
+PyThread_drop_gil(PyThread_type_gil g, int forced)
+{
+    pthread_gil *gil = (pthread_gil *)g;
+    long self;
+    int status, error = 0;
+
+    dprintf(("PyThread_drop_gil(%p, %d) called\n", g, forced));
+
+    status = pthread_mutex_lock( &gil->mut );
+    CHECK_STATUS("pthread_mutex_lock[6]");
+
+    gil->locked = 0;
+
+    status = pthread_mutex_unlock( &gil->mut );
+    CHECK_STATUS("pthread_mutex_unlock[6]");
+
+    status = pthread_cond_signal( &gil->released );
+    CHECK_STATUS("pthread_cond_signal");
+
+    if (forced) {
+        /* a thread asked for the lock and still waits for it */
+        self = PyThread_get_thread_ident();
+        status = pthread_mutex_lock( &gil->switch_mut );
+        CHECK_STATUS("pthread_mutex_lock[7]");
+        while (gil->last_holder == self) {
+            status = pthread_cond_wait(&gil->switched, &gil->switch_mut);
+            CHECK_STATUS("pthread_cond_wait");
+        }
+        status = pthread_mutex_unlock( &gil->switch_mut );
+        CHECK_STATUS("pthread_mutex_unlock[7]");
+    }
+}
+
 /* set the thread stack size.
  * Return 0 if size is valid, -1 if size is invalid,
  * -2 if setting stack size is not supported.
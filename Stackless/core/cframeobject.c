@@ -233,6 +233,16 @@ exit_run_cframe:
 
 DEF_INVALID_EXEC(run_cframe)
 
+/* the cframe of a tasklet function that has not been called, yet */
+
+int
+slp_cframe_is_unstarted(PyFrameObject *f)
+{
+    return PyCFrame_Check(f) &&
+           ((PyCFrameObject *) f)->f_execute == run_cframe &&
+           ((PyCFrameObject *) f)->i == 0;
+}
+
 PyCFrameObject *
 slp_cframe_newfunc(PyObject *func, PyObject *args, PyObject *kwds, unsigned int linked)
 {
@@ -347,6 +347,26 @@ PyAPI_DATA(PyTypeObject) PyMethodWrapper_Type;
     (__task)->__next = (__task)->__prev = NULL; \
 }
 
+/* operations on the rings of registries, see PySlpLink */
+
+#define SLP_LINK_INSERT(__head, __link) \
+{ \
+    (__link)->prev = (__head)->prev; \
+    (__link)->next = (__head); \
+    (__head)->prev->next = (__link); \
+    (__head)->prev = (__link); \
+}
+
+#define SLP_LINK_REMOVE(__link) \
+{ \
+    (__link)->next->prev = (__link)->prev; \
+    (__link)->prev->next = (__link)->next; \
+    (__link)->next = (__link)->prev = NULL; \
+}
+
+#define SLP_LINK_OBJECT(__link, __objtype, __field) \
+    ((__objtype *) ((char *) (__link) - offsetof(__objtype, __field)))
+
 /* operations on chains */
 
 PyAPI_FUNC(void) slp_current_insert(PyTaskletObject *task);
@@ -361,6 +381,27 @@ PyAPI_FUNC(PyTaskletObject *) slp_channel_remove_specific(
                                     int dir, PyTaskletObject *task);
 PyAPI_FUNC(PyTaskletObject *) slp_channel_remove_slow(PyTaskletObject *task);
 
+/* registries of alive tasklets and of channels with waiters */
+
+PyAPI_DATA(PySlpLink) slp_waiting_channels;
+
+PyAPI_FUNC(void) slp_tasklet_register(PyTaskletObject *task);
+PyAPI_FUNC(void) slp_tasklet_unregister(PyTaskletObject *task);
+
+/* keeping dormant tasklets out of garbage collections */
+
+PyAPI_FUNC(int) slp_tasklet_freeze(PyTaskletObject *task);
+PyAPI_FUNC(void) slp_tasklet_thaw(PyTaskletObject *task);
+
+/* channel timeouts */
+
+PyAPI_DATA(PyObject *) slp_timeout_error;
+
+PyAPI_FUNC(int) slp_timer_add(PyTaskletObject *task, PyChannelObject *channel,
+                              double deadline);
+PyAPI_FUNC(void) slp_timer_remove(PyTaskletObject *task);
+PyAPI_FUNC(int) slp_timer_expire(PyThreadState *ts);
+
 /* recording the main thread state */
 
 PyAPI_DATA(PyThreadState *) slp_initial_tstate;
@@ -379,6 +420,23 @@ PyAPI_FUNC(PyObject *) slp_schedule_task(PyTaskletObject *prev,
                                          int stackless,
                                          int *did_switch);
 
+/* make a tasklet runnable from any thread, waking up its own thread */
+PyAPI_FUNC(void) slp_schedule_wakeup(PyTaskletObject *task);
+
+/* tasklet groups */
+
+PyAPI_FUNC(int) init_taskletgrouptype(void);
+PyAPI_FUNC(void) slp_taskletgroup_leave(PyTaskletObject *task);
+PyAPI_FUNC(int) slp_tasklet_drop(PyTaskletObject *task);
+
+/* tasklet-local data */
+
+PyAPI_FUNC(int) init_taskletlocaltype(void);
+PyAPI_FUNC(PyObject *) slp_tasklet_locals(PyTaskletObject *task);
+PyAPI_FUNC(int) slp_tasklet_set_locals(PyTaskletObject *task,
+                                       PyObject *pairs);
+PyAPI_FUNC(void) slp_tasklet_clear_locals(PyTaskletObject *task);
+
 PyAPI_FUNC(int) initialize_main_and_current(void);
 
 /* setting the tasklet's tempval, optimized for no change */
@@ -437,6 +495,37 @@ PyAPI_FUNC(PyObject *) slp_runtime_error(const char *msg);
 PyAPI_FUNC(PyObject *) slp_value_error(const char *msg);
 PyAPI_FUNC(PyObject *) slp_null_error(void);
 
+/* wall clock time in seconds, and sleeping. Call slp_sleep without the GIL */
+
+PyAPI_FUNC(double) slp_clock(void);
+PyAPI_FUNC(void) slp_sleep(double secs);
+
+/* tasklet memory accounting, see obmalloc.c */
+
+PyAPI_DATA(PySlpMemAccount) slp_memaccounts;
+PyAPI_FUNC(int) slp_memaccount_enabled(void);
+PyAPI_FUNC(void) slp_memaccount_release(PyTaskletObject *task);
+
+#ifdef WITH_THREAD
+
+/* the sampling profiler */
+
+PyAPI_FUNC(PyObject *) slp_sampler_start(PyObject *self, PyObject *args,
+                                         PyObject *kwds);
+PyAPI_FUNC(PyObject *) slp_sampler_stop(PyObject *self);
+PyAPI_FUNC(PyObject *) slp_sampler_collapsed(PyObject *self, PyObject *args,
+                                             PyObject *kwds);
+PyAPI_DATA(char) slp_sampler_start__doc__[];
+PyAPI_DATA(char) slp_sampler_stop__doc__[];
+PyAPI_DATA(char) slp_sampler_collapsed__doc__[];
+
+/* the thread pool of call_in_pool */
+
+PyAPI_FUNC(void) slp_pool_after_fork(void);
+PyAPI_FUNC(void) slp_pool_fini(void);
+
+#endif
+
 /* this seems to be needed for gcc */
 
 /* Define NULL pointer value */
@@ -458,6 +547,7 @@ PyAPI_FUNC(PyCFrameObject *) slp_cframe_newfunc(PyObject *func,
                                                 PyObject *args,
                                                 PyObject *kwds,
                                                 unsigned int linked);
+PyAPI_FUNC(int) slp_cframe_is_unstarted(PyFrameObject *f);
 
 PyAPI_FUNC(PyFrameObject *) slp_get_frame(PyTaskletObject *task);
 PyAPI_FUNC(void) slp_check_pending_irq(void);
@@ -40,6 +40,10 @@ extern "C" {
     pending_irq:    If set, an interrupt was issued during an atomic
                     operation, and should be handled when possible.
 
+    frozen:         The tasklet and its frames have been moved to the
+                    permanent generation of the garbage collector.
+                    Cleared when the tasklet is scheduled again.
+
 
     Policy for atomic/autoschedule and switching:
     ---------------------------------------------
@@ -70,9 +74,25 @@ typedef struct _tasklet_flags {
     unsigned int block_trap: 1;
     unsigned int is_zombie: 1;
     unsigned int pending_irq: 1;
+    unsigned int frozen: 1;
 } PyTaskletFlagStruc;
 
 
+/*
+ * The memory account of a tasklet, charged by the object allocator
+ * if PYTHONTASKLETMEMORY is set. An account lives until the tasklet
+ * is gone and all of its blocks are freed. All accounts of the
+ * process form a ring, see slp_memaccounts.
+ */
+
+typedef struct _slp_memaccount {
+    struct _slp_memaccount *next;
+    struct _slp_memaccount *prev;
+    struct _tasklet *task;      /* NULL when the tasklet is gone */
+    Py_ssize_t live;            /* bytes in use */
+    Py_ssize_t peak;            /* maximum of live */
+} PySlpMemAccount;
+
 typedef struct _tasklet {
     PyObject_HEAD
     struct _tasklet *next;
@@ -88,6 +108,20 @@ typedef struct _tasklet {
     struct _cstack *cstate;
     PyObject *def_globals;
     PyObject *tsk_weakreflist;
+    /* 1-based position in the thread's timer heap, 0 if no timeout */
+    int timer_slot;
+    /* the tasklet group, and our position in its member list */
+    struct _taskletgroup *group;
+    Py_ssize_t group_slot;
+    /* the memory account, created on the first allocation */
+    struct _slp_memaccount *memaccount;
+    /* the dicts of the tasklet-locals, indexed by their slot */
+    struct _tasklet_local_slot *locals;
+    Py_ssize_t nlocals;
+    /* our link in the ring of alive tasklets of the thread */
+    PySlpLink alive;
+    /* our label in the sampling profiler, 0 until first sampled */
+    long sample_id;
 } PyTaskletObject;
 
 
@@ -161,9 +195,68 @@ typedef struct _channel {
     int balance;
     struct _channel_flags flags;
     PyObject *chan_weakreflist;
+    /* our link in slp_waiting_channels while the balance is not zero */
+    PySlpLink waiting;
 } PyChannelObject;
 
 
+/*** important structures: timer ***/
+
+/***************************************************************************
+
+    Channel Timeouts
+    ----------------
+
+    A tasklet that blocks on a channel with a timeout gets an entry in
+    the timer heap of its thread state. The heap is ordered by deadline,
+    so the scheduler only has to look at the top entry to find out whether
+    anything has expired.
+    When the tasklet leaves the channel for whatever reason, the entry is
+    removed again. On expiry, the tasklet is taken off the channel and
+    made runnable with a bomb holding stackless.TimeoutError.
+
+ ***************************************************************************/
+
+typedef struct _slp_timer {
+    double deadline;
+    struct _tasklet *task;
+    struct _channel *channel;
+} PySlpTimer;
+
+
+/*** important structures: tasklet group ***/
+
+typedef struct _taskletgroup {
+    PyObject_HEAD
+    PyObject *members;          /* list of live tasklets */
+    struct _channel *joiners;   /* tasklets waiting in join() */
+    PyObject *grp_weakreflist;
+} PyTaskletGroupObject;
+
+
+/*** important structures: tasklet-local data ***/
+
+/*
+ * Every local object owns a slot number. A tasklet keeps the dict
+ * for a local at that index. Slot numbers are reused, so the dict
+ * is only valid if the serial matches the one of the local.
+ */
+
+typedef struct _tasklet_local_slot {
+    PyObject *dict;
+    long serial;
+} PyTaskletLocalSlot;
+
+typedef struct _taskletlocal {
+    PyObject_HEAD
+    Py_ssize_t slot;
+    long serial;
+    PyObject *args;
+    PyObject *kw;
+    PyObject *dict;             /* set during attribute access only */
+} PyTaskletLocalObject;
+
+
 /*** important stuctures: cframe ***/
 
 typedef struct _cframe {
@@ -210,6 +303,12 @@ PyAPI_DATA(PyTypeObject) PyCStack_Type;
 PyAPI_DATA(PyTypeObject) PyBomb_Type;
 #define PyBomb_Check(op) ((op)->ob_type == &PyBomb_Type)
 
+PyAPI_DATA(PyTypeObject) PyTaskletGroup_Type;
+#define PyTaskletGroup_Check(op) PyObject_TypeCheck(op, &PyTaskletGroup_Type)
+
+PyAPI_DATA(PyTypeObject) PyTaskletLocal_Type;
+#define PyTaskletLocal_Check(op) PyObject_TypeCheck(op, &PyTaskletLocal_Type)
+
 PyAPI_DATA(PyTypeObject*) PyTasklet_TypePtr;
 #define PyTasklet_Type (*PyTasklet_TypePtr)
 #define PyTasklet_Check(op) PyObject_TypeCheck(op, PyTasklet_TypePtr)
@@ -1,5 +1,16 @@
 /*** addition to tstate ***/
 
+/*
+ * A link of an intrusive ring. Registries use it for objects which
+ * must be found without walking the heap. The head of a ring is a
+ * link of its own, an unlinked object has NULL pointers.
+ */
+
+typedef struct _slp_link {
+    struct _slp_link *next;
+    struct _slp_link *prev;
+} PySlpLink;
+
 typedef struct _sts {
     /* the blueprint for new stacks */
     struct _cstack *initial_stub;
@@ -25,6 +36,8 @@ typedef struct _sts {
     /* runnable tasklets */
     struct _tasklet *current;
     int runcount;
+    /* the ring of alive tasklets, see slp_tasklet_register */
+    PySlpLink alive;
 
     /* scheduling */
     long ticker;
@@ -37,11 +50,18 @@ typedef struct _sts {
     struct {
         PyObject *block_lock;                   /* to block the thread */
         int is_blocked;
+        int is_idle;                            /* a pool worker without work */
     } thread;
 #endif
     /* number of nested interpreters (1.0/2.0 merge) */
     int nesting_level;
     PyObject *del_post_switch;                  /* To decref after a switch */
+    /* channel timeouts, a binary heap ordered by deadline */
+    struct {
+        struct _slp_timer *heap;
+        int count;
+        int size;
+    } timers;
 } PyStacklessState;
 
 /* internal macro to temporarily disable soft interrupts */
@@ -61,9 +81,13 @@ typedef struct _sts {
     tstate->st.main = NULL; \
     tstate->st.current = NULL; \
     tstate->st.runcount = 0; \
+    tstate->st.alive.next = tstate->st.alive.prev = &tstate->st.alive; \
     tstate->st.nesting_level = 0; \
     tstate->st.runflags = 0; \
-    tstate->st.del_post_switch = NULL;
+    tstate->st.del_post_switch = NULL; \
+    tstate->st.timers.heap = NULL; \
+    tstate->st.timers.count = 0; \
+    tstate->st.timers.size = 0;
 
 /* note that the scheduler knows how to zap. It checks if it is in charge
    for this tstate and then clears everything. This will not work if
@@ -73,23 +97,30 @@ typedef struct _sts {
 struct _ts; /* Forward */
 
 void slp_kill_tasks_with_stacks(struct _ts *tstate);
+void slp_tasklet_unregister_all(struct _ts *tstate);
 
 #define __STACKLESS_PYSTATE_CLEAR \
     slp_kill_tasks_with_stacks(tstate); \
-    Py_CLEAR(tstate->st.initial_stub);
+    slp_tasklet_unregister_all(tstate); \
+    Py_CLEAR(tstate->st.initial_stub); \
+    PyMem_FREE(tstate->st.timers.heap); \
+    tstate->st.timers.heap = NULL; \
+    tstate->st.timers.count = tstate->st.timers.size = 0;
 
 #ifdef WITH_THREAD
 
 #define STACKLESS_PYSTATE_NEW \
     __STACKLESS_PYSTATE_NEW \
     tstate->st.thread.block_lock = NULL; \
-    tstate->st.thread.is_blocked = 0;
+    tstate->st.thread.is_blocked = 0; \
+    tstate->st.thread.is_idle = 0;
 
 
 #define STACKLESS_PYSTATE_CLEAR \
     __STACKLESS_PYSTATE_CLEAR \
     Py_CLEAR(tstate->st.thread.block_lock); \
-    tstate->st.thread.is_blocked = 0;
+    tstate->st.thread.is_blocked = 0; \
+    tstate->st.thread.is_idle = 0;
 
 #else
 
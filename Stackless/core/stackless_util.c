@@ -3,6 +3,10 @@
 #ifdef STACKLESS
 #include "stackless_impl.h"
 
+#ifdef MS_WINDOWS
+#include <windows.h>
+#endif
+
 /* backward compatibility */
 #ifndef Py_TYPE
 #define Py_TYPE(ob)     (ob->ob_type)
@@ -41,6 +45,80 @@ slp_null_error(void)
 }
 
 
+/* Time measurement, modelled after floattime/floatsleep in timemodule.c.
+   The deadlines of the timers must not move with the wall clock, so
+   a monotonic clock is preferred. */
+
+#ifndef MS_WINDOWS
+static double
+slp_wallclock(void)
+{
+#if defined(HAVE_GETTIMEOFDAY)
+    struct timeval t;
+#ifdef GETTIMEOFDAY_NO_TZ
+    gettimeofday(&t);
+#else
+    gettimeofday(&t, (struct timezone *)NULL);
+#endif
+    return (double)t.tv_sec + t.tv_usec*0.000001;
+#else
+    return (double) time(NULL);
+#endif
+}
+#endif
+
+double
+slp_clock(void)
+{
+#ifdef MS_WINDOWS
+    /* GetTickCount() wraps after 49 days */
+    static double divisor = 0.0;
+    LARGE_INTEGER now;
+
+    if (divisor == 0.0) {
+        LARGE_INTEGER freq;
+
+        if (!QueryPerformanceFrequency(&freq) || freq.QuadPart == 0)
+            divisor = -1.0;
+        else
+            divisor = (double) freq.QuadPart;
+    }
+    if (divisor > 0.0 && QueryPerformanceCounter(&now))
+        return (double) now.QuadPart / divisor;
+    return (double) GetTickCount() * 0.001;
+#else
+#if defined(_POSIX_MONOTONIC_CLOCK) && defined(CLOCK_MONOTONIC)
+    struct timespec ts;
+
+    if (clock_gettime(CLOCK_MONOTONIC, &ts) == 0)
+        return (double)ts.tv_sec + ts.tv_nsec*0.000000001;
+#endif
+    return slp_wallclock();
+#endif
+}
+
+
+void
+slp_sleep(double secs)
+{
+    if (secs <= 0.0)
+        return;
+#ifdef MS_WINDOWS
+    Sleep((DWORD) (secs * 1000.0));
+#elif defined(HAVE_SELECT)
+    {
+        struct timeval t;
+        double frac = fmod(secs, 1.0);
+
+        t.tv_sec = (long) (secs - frac);
+        t.tv_usec = (long) (frac * 1000000.0);
+        select(0, (fd_set *)0, (fd_set *)0, (fd_set *)0, &t);
+    }
+#else
+    sleep((int) secs);
+#endif
+}
+
 /* CAUTION: This function returns a borrowed reference */
 PyFrameObject *
 slp_get_frame(PyTaskletObject *task)
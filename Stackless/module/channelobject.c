@@ -11,6 +11,12 @@
 #include "channelobject.h"
 
 
+/* the ring of channels which have tasklets waiting on them */
+
+PySlpLink slp_waiting_channels = {
+    &slp_waiting_channels, &slp_waiting_channels
+};
+
 static void
 channel_clear(PyObject *ob)
 {
@@ -41,6 +47,7 @@ channel_dealloc(PyObject *ob)
             return;
         }
     }
+    assert(ch->waiting.next == NULL);
     if (ch->chan_weakreflist != NULL)
         PyObject_ClearWeakRefs((PyObject *)ch);
     ob->ob_type->tp_free(ob);
@@ -60,6 +67,8 @@ void
 slp_channel_insert(PyChannelObject *channel, PyTaskletObject *task, int dir)
 {
     SLP_HEADCHAIN_INSERT(PyTaskletObject, channel, task, next, prev);
+    if (channel->balance == 0)
+        SLP_LINK_INSERT(&slp_waiting_channels, &channel->waiting);
     channel->balance += dir;
     task->flags.blocked = dir;
 }
@@ -72,8 +81,12 @@ slp_channel_remove(PyChannelObject *channel, int dir)
     assert(PyTasklet_Check(ret));
 
     channel->balance -= dir;
+    if (channel->balance == 0)
+        SLP_LINK_REMOVE(&channel->waiting);
     SLP_HEADCHAIN_REMOVE(ret, next, prev);
     ret->flags.blocked = 0;
+    if (ret->timer_slot)
+        slp_timer_remove(ret);
     return ret;
 };
 
@@ -87,8 +100,12 @@ slp_channel_remove_specific(PyChannelObject *channel, int dir,
 
     assert(PyTasklet_Check(task));
     channel->balance -= dir;
+    if (channel->balance == 0)
+        SLP_LINK_REMOVE(&channel->waiting);
     SLP_HEADCHAIN_REMOVE(task, next, prev);
     task->flags.blocked = 0;
+    if (task->timer_slot)
+        slp_timer_remove(task);
     return task;
 }
 
@@ -125,6 +142,7 @@ PyChannel_New(PyTypeObject *type)
         c->head = c->tail = (PyTaskletObject *) c;
         c->balance = 0;
         c->chan_weakreflist = NULL;
+        c->waiting.next = c->waiting.prev = NULL;
         *(int*)&c->flags = 0;
         c->flags.preference = -1; /* default fast receive */
     }
@@ -361,11 +379,13 @@ int PyStackless_SetChannelCallback(PyObject *callable)
 
 
 static char channel_send__doc__[] =
-"channel.send(value) -- send a value over the channel.\n\
+"channel.send(value, timeout=None) -- send a value over the channel.\n\
 If no other tasklet is already receiving on the channel,\n\
 the sender will be blocked. Otherwise, the receiver will\n\
 be activated immediately, and the sender is put at the end of\n\
-the runnables list.";
+the runnables list.\n\
+If timeout is given, a blocked sender gives up after that many\n\
+seconds and raises stackless.TimeoutError.";
 
 static PyObject *
 PyChannel_Send_M(PyChannelObject *self, PyObject *arg)
@@ -397,10 +417,13 @@ PyChannel_Send(PyChannelObject *self, PyObject *arg)
  * the action can be either send or receive.
  * Note that this works even across threads. The insert action
  * uses the tstate which is stored in the target.
+ * A blocking action gives up after timeout seconds, unless
+ * timeout is negative.
  */
 
 static PyObject *
-generic_channel_action(PyChannelObject *self, PyObject *arg, int dir, int stackless)
+generic_channel_action(PyChannelObject *self, PyObject *arg, int dir,
+                       int stackless, double timeout)
 {
     PyThreadState *ts = PyThreadState_GET();
     PyTaskletObject *source = ts->st.current;
@@ -463,6 +486,13 @@ generic_channel_action(PyChannelObject *self, PyObject *arg, int dir, int stackl
             PyErr_SetNone(PyExc_StopIteration);
             return NULL;
         }
+        if (timeout == 0.0) {
+            PyErr_SetString(slp_timeout_error, "channel operation timed out");
+            return NULL;
+        }
+        if (timeout > 0.0 &&
+            slp_timer_add(source, self, slp_clock() + timeout))
+            return NULL;
         slp_current_remove();
         slp_channel_insert(self, source, dir);
         target = ts->st.current;
@@ -494,7 +524,7 @@ static CHANNEL_SEND_HEAD(impl_channel_send)
     PyThreadState *ts = PyThreadState_GET();
 
     if(ts->st.main == NULL) return PyChannel_Send_M(self, arg);
-    return generic_channel_action(self, arg, 1, stackless);
+    return generic_channel_action(self, arg, 1, stackless, -1.0);
 }
 
 static CHANNEL_SEND_HEAD(wrap_channel_send)
@@ -502,10 +532,52 @@ static CHANNEL_SEND_HEAD(wrap_channel_send)
     return PyObject_CallMethod((PyObject *) self, "send", "(O)", arg);
 }
 
+/* convert a timeout argument, None means to wait forever */
+
+static int
+channel_get_timeout(PyObject *timeout, double *secs)
+{
+    if (timeout == Py_None) {
+        *secs = -1.0;
+        return 0;
+    }
+    *secs = PyFloat_AsDouble(timeout);
+    if (*secs == -1.0 && PyErr_Occurred())
+        return -1;
+    if (*secs < 0.0) {
+        PyErr_SetString(PyExc_ValueError,
+                        "timeout must be a non-negative number or None");
+        return -1;
+    }
+    return 0;
+}
+
 static PyObject *
-channel_send(PyObject *myself, PyObject *arg)
+channel_send(PyObject *myself, PyObject *args, PyObject *kwds)
 {
-    return impl_channel_send((PyChannelObject*)myself, arg);
+    STACKLESS_GETARG();
+    static char *kwlist[] = {"value", "timeout", NULL};
+    PyThreadState *ts = PyThreadState_GET();
+    PyChannelObject *self = (PyChannelObject *) myself;
+    PyObject *arg, *timeout = Py_None, *retval;
+    double secs;
+
+    if (kwds == NULL && PyTuple_GET_SIZE(args) == 1) {
+        /* the common case without a timeout */
+        STACKLESS_PROMOTE_ALL();
+        retval = impl_channel_send(self, PyTuple_GET_ITEM(args, 0));
+        STACKLESS_ASSERT();
+        return retval;
+    }
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|O:send", kwlist,
+                                     &arg, &timeout))
+        return NULL;
+    if (channel_get_timeout(timeout, &secs))
+        return NULL;
+    if (ts->st.main == NULL)
+        return PyStackless_CallMethod_Main(myself, "send", "(OO)",
+                                           arg, timeout);
+    return generic_channel_action(self, arg, 1, stackless, secs);
 }
 
 
@@ -542,7 +614,7 @@ static CHANNEL_SEND_EXCEPTION_HEAD(impl_channel_send_exception)
 
     bomb = slp_make_bomb(klass, args, "channel.send_exception");
     if (bomb != NULL) {
-        ret = generic_channel_action(self, bomb, 1, stackless);
+        ret = generic_channel_action(self, bomb, 1, stackless, -1.0);
         Py_DECREF(bomb);
     }
     return ret;
@@ -583,12 +655,14 @@ err_exit:
 }
 
 static char channel_receive__doc__[] =
-"channel.receive() -- receive a value over the channel.\n\
+"channel.receive(timeout=None) -- receive a value over the channel.\n\
 If no other tasklet is already sending on the channel,\n\
 the receiver will be blocked. Otherwise, the receiver will\n\
 continue immediately, and the sender is put at the end of\n\
 the runnables list.\n\
-The above policy can be changed by setting channel flags.";
+The above policy can be changed by setting channel flags.\n\
+If timeout is given, a blocked receiver gives up after that many\n\
+seconds and raises stackless.TimeoutError.";
 
 static PyObject *
 PyChannel_Receive_M(PyChannelObject *self)
@@ -621,7 +695,7 @@ static CHANNEL_RECEIVE_HEAD(impl_channel_receive)
     PyThreadState *ts = PyThreadState_GET();
 
     if (ts->st.main == NULL) return PyChannel_Receive_M(self);
-    return generic_channel_action(self, Py_None, -1, stackless);
+    return generic_channel_action(self, Py_None, -1, stackless, -1.0);
 }
 
 static CHANNEL_RECEIVE_HEAD(wrap_channel_receive)
@@ -630,9 +704,31 @@ static CHANNEL_RECEIVE_HEAD(wrap_channel_receive)
 }
 
 static PyObject *
-channel_receive(PyObject *self)
+channel_receive(PyObject *myself, PyObject *args, PyObject *kwds)
 {
-    return impl_channel_receive((PyChannelObject*)self);
+    STACKLESS_GETARG();
+    static char *kwlist[] = {"timeout", NULL};
+    PyThreadState *ts = PyThreadState_GET();
+    PyChannelObject *self = (PyChannelObject *) myself;
+    PyObject *timeout = Py_None, *retval;
+    double secs;
+
+    if (kwds == NULL && PyTuple_GET_SIZE(args) == 0) {
+        /* the common case without a timeout */
+        STACKLESS_PROMOTE_ALL();
+        retval = impl_channel_receive(self);
+        STACKLESS_ASSERT();
+        return retval;
+    }
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|O:receive", kwlist,
+                                     &timeout))
+        return NULL;
+    if (channel_get_timeout(timeout, &secs))
+        return NULL;
+    if (ts->st.main == NULL)
+        return PyStackless_CallMethod_Main(myself, "receive", "(O)",
+                                           timeout);
+    return generic_channel_action(self, Py_None, -1, stackless, secs);
 }
 
 
@@ -999,11 +1095,11 @@ channel_cmethods[] = {
 
 static PyMethodDef
 channel_methods[] = {
-    {"send",                (PCF)channel_send,              METH_OS,
+    {"send",                (PCF)channel_send,              METH_KS,
      channel_send__doc__},
     {"send_exception",  (PCF)channel_send_exception,    METH_VS,
      channel_send_exception__doc__},
-    {"receive",             (PCF)channel_receive,           METH_NS,
+    {"receive",             (PCF)channel_receive,           METH_KS,
      channel_receive__doc__},
     {"close",               (PCF)channel_close,             METH_NOARGS,
     channel_close__doc__},
@@ -0,0 +1,294 @@
+/******************************************************
+
+  The Tasklet Group
+
+ ******************************************************/
+
+#include "Python.h"
+
+#ifdef STACKLESS
+#include "core/stackless_impl.h"
+
+/*
+ * A group keeps a list of its live tasklets. Every member knows
+ * its slot in the list, so leaving the group is O(1): the last
+ * member moves into the free slot. Tasklets leave when they end,
+ * and the last one to leave wakes up all tasklets in join().
+ */
+
+static void
+group_wake_joiners(PyTaskletGroupObject *g)
+{
+    while (g->joiners->balance < 0) {
+        PyTaskletObject *t = g->joiners->head;
+
+        TASKLET_SETVAL(t, Py_True);
+        slp_schedule_wakeup(t);
+    }
+}
+
+void
+slp_taskletgroup_leave(PyTaskletObject *task)
+{
+    PyTaskletGroupObject *g = task->group;
+    PyListObject *members = (PyListObject *) g->members;
+    Py_ssize_t last = Py_SIZE(members) - 1;
+    PyTaskletObject *t;
+
+    assert(members->ob_item[task->group_slot] == (PyObject *) task);
+    task->group = NULL;
+    /* move the last member into our slot, and drop the end */
+    t = (PyTaskletObject *) members->ob_item[last];
+    members->ob_item[last] = members->ob_item[task->group_slot];
+    members->ob_item[task->group_slot] = (PyObject *) t;
+    t->group_slot = task->group_slot;
+    PyList_SetSlice(g->members, last, last + 1, NULL);
+    if (last == 0)
+        group_wake_joiners(g);
+    Py_DECREF(g);
+}
+
+static int
+group_traverse(PyTaskletGroupObject *g, visitproc visit, void *arg)
+{
+    Py_VISIT(g->members);
+    Py_VISIT(g->joiners);
+    return 0;
+}
+
+static int
+group_clear(PyTaskletGroupObject *g)
+{
+    /* let the members go, they don't find us anymore */
+    if (g->members != NULL) {
+        Py_ssize_t i;
+
+        for (i = 0; i < PyList_GET_SIZE(g->members); i++) {
+            PyTaskletObject *t;
+
+            t = (PyTaskletObject *) PyList_GET_ITEM(g->members, i);
+            if (t->group == g) {
+                t->group = NULL;
+                Py_DECREF(g);
+            }
+        }
+    }
+    Py_CLEAR(g->members);
+    Py_CLEAR(g->joiners);
+    return 0;
+}
+
+static void
+group_dealloc(PyTaskletGroupObject *g)
+{
+    PyObject_GC_UnTrack(g);
+    if (g->grp_weakreflist != NULL)
+        PyObject_ClearWeakRefs((PyObject *)g);
+    group_clear(g);
+    g->ob_type->tp_free((PyObject *)g);
+}
+
+static PyObject *
+group_new(PyTypeObject *type, PyObject *args, PyObject *kwds)
+{
+    static char *kwlist[] = {NULL};
+    PyTaskletGroupObject *g;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, ":TaskletGroup", kwlist))
+        return NULL;
+    g = (PyTaskletGroupObject *) type->tp_alloc(type, 0);
+    if (g == NULL)
+        return NULL;
+    g->members = PyList_New(0);
+    g->joiners = PyChannel_New(NULL);
+    if (g->members == NULL || g->joiners == NULL) {
+        Py_DECREF(g);
+        return NULL;
+    }
+    return (PyObject *) g;
+}
+
+static char group_add__doc__[] =
+"group.add(tasklet) -- make the tasklet a member of the group.\n\
+The tasklet stays a member until it ends.";
+
+static PyObject *
+group_add(PyTaskletGroupObject *g, PyObject *arg)
+{
+    PyThreadState *ts = PyThreadState_GET();
+    PyTaskletObject *t = (PyTaskletObject *) arg;
+
+    if (!PyTasklet_Check(arg))
+        TYPE_ERROR("group.add() needs a tasklet", NULL);
+    if (t->group != g) {
+        if (t->group != NULL)
+            RUNTIME_ERROR("the tasklet belongs to another group", NULL);
+        if (t->f.frame == NULL && t != ts->st.current)
+            RUNTIME_ERROR("You cannot add an unbound(dead) tasklet", NULL);
+        if (PyList_Append(g->members, arg))
+            return NULL;
+        t->group_slot = PyList_GET_SIZE(g->members) - 1;
+        t->group = g;
+        Py_INCREF(g);
+    }
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+static char group_kill_all__doc__[] =
+"group.kill_all() -- kill all tasklets of the group.\n\
+Tasklets which have not started, or which could not run any code\n\
+on TaskletExit because they have no pending except or finally\n\
+clauses, are dropped without switching to them. The others are\n\
+killed one by one, the current tasklet last.";
+
+static PyObject *
+group_kill_all(PyTaskletGroupObject *g)
+{
+    PyThreadState *ts = PyThreadState_GET();
+    PyObject *victims;
+    Py_ssize_t i;
+    int kill_current = 0;
+
+    /* killing might add or remove members, so work on a copy */
+    victims = PyList_GetSlice(g->members, 0, PyList_GET_SIZE(g->members));
+    if (victims == NULL)
+        return NULL;
+    for (i = 0; i < PyList_GET_SIZE(victims); i++) {
+        PyTaskletObject *t = (PyTaskletObject *) PyList_GET_ITEM(victims, i);
+
+        if (t->group != g)
+            continue;   /* gone meanwhile */
+        if (t == ts->st.current) {
+            kill_current = 1;
+            continue;
+        }
+        if (slp_tasklet_drop(t))
+            continue;
+        if (PyTasklet_Kill(t)) {
+            Py_DECREF(victims);
+            return NULL;
+        }
+    }
+    Py_DECREF(victims);
+    if (kill_current && PyTasklet_Kill(ts->st.current))
+        return NULL;
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+static char group_join__doc__[] =
+"group.join(timeout=None) -- wait until all tasklets of the group\n\
+have ended. Returns True, or False if the timeout has passed first.";
+
+static PyObject *
+group_join(PyTaskletGroupObject *g, PyObject *args, PyObject *kwds)
+{
+    static char *kwlist[] = {"timeout", NULL};
+    PyTaskletObject *current = PyThreadState_GET()->st.current;
+    PyObject *timeout = Py_None, *ret;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|O:join", kwlist,
+                                     &timeout))
+        return NULL;
+    if (PyList_GET_SIZE(g->members) == 0)
+        return PyBool_FromLong(1);
+    if (current != NULL && current->group == g)
+        RUNTIME_ERROR("a tasklet cannot join its own group", NULL);
+    ret = PyObject_CallMethod((PyObject *) g->joiners, "receive", "(O)",
+                              timeout);
+    if (ret == NULL && PyErr_ExceptionMatches(slp_timeout_error)) {
+        PyErr_Clear();
+        return PyBool_FromLong(0);
+    }
+    return ret;
+}
+
+static PyObject *
+group_get_tasklets(PyTaskletGroupObject *g)
+{
+    return PyList_GetSlice(g->members, 0, PyList_GET_SIZE(g->members));
+}
+
+static Py_ssize_t
+group_length(PyTaskletGroupObject *g)
+{
+    return PyList_GET_SIZE(g->members);
+}
+
+static PySequenceMethods group_as_sequence = {
+    (lenfunc)group_length,                      /* sq_length */
+};
+
+static PyGetSetDef group_getsetlist[] = {
+    {"tasklets",        (getter)group_get_tasklets, NULL,
+     "a list of the live tasklets in the group."},
+    {0},
+};
+
+#define PCF PyCFunction
+
+static PyMethodDef group_methods[] = {
+    {"add",                     (PCF)group_add,             METH_O,
+     group_add__doc__},
+    {"kill_all",                (PCF)group_kill_all,        METH_NOARGS,
+     group_kill_all__doc__},
+    {"join",                    (PCF)group_join,            METH_KEYWORDS,
+     group_join__doc__},
+    {NULL,                      NULL}             /* sentinel */
+};
+
+static char group__doc__[] =
+"TaskletGroup() -- a set of tasklets that can be killed or waited for\n\
+as a whole. Tasklets are added explicitly and leave when they end.";
+
+PyTypeObject PyTaskletGroup_Type = {
+    PyObject_HEAD_INIT(&PyType_Type)
+    0,
+    "stackless.TaskletGroup",
+    sizeof(PyTaskletGroupObject),
+    0,
+    (destructor)group_dealloc,                  /* tp_dealloc */
+    0,                                          /* tp_print */
+    0,                                          /* tp_getattr */
+    0,                                          /* tp_setattr */
+    0,                                          /* tp_compare */
+    0,                                          /* tp_repr */
+    0,                                          /* tp_as_number */
+    &group_as_sequence,                         /* tp_as_sequence */
+    0,                                          /* tp_as_mapping */
+    0,                                          /* tp_hash */
+    0,                                          /* tp_call */
+    0,                                          /* tp_str */
+    PyObject_GenericGetAttr,                    /* tp_getattro */
+    PyObject_GenericSetAttr,                    /* tp_setattro */
+    0,                                          /* tp_as_buffer */
+    Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_GC |
+        Py_TPFLAGS_BASETYPE,                    /* tp_flags */
+    group__doc__,                               /* tp_doc */
+    (traverseproc)group_traverse,               /* tp_traverse */
+    (inquiry)group_clear,                       /* tp_clear */
+    0,                                          /* tp_richcompare */
+    offsetof(PyTaskletGroupObject, grp_weakreflist),
+                                                /* tp_weaklistoffset */
+    0,                                          /* tp_iter */
+    0,                                          /* tp_iternext */
+    group_methods,                              /* tp_methods */
+    0,                                          /* tp_members */
+    group_getsetlist,                           /* tp_getset */
+    0,                                          /* tp_base */
+    0,                                          /* tp_dict */
+    0,                                          /* tp_descr_get */
+    0,                                          /* tp_descr_set */
+    0,                                          /* tp_dictoffset */
+    0,                                          /* tp_init */
+    0,                                          /* tp_alloc */
+    group_new,                                  /* tp_new */
+    PyObject_GC_Del,                            /* tp_free */
+};
+
+int init_taskletgrouptype(void)
+{
+    return PyType_Ready(&PyTaskletGroup_Type);
+}
+#endif
@@ -0,0 +1,441 @@
+/******************************************************
+
+  Tasklet-Local Data
+
+ ******************************************************/
+
+#include "Python.h"
+
+#ifdef STACKLESS
+#include "core/stackless_impl.h"
+
+/*
+ * This works like thread.local, but the per-tasklet dicts are not
+ * found by a dict lookup. Every local object gets the index of a
+ * slot in the tasklets' local arrays when it is created, so finding
+ * the dict of the current tasklet is an array access.
+ *
+ * The table maps slots to their locals. It is used for reusing the
+ * slots of dead locals, and for pickling. When a local dies, its
+ * dicts are taken out of the tasklets which are alive. A dead tasklet
+ * may still hold the dict of a dead local, which is detected by the
+ * serial and replaced on the next access.
+ */
+
+static PyTaskletLocalObject **local_table = NULL;
+static Py_ssize_t local_table_size = 0;
+static long local_serial = 0;
+
+static int
+local_table_insert(PyTaskletLocalObject *self)
+{
+    Py_ssize_t i;
+
+    for (i = 0; i < local_table_size; i++)
+        if (local_table[i] == NULL)
+            break;
+    if (i == local_table_size) {
+        Py_ssize_t newsize = local_table_size ? 2 * local_table_size : 8;
+        PyTaskletLocalObject **table = local_table;
+
+        if (PyMem_Resize(table, PyTaskletLocalObject *, newsize) == NULL) {
+            PyErr_NoMemory();
+            return -1;
+        }
+        memset(table + local_table_size, 0,
+               (newsize - local_table_size) * sizeof(*table));
+        local_table = table;
+        local_table_size = newsize;
+    }
+    local_table[i] = self;
+    self->slot = i;
+    self->serial = ++local_serial;
+    return 0;
+}
+
+static int
+tasklet_grow_locals(PyTaskletObject *t, Py_ssize_t n)
+{
+    PyTaskletLocalSlot *locals = t->locals;
+
+    if (n < local_table_size)
+        n = local_table_size;
+    if (PyMem_Resize(locals, PyTaskletLocalSlot, n) == NULL) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    memset(locals + t->nlocals, 0, (n - t->nlocals) * sizeof(*locals));
+    t->locals = locals;
+    t->nlocals = n;
+    return 0;
+}
+
+static int
+local_is_valid(PyTaskletLocalSlot *s, Py_ssize_t slot)
+{
+    return s->dict != NULL && slot < local_table_size &&
+           local_table[slot] != NULL && local_table[slot]->serial == s->serial;
+}
+
+/*
+ * return a borrowed reference to the dict of the current tasklet.
+ * A new dict is initialized by __init__, unless we are called by
+ * local_new, which leaves that to the type call.
+ */
+
+static PyObject *
+local_dict_ex(PyTaskletLocalObject *self, int init)
+{
+    PyTaskletObject *t = PyThreadState_GET()->st.current;
+    PyTaskletLocalSlot *s;
+    PyObject *ldict, *old;
+
+    if (t == NULL)
+        RUNTIME_ERROR("tasklet-local data needs a current tasklet", NULL);
+    if (self->slot >= t->nlocals && tasklet_grow_locals(t, self->slot + 1))
+        return NULL;
+    s = &t->locals[self->slot];
+    if (s->dict != NULL && s->serial == self->serial) {
+        ldict = s->dict;
+    }
+    else {
+        ldict = PyDict_New();
+        if (ldict == NULL)
+            return NULL;
+        old = s->dict;
+        s->dict = ldict;
+        s->serial = self->serial;
+        /* this may run code, don't use s afterwards */
+        Py_XDECREF(old);
+
+        if (init && Py_TYPE(self)->tp_init != PyBaseObject_Type.tp_init &&
+            Py_TYPE(self)->tp_init((PyObject *) self,
+                                   self->args, self->kw) < 0) {
+            /* drop the dict, so that the next access tries again */
+            if (self->slot < t->nlocals &&
+                t->locals[self->slot].dict == ldict) {
+                t->locals[self->slot].dict = NULL;
+                Py_DECREF(ldict);
+            }
+            return NULL;
+        }
+    }
+    return ldict;
+}
+
+#define local_dict(self) local_dict_ex(self, 1)
+
+static PyObject *
+local_new(PyTypeObject *type, PyObject *args, PyObject *kw)
+{
+    PyTaskletLocalObject *self;
+
+    if (type->tp_init == PyBaseObject_Type.tp_init
+        && ((args && PyObject_IsTrue(args))
+        || (kw && PyObject_IsTrue(kw))))
+        TYPE_ERROR("Initialization arguments are not supported", NULL);
+    self = (PyTaskletLocalObject *) type->tp_alloc(type, 0);
+    if (self == NULL)
+        return NULL;
+    self->slot = -1;
+    Py_XINCREF(args);
+    self->args = args;
+    Py_XINCREF(kw);
+    self->kw = kw;
+    if (local_table_insert(self) || local_dict_ex(self, 0) == NULL) {
+        Py_DECREF(self);
+        return NULL;
+    }
+    return (PyObject *) self;
+}
+
+static int
+local_traverse(PyTaskletLocalObject *self, visitproc visit, void *arg)
+{
+    Py_VISIT(self->args);
+    Py_VISIT(self->kw);
+    Py_VISIT(self->dict);
+    return 0;
+}
+
+static int
+local_clear(PyTaskletLocalObject *self)
+{
+    Py_CLEAR(self->args);
+    Py_CLEAR(self->kw);
+    Py_CLEAR(self->dict);
+    return 0;
+}
+
+/*
+ * Take the dicts of a dead local out of the tasklets which are alive,
+ * like thread._local does with the thread states. The dicts are only
+ * released after the walk, because that may run code.
+ */
+
+static void
+local_drop_dicts(PyTaskletLocalObject *self)
+{
+    PyThreadState *ts = PyThreadState_GET();
+    PyObject *dead, *type, *value, *tb;
+    PySlpLink *link;
+
+    if (ts == NULL)
+        return;
+    PyErr_Fetch(&type, &value, &tb);
+    dead = PyList_New(0);
+    if (dead == NULL) {
+        /* leave the dicts, they are detected as stale */
+        PyErr_Restore(type, value, tb);
+        return;
+    }
+    for (ts = ts->interp->tstate_head; ts != NULL; ts = ts->next) {
+        for (link = ts->st.alive.next; link != &ts->st.alive;
+             link = link->next) {
+            PyTaskletObject *t = SLP_LINK_OBJECT(link, PyTaskletObject,
+                                                 alive);
+            PyTaskletLocalSlot *s;
+
+            if (self->slot >= t->nlocals)
+                continue;
+            s = &t->locals[self->slot];
+            if (s->dict == NULL || s->serial != self->serial)
+                continue;
+            /* on failure, the dict stays and is detected as stale */
+            if (PyList_Append(dead, s->dict)) {
+                PyErr_Clear();
+                continue;
+            }
+            Py_DECREF(s->dict);
+            s->dict = NULL;
+        }
+    }
+    Py_DECREF(dead);
+    PyErr_Restore(type, value, tb);
+}
+
+static void
+local_dealloc(PyTaskletLocalObject *self)
+{
+    PyObject_GC_UnTrack(self);
+    /* the slot is free, and the dicts in the tasklets are dropped */
+    if (self->slot >= 0) {
+        local_table[self->slot] = NULL;
+        local_drop_dicts(self);
+    }
+    local_clear(self);
+    Py_TYPE(self)->tp_free((PyObject *) self);
+}
+
+/*
+ * The generic attribute functions find the dict at tp_dictoffset.
+ * We put the dict of the current tasklet there only while they run,
+ * so that the local does not keep the data of dead tasklets alive.
+ */
+
+static PyObject *
+local_generic_getattr(PyTaskletLocalObject *self, PyObject *ldict,
+                      PyObject *name)
+{
+    PyObject *hold = self->dict, *value;
+
+    Py_INCREF(ldict);
+    self->dict = ldict;
+    value = PyObject_GenericGetAttr((PyObject *) self, name);
+    self->dict = hold;
+    Py_DECREF(ldict);
+    return value;
+}
+
+static PyObject *
+local_getattro(PyTaskletLocalObject *self, PyObject *name)
+{
+    PyObject *ldict, *value;
+
+    ldict = local_dict(self);
+    if (ldict == NULL)
+        return NULL;
+    if (Py_TYPE(self) != &PyTaskletLocal_Type)
+        /* use generic lookup for subtypes */
+        return local_generic_getattr(self, ldict, name);
+
+    /* look in the dict ourselves, fall back for __class__ and __dict__ */
+    value = PyDict_GetItem(ldict, name);
+    if (value == NULL)
+        return local_generic_getattr(self, ldict, name);
+    Py_INCREF(value);
+    return value;
+}
+
+static int
+local_setattro(PyTaskletLocalObject *self, PyObject *name, PyObject *v)
+{
+    PyObject *ldict = local_dict(self), *hold = self->dict;
+    int ret;
+
+    if (ldict == NULL)
+        return -1;
+    Py_INCREF(ldict);
+    self->dict = ldict;
+    ret = PyObject_GenericSetAttr((PyObject *) self, name, v);
+    self->dict = hold;
+    Py_DECREF(ldict);
+    return ret;
+}
+
+static PyObject *
+local_get_dict(PyTaskletLocalObject *self)
+{
+    PyObject *ldict = local_dict(self);
+
+    Py_XINCREF(ldict);
+    return ldict;
+}
+
+static PyGetSetDef local_getsetlist[] = {
+    {"__dict__",        (getter)local_get_dict, NULL,
+     "the dict of the current tasklet."},
+    {0},
+};
+
+static char local_reduce__doc__[] =
+"A local is pickled without data. Pickling a tasklet includes the\n\
+dicts it has for its locals.";
+
+static PyObject *
+local_reduce(PyTaskletLocalObject *self)
+{
+    if (self->kw != NULL && PyObject_IsTrue(self->kw))
+        TYPE_ERROR("cannot pickle a local with keyword arguments", NULL);
+    if (self->args != NULL)
+        return Py_BuildValue("(OO)", Py_TYPE(self), self->args);
+    return Py_BuildValue("(O())", Py_TYPE(self));
+}
+
+#define PCF PyCFunction
+
+static PyMethodDef local_methods[] = {
+    {"__reduce__",              (PCF)local_reduce,          METH_NOARGS,
+     local_reduce__doc__},
+    {NULL,                      NULL}             /* sentinel */
+};
+
+static char local__doc__[] =
+"local() -- tasklet-local data. Attributes set on a local object are\n\
+only seen by the tasklet which set them. Like thread.local, subclasses\n\
+may define __init__, which is called in every tasklet on first use.";
+
+PyTypeObject PyTaskletLocal_Type = {
+    PyObject_HEAD_INIT(&PyType_Type)
+    0,
+    "stackless.local",
+    sizeof(PyTaskletLocalObject),
+    0,
+    (destructor)local_dealloc,                  /* tp_dealloc */
+    0,                                          /* tp_print */
+    0,                                          /* tp_getattr */
+    0,                                          /* tp_setattr */
+    0,                                          /* tp_compare */
+    0,                                          /* tp_repr */
+    0,                                          /* tp_as_number */
+    0,                                          /* tp_as_sequence */
+    0,                                          /* tp_as_mapping */
+    0,                                          /* tp_hash */
+    0,                                          /* tp_call */
+    0,                                          /* tp_str */
+    (getattrofunc)local_getattro,               /* tp_getattro */
+    (setattrofunc)local_setattro,               /* tp_setattro */
+    0,                                          /* tp_as_buffer */
+    Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_GC |
+        Py_TPFLAGS_BASETYPE,                    /* tp_flags */
+    local__doc__,                               /* tp_doc */
+    (traverseproc)local_traverse,               /* tp_traverse */
+    (inquiry)local_clear,                       /* tp_clear */
+    0,                                          /* tp_richcompare */
+    0,                                          /* tp_weaklistoffset */
+    0,                                          /* tp_iter */
+    0,                                          /* tp_iternext */
+    local_methods,                              /* tp_methods */
+    0,                                          /* tp_members */
+    local_getsetlist,                           /* tp_getset */
+    0,                                          /* tp_base */
+    0,                                          /* tp_dict */
+    0,                                          /* tp_descr_get */
+    0,                                          /* tp_descr_set */
+    offsetof(PyTaskletLocalObject, dict),       /* tp_dictoffset */
+    0,                                          /* tp_init */
+    0,                                          /* tp_alloc */
+    local_new,                                  /* tp_new */
+    PyObject_GC_Del,                            /* tp_free */
+};
+
+/* support for the tasklet */
+
+PyObject *
+slp_tasklet_locals(PyTaskletObject *t)
+{
+    PyObject *lis = PyList_New(0);
+    Py_ssize_t i;
+
+    if (lis == NULL)
+        return NULL;
+    for (i = 0; i < t->nlocals; i++) {
+        PyObject *pair;
+
+        if (!local_is_valid(&t->locals[i], i))
+            continue;
+        pair = Py_BuildValue("(OO)", local_table[i], t->locals[i].dict);
+        if (pair == NULL || PyList_Append(lis, pair)) {
+            Py_XDECREF(pair);
+            Py_DECREF(lis);
+            return NULL;
+        }
+        Py_DECREF(pair);
+    }
+    return lis;
+}
+
+int
+slp_tasklet_set_locals(PyTaskletObject *t, PyObject *pairs)
+{
+    Py_ssize_t i;
+
+    for (i = 0; i < PyList_GET_SIZE(pairs); i++) {
+        PyTaskletLocalObject *local;
+        PyObject *ldict, *old;
+
+        if (!PyArg_ParseTuple(PyList_GET_ITEM(pairs, i), "O!O!:tasklet",
+                              &PyTaskletLocal_Type, &local,
+                              &PyDict_Type, &ldict))
+            return -1;
+        if (local->slot >= t->nlocals &&
+            tasklet_grow_locals(t, local->slot + 1))
+            return -1;
+        old = t->locals[local->slot].dict;
+        Py_INCREF(ldict);
+        t->locals[local->slot].dict = ldict;
+        t->locals[local->slot].serial = local->serial;
+        Py_XDECREF(old);
+    }
+    return 0;
+}
+
+void
+slp_tasklet_clear_locals(PyTaskletObject *t)
+{
+    PyTaskletLocalSlot *locals = t->locals;
+    Py_ssize_t i, n = t->nlocals;
+
+    /* detach first, clearing the dicts may run code */
+    t->locals = NULL;
+    t->nlocals = 0;
+    for (i = 0; i < n; i++)
+        Py_XDECREF(locals[i].dict);
+    PyMem_Free(locals);
+}
+
+int init_taskletlocaltype(void)
+{
+    return PyType_Ready(&PyTaskletLocal_Type);
+}
+#endif
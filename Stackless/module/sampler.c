@@ -0,0 +1,356 @@
+/******************************************************
+
+  The Sampling Profiler
+
+ ******************************************************/
+
+#include "Python.h"
+
+#ifdef STACKLESS
+#include "core/stackless_impl.h"
+
+#ifdef WITH_THREAD
+#include "pythread.h"
+
+/*
+ * A helper thread wakes up at a fixed interval and asks the main
+ * thread, via a pending call, to take a sample. Sampling is thus
+ * done with the GIL at the next check interval, and costs nothing
+ * but a walk over the frame chain.
+ *
+ * Samples go into a buffer which is allocated when sampling starts.
+ * A sample occupies 2 + depth slots:
+ *
+ *   [tasklet] [depth] [code of the leaf frame] ... [code of the root]
+ *
+ * where the tasklet is kept as its sample_id, or 0 for main. The id
+ * is handed out on the first sample and never reused, so a tasklet
+ * allocated at the address of a dead one gets a profile of its own.
+ * Code objects are referenced until the buffer is cleared.
+ */
+
+#define SAMPLER_MAX_DEPTH 256
+
+typedef union {
+    long task;
+    Py_ssize_t depth;
+    PyObject *code;
+} slp_sample_slot;
+
+static struct {
+    slp_sample_slot *buf;
+    Py_ssize_t size;            /* slots in buf */
+    Py_ssize_t used;            /* slots filled */
+    Py_ssize_t samples;
+    Py_ssize_t dropped;         /* samples which did not fit */
+    double interval;
+    int others;                 /* sample the other tasklets, too */
+    long last_id;               /* the last sample_id handed out */
+    int running;
+    volatile int stopping;
+    volatile int pending;       /* a sample has been requested */
+    PyThread_type_lock done;    /* released when the thread is gone */
+} sampler;
+
+static void
+sample_frames(PyThreadState *ts, PyTaskletObject *task, PyFrameObject *f)
+{
+    Py_ssize_t start = sampler.used, pos = start + 2;
+
+    for (; f != NULL && pos - start - 2 < SAMPLER_MAX_DEPTH; f = f->f_back) {
+        if (!PyFrame_Check(f))
+            continue;   /* cframes have no code */
+        if (pos >= sampler.size) {
+            /* give the references back, the sample does not fit */
+            while (--pos >= start + 2)
+                Py_DECREF(sampler.buf[pos].code);
+            ++sampler.dropped;
+            return;
+        }
+        Py_INCREF(f->f_code);
+        sampler.buf[pos++].code = (PyObject *) f->f_code;
+    }
+    if (pos == start + 2)
+        return;         /* nothing to report */
+    if (task == ts->st.main || task == NULL)
+        sampler.buf[start].task = 0;
+    else {
+        if (task->sample_id == 0)
+            task->sample_id = ++sampler.last_id;
+        sampler.buf[start].task = task->sample_id;
+    }
+    sampler.buf[start + 1].depth = pos - start - 2;
+    sampler.used = pos;
+    ++sampler.samples;
+}
+
+static int
+sampler_sample(void *arg)
+{
+    PyThreadState *ts = PyThreadState_GET();
+    PyTaskletObject *current = ts->st.current;
+
+    sampler.pending = 0;
+    if (!sampler.running)
+        return 0;
+    sample_frames(ts, current, ts->frame);
+    if (sampler.others && current != NULL) {
+        PySlpLink *link;
+        PyTaskletObject *t;
+
+        if (current->next != NULL)
+            for (t = current->next; t != current; t = t->next)
+                sample_frames(ts, t, t->f.frame);
+        /* channels may be shared between threads */
+        for (link = slp_waiting_channels.next; link != &slp_waiting_channels;
+             link = link->next) {
+            PyChannelObject *ch = SLP_LINK_OBJECT(link, PyChannelObject,
+                                                  waiting);
+
+            for (t = ch->head; t != (PyTaskletObject *) ch; t = t->next)
+                if (t->cstate->tstate == ts)
+                    sample_frames(ts, t, t->f.frame);
+        }
+    }
+    return 0;
+}
+
+static void
+sampler_main(void *arg)
+{
+    while (!sampler.stopping) {
+        slp_sleep(sampler.interval);
+        if (sampler.stopping || sampler.pending)
+            continue;
+        sampler.pending = 1;
+        if (Py_AddPendingCall(sampler_sample, NULL))
+            sampler.pending = 0;
+    }
+    PyThread_release_lock(sampler.done);
+}
+
+static void
+sampler_clear(void)
+{
+    Py_ssize_t pos = 0;
+
+    while (pos < sampler.used) {
+        Py_ssize_t i, depth = sampler.buf[pos + 1].depth;
+
+        for (i = 0; i < depth; i++)
+            Py_DECREF(sampler.buf[pos + 2 + i].code);
+        pos += 2 + depth;
+    }
+    PyMem_Free(sampler.buf);
+    sampler.buf = NULL;
+    sampler.size = sampler.used = 0;
+    sampler.samples = sampler.dropped = 0;
+}
+
+char slp_sampler_start__doc__[] =
+"sampler_start(interval=0.001, others=False, bufsize=1048576) --\n\
+start the sampling profiler. Every interval seconds, the frame stack\n\
+of the running tasklet of the main thread is recorded, and if others\n\
+is true, the stacks of its runnable and blocked tasklets, too. bufsize is\n\
+the number of frames which can be recorded, samples which do not fit\n\
+are dropped. Starting discards the samples of the previous run.";
+
+PyObject *
+slp_sampler_start(PyObject *self, PyObject *args, PyObject *kwds)
+{
+    static char *kwlist[] = {"interval", "others", "bufsize", NULL};
+    double interval = 0.001;
+    int others = 0;
+    Py_ssize_t bufsize = 1 << 20;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|din:sampler_start",
+                                     kwlist, &interval, &others, &bufsize))
+        return NULL;
+    if (sampler.running)
+        RUNTIME_ERROR("the sampler is already running", NULL);
+    if (interval <= 0.0 || bufsize <= 0)
+        VALUE_ERROR("interval and bufsize must be positive", NULL);
+    sampler_clear();
+    sampler.buf = PyMem_New(slp_sample_slot, bufsize);
+    if (sampler.buf == NULL)
+        return PyErr_NoMemory();
+    sampler.size = bufsize;
+    if (sampler.done == NULL) {
+        sampler.done = PyThread_allocate_lock();
+        if (sampler.done == NULL)
+            RUNTIME_ERROR("cannot allocate lock", NULL);
+    }
+    PyThread_acquire_lock(sampler.done, 1);
+    PyEval_InitThreads();
+    sampler.interval = interval;
+    sampler.others = others;
+    sampler.stopping = 0;
+    sampler.pending = 0;
+    if (PyThread_start_new_thread(sampler_main, NULL) == -1) {
+        PyThread_release_lock(sampler.done);
+        RUNTIME_ERROR("cannot start the sampler thread", NULL);
+    }
+    sampler.running = 1;
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+char slp_sampler_stop__doc__[] =
+"sampler_stop() -- stop the sampling profiler. The samples are kept\n\
+until the next start.";
+
+PyObject *
+slp_sampler_stop(PyObject *self)
+{
+    if (sampler.running) {
+        sampler.running = 0;
+        sampler.stopping = 1;
+        Py_BEGIN_ALLOW_THREADS
+        PyThread_acquire_lock(sampler.done, 1);
+        Py_END_ALLOW_THREADS
+        PyThread_release_lock(sampler.done);
+    }
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+static PyObject *
+code_label(PyObject *labels, PyCodeObject *co)
+{
+    PyObject *label = PyDict_GetItem(labels, (PyObject *) co);
+
+    if (label == NULL) {
+        label = PyString_FromFormat("%s (%s:%d)",
+                                    PyString_AsString(co->co_name),
+                                    PyString_AsString(co->co_filename),
+                                    co->co_firstlineno);
+        if (label == NULL)
+            return NULL;
+        if (PyDict_SetItem(labels, (PyObject *) co, label)) {
+            Py_DECREF(label);
+            return NULL;
+        }
+        Py_DECREF(label);
+    }
+    return label;
+}
+
+static int
+count_stack(PyObject *counts, PyObject *stack, Py_ssize_t n)
+{
+    PyObject *old = PyDict_GetItem(counts, stack), *num;
+    int ret;
+
+    if (old != NULL)
+        n += PyInt_AS_LONG(old);
+    num = PyInt_FromSsize_t(n);
+    if (num == NULL)
+        return -1;
+    ret = PyDict_SetItem(counts, stack, num);
+    Py_DECREF(num);
+    return ret;
+}
+
+char slp_sampler_collapsed__doc__[] =
+"sampler_collapsed(per_tasklet=True) -- return the samples as collapsed\n\
+stacks, one 'root;...;leaf count' line per distinct stack, which is\n\
+the input format of flamegraph tools. If per_tasklet is true, every\n\
+stack starts with the tasklet it was sampled from, as 'main' or\n\
+'tasklet-<sample_id>'. Dropped samples\n\
+are reported as '[dropped]'.";
+
+PyObject *
+slp_sampler_collapsed(PyObject *self, PyObject *args, PyObject *kwds)
+{
+    static char *kwlist[] = {"per_tasklet", NULL};
+    int per_tasklet = 1;
+    PyObject *labels, *counts, *parts = NULL, *sep = NULL, *lines = NULL;
+    PyObject *ret = NULL, *key, *value;
+    Py_ssize_t pos;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|i:sampler_collapsed",
+                                     kwlist, &per_tasklet))
+        return NULL;
+    labels = PyDict_New();
+    counts = PyDict_New();
+    sep = PyString_FromString(";");
+    if (labels == NULL || counts == NULL || sep == NULL)
+        goto done;
+    for (pos = 0; pos < sampler.used; ) {
+        long task = sampler.buf[pos].task;
+        Py_ssize_t i, depth = sampler.buf[pos + 1].depth;
+        PyObject *stack;
+
+        parts = PyList_New(0);
+        if (parts == NULL)
+            goto done;
+        if (per_tasklet) {
+            PyObject *label = task == 0 ? PyString_FromString("main")
+                : PyString_FromFormat("tasklet-%ld", task);
+
+            if (label == NULL || PyList_Append(parts, label)) {
+                Py_XDECREF(label);
+                goto done;
+            }
+            Py_DECREF(label);
+        }
+        /* the buffer holds the leaf first */
+        for (i = depth - 1; i >= 0; i--) {
+            PyObject *label = code_label(labels, (PyCodeObject *)
+                                         sampler.buf[pos + 2 + i].code);
+
+            if (label == NULL || PyList_Append(parts, label))
+                goto done;
+        }
+        stack = _PyString_Join(sep, parts);
+        Py_CLEAR(parts);
+        if (stack == NULL)
+            goto done;
+        if (count_stack(counts, stack, 1)) {
+            Py_DECREF(stack);
+            goto done;
+        }
+        Py_DECREF(stack);
+        pos += 2 + depth;
+    }
+    if (sampler.dropped) {
+        PyObject *stack = PyString_FromString("[dropped]");
+
+        if (stack == NULL || count_stack(counts, stack, sampler.dropped)) {
+            Py_XDECREF(stack);
+            goto done;
+        }
+        Py_DECREF(stack);
+    }
+    lines = PyList_New(0);
+    if (lines == NULL)
+        goto done;
+    pos = 0;
+    while (PyDict_Next(counts, &pos, &key, &value)) {
+        PyObject *line = PyString_FromFormat("%s %ld\n",
+                                             PyString_AS_STRING(key),
+                                             PyInt_AS_LONG(value));
+
+        if (line == NULL || PyList_Append(lines, line)) {
+            Py_XDECREF(line);
+            goto done;
+        }
+        Py_DECREF(line);
+    }
+    if (PyList_Sort(lines))
+        goto done;
+    Py_DECREF(sep);
+    sep = PyString_FromString("");
+    if (sep != NULL)
+        ret = _PyString_Join(sep, lines);
+done:
+    Py_XDECREF(labels);
+    Py_XDECREF(counts);
+    Py_XDECREF(parts);
+    Py_XDECREF(sep);
+    Py_XDECREF(lines);
+    return ret;
+}
+
+#endif /* WITH_THREAD */
+#endif
@@ -251,6 +251,184 @@ PyTypeObject PyBomb_Type = {
 };
 
 
+/*******************************************************************
+
+  Channel timeouts.
+
+  Every thread state owns a binary heap of timers, ordered by their
+  deadline. A tasklet that blocks on a channel with a timeout is entered
+  here, and leaves the heap as soon as it leaves the channel.
+  The scheduler expires the timers whenever it switches, and sleeps
+  until the next deadline if nothing else is runnable.
+
+ ********************************************************************/
+
+PyObject *slp_timeout_error = NULL;
+
+/* the longest sleep while other threads might wake us up */
+#define TIMER_POLL_INTERVAL 0.005
+
+static void
+timer_place(PySlpTimer *heap, int i, PySlpTimer *timer)
+{
+    heap[i] = *timer;
+    timer->task->timer_slot = i + 1;
+}
+
+static void
+timer_sift_up(PySlpTimer *heap, int i)
+{
+    PySlpTimer timer = heap[i];
+
+    while (i > 0) {
+        int parent = (i - 1) >> 1;
+
+        if (heap[parent].deadline <= timer.deadline)
+            break;
+        timer_place(heap, i, &heap[parent]);
+        i = parent;
+    }
+    timer_place(heap, i, &timer);
+}
+
+static void
+timer_sift_down(PySlpTimer *heap, int count, int i)
+{
+    PySlpTimer timer = heap[i];
+
+    for (;;) {
+        int child = 2 * i + 1;
+
+        if (child >= count)
+            break;
+        if (child + 1 < count &&
+            heap[child + 1].deadline < heap[child].deadline)
+            ++child;
+        if (timer.deadline <= heap[child].deadline)
+            break;
+        timer_place(heap, i, &heap[child]);
+        i = child;
+    }
+    timer_place(heap, i, &timer);
+}
+
+int
+slp_timer_add(PyTaskletObject *task, PyChannelObject *channel,
+              double deadline)
+{
+    PyThreadState *ts = task->cstate->tstate;
+    PySlpTimer timer;
+
+    assert(task->timer_slot == 0);
+    if (ts->st.timers.count == ts->st.timers.size) {
+        int size = ts->st.timers.size ? ts->st.timers.size * 2 : 16;
+        PySlpTimer *heap = ts->st.timers.heap;
+
+        PyMem_RESIZE(heap, PySlpTimer, size);
+        if (heap == NULL) {
+            PyErr_NoMemory();
+            return -1;
+        }
+        ts->st.timers.heap = heap;
+        ts->st.timers.size = size;
+    }
+    timer.deadline = deadline;
+    timer.task = task;
+    timer.channel = channel;
+    ts->st.timers.heap[ts->st.timers.count] = timer;
+    timer_sift_up(ts->st.timers.heap, ts->st.timers.count++);
+    return 0;
+}
+
+void
+slp_timer_remove(PyTaskletObject *task)
+{
+    PyThreadState *ts = task->cstate->tstate;
+    PySlpTimer *heap = ts->st.timers.heap;
+    int i = task->timer_slot - 1;
+
+    if (i < 0)
+        return;
+    assert(i < ts->st.timers.count && heap[i].task == task);
+    task->timer_slot = 0;
+    if (i == --ts->st.timers.count)
+        return;
+    heap[i] = heap[ts->st.timers.count];
+    if (i > 0 && heap[(i - 1) >> 1].deadline > heap[i].deadline)
+        timer_sift_up(heap, i);
+    else
+        timer_sift_down(heap, ts->st.timers.count, i);
+}
+
+/*
+ * Take all tasklets whose timeout has passed off their channels
+ * and make them runnable with a TimeoutError.
+ * Returns the number of expired timers or -1 on error.
+ */
+
+int
+slp_timer_expire(PyThreadState *ts)
+{
+    double now;
+    int expired = 0;
+    PyObject *msg = NULL;
+
+    if (ts->st.timers.count == 0)
+        return 0;
+    now = slp_clock();
+    while (ts->st.timers.count && ts->st.timers.heap[0].deadline <= now) {
+        PySlpTimer timer = ts->st.timers.heap[0];
+        PyObject *bomb;
+
+        /* build the bomb without touching the current exception */
+        if (msg == NULL &&
+            (msg = PyString_FromString("channel operation timed out")) == NULL)
+            return -1;
+        bomb = slp_make_bomb(slp_timeout_error, msg, "channel timeout");
+        if (bomb == NULL) {
+            Py_DECREF(msg);
+            return -1;
+        }
+        /* this also removes the timer */
+        slp_channel_remove_specific(timer.channel,
+                                    timer.task->flags.blocked, timer.task);
+        TASKLET_SETVAL_OWN(timer.task, bomb);
+        /* the channel's reference moves to the runnables */
+        slp_current_insert(timer.task);
+        ++expired;
+    }
+    Py_XDECREF(msg);
+    return expired;
+}
+
+/*
+ * Sleep until the next timer expires, without holding the GIL.
+ * If other threads are alive, they might insert tasklets for us,
+ * so we only take short naps then.
+ */
+
+static int check_for_deadlock(void);
+
+static int
+schedule_timer_wait(PyThreadState *ts)
+{
+    while (ts->st.current == NULL && ts->st.timers.count) {
+        double delay = ts->st.timers.heap[0].deadline - slp_clock();
+
+        if (delay > TIMER_POLL_INTERVAL && !check_for_deadlock())
+            delay = TIMER_POLL_INTERVAL;
+        if (delay > 0.0) {
+            Py_BEGIN_ALLOW_THREADS
+            slp_sleep(delay);
+            Py_END_ALLOW_THREADS
+        }
+        if (PyErr_CheckSignals() || slp_timer_expire(ts) < 0)
+            return -1;
+    }
+    return 0;
+}
+
+
 /*******************************************************************
 
   Exception handling revised.
@@ -500,7 +678,7 @@ is_thread_runnable(PyThreadState *ts)
 #ifdef WITH_THREAD
     if (ts == PyThreadState_GET())
         return 0;
-    return !ts->st.thread.is_blocked;
+    return !ts->st.thread.is_blocked && !ts->st.thread.is_idle;
 #endif
     return 0;
 }
@@ -599,6 +777,29 @@ static int schedule_thread_unblock(PyThreadState *nts)
 }
 #endif
 
+/*
+ * put a tasklet into its own thread's queue and unblock that thread
+ * if required. This can be called from any thread.
+ */
+
+void
+slp_schedule_wakeup(PyTaskletObject *task)
+{
+    if (task->flags.blocked) {
+        /* unblock from channel */
+        slp_channel_remove_slow(task);
+        slp_current_insert(task);
+    }
+    else if (task->next == NULL) {
+        /* reactivate floating task */
+        Py_INCREF(task);
+        slp_current_insert(task);
+    }
+#ifdef WITH_THREAD
+    schedule_thread_unblock(task->cstate->tstate);
+#endif
+}
+
 static PyObject *
 schedule_task_block(PyTaskletObject *prev, int stackless, int *did_switch)
 {
@@ -607,6 +808,22 @@ schedule_task_block(PyTaskletObject *prev, int stackless, int *did_switch)
     PyTaskletObject *next = NULL;
     int revive_main = 0;
 
+    /*
+     * somebody waits with a timeout, so this is no deadlock yet.
+     * Sleep until it expires, unless the watchdog wants main back.
+     */
+    if (ts->st.timers.count && ts->st.interrupt == NULL) {
+        if (schedule_timer_wait(ts)) {
+            if (!(retval = slp_curexc_to_bomb()))
+                return NULL;
+            TASKLET_SETVAL_OWN(prev, retval);
+            return slp_schedule_task(prev, prev, stackless, did_switch);
+        }
+        if (ts->st.current != NULL)
+            return slp_schedule_task(prev, ts->st.current, stackless,
+                                     did_switch);
+    }
+
 #ifdef WITH_THREAD
     if ( !(ts->st.runflags & Py_WATCHDOG_THREADBLOCK) && ts->st.main->next == NULL)
         /* we also must never block if watchdog is running not in threadblocking mode */
@@ -657,10 +874,7 @@ static PyObject *schedule_task_interthread(PyTaskletObject *prev,
                                        int stackless,
                                        int *did_switch)
 {
-    PyThreadState *ts = PyThreadState_GET();
-    PyThreadState *nts = next->cstate->tstate;
     PyObject *retval;
-    long thread_id = nts->thread_id;
 
     /* get myself ready, since the previous task is going to continue on the
      * curren thread
@@ -668,19 +882,7 @@ static PyObject *schedule_task_interthread(PyTaskletObject *prev,
     retval = slp_schedule_task(prev, prev, stackless, did_switch);
 
     /* put the next tasklet in the target thread's queue */
-   if (next->flags.blocked) {
-        /* unblock from channel */
-        slp_channel_remove_slow(next);
-        slp_current_insert(next);
-    }
-    else if (next->next == NULL) {
-        /* reactivate floating task */
-        Py_INCREF(next);
-        slp_current_insert(next);
-    }
-
-    /* unblock the thread if required */
-    schedule_thread_unblock(nts);
+    slp_schedule_wakeup(next);
 
     return retval;
 }
@@ -736,6 +938,21 @@ slp_schedule_task(PyTaskletObject *prev, PyTaskletObject *next, int stackless,
     if (did_switch)
         *did_switch = 0; /* only set this if an actual switch occurs */
 
+    /* wake up tasklets whose channel timeout has passed */
+    if (ts->st.timers.count) {
+        PyObject *et, *ev, *tb;
+        int expired;
+
+        /* the caller may be switching with an exception set */
+        PyErr_Fetch(&et, &ev, &tb);
+        expired = slp_timer_expire(ts);
+        if (expired < 0)
+            PyErr_Clear(); /* out of memory, retry on the next switch */
+        PyErr_Restore(et, ev, tb);
+        if (expired >= 0 && next == NULL)
+            next = ts->st.current;
+    }
+
     if (next == NULL) {
         return schedule_task_block(prev, stackless, did_switch);
     }
@@ -745,6 +962,8 @@ slp_schedule_task(PyTaskletObject *prev, PyTaskletObject *next, int stackless,
         return schedule_task_interthread(prev, next, stackless, did_switch);
     }
 #endif
+    if (next->flags.frozen)
+        slp_tasklet_thaw(next);
 
     /* remove the no-soft-irq flag from the runflags */
     no_soft_irq = ts->st.runflags & PY_WATCHDOG_NO_SOFT_IRQ;
@@ -944,6 +1163,7 @@ initialize_main_and_current(void)
     Py_INCREF(task);
     slp_current_insert(task);
     ts->st.current = task;
+    slp_tasklet_register(task);
 
     NOTIFY_SCHEDULE(NULL, task, -1);
 
@@ -1048,6 +1268,10 @@ tasklet_end(PyObject *retval)
      */
     TASKLET_SETVAL(task, retval);
 
+    if (task->group != NULL)
+        slp_taskletgroup_leave(task);
+    slp_tasklet_unregister(task);
+
     if (ismain) {
         /*
          * Because of soft switching, we may find ourself in the top level of a stack that was created
@@ -1088,6 +1312,28 @@ tasklet_end(PyObject *retval)
     }
 
     next = ts->st.current;
+    if (next == NULL && ts->st.timers.count && ts->st.interrupt == NULL) {
+        /* main might be waiting with a timeout */
+        if (schedule_timer_wait(ts)) {
+            Py_DECREF(retval);
+            retval = slp_curexc_to_bomb();
+            if (retval == NULL)
+                return NULL;
+        }
+        next = ts->st.current;
+    }
+#ifdef WITH_THREAD
+    if (next == NULL && ts->st.main->flags.blocked && !check_for_deadlock()) {
+        /* another thread might still wake somebody up */
+        if (schedule_thread_block(ts)) {
+            Py_DECREF(retval);
+            retval = slp_curexc_to_bomb();
+            if (retval == NULL)
+                return NULL;
+        }
+        next = ts->st.current;
+    }
+#endif
     if (next == NULL) {
         int blocked = ts->st.main->flags.blocked;
 
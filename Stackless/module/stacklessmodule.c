@@ -13,6 +13,10 @@
 #include "pickling/prickelpit.h"
 #include "core/stackless_methods.h"
 
+#ifdef WITH_THREAD
+#include "pythread.h"
+#endif
+
 /******************************************************
 
   The Stackless Module
@@ -130,6 +134,80 @@ getruncount(PyObject *self)
 }
 
 
+static char spawn_many__doc__[] =
+"spawn_many(func, arglist) -- create a tasklet of func for every tuple\n\
+in arglist and make them all runnable at once. This is a faster way to\n\
+write [tasklet(func)(*args) for args in arglist], which is returned.";
+
+static PyObject *
+spawn_many(PyObject *self, PyObject *args)
+{
+    PyObject *func, *arglist;
+
+    if (!PyArg_ParseTuple(args, "OO:spawn_many", &func, &arglist))
+        return NULL;
+    return PyTasklet_SpawnMany(func, arglist);
+}
+
+
+static char memory_top__doc__[] =
+"memory_top(n=10) -- return the n largest tasklet memory accounts as a\n\
+list of (tasklet, live bytes, peak bytes) tuples. The tasklet is None\n\
+for memory allocated outside of tasklets, or by tasklets which are gone.\n\
+Needs PYTHONTASKLETMEMORY set at startup.";
+
+static PyObject *
+memory_top(PyObject *self, PyObject *args, PyObject *kwds)
+{
+    static char *kwlist[] = {"n", NULL};
+    Py_ssize_t n = 10, i, count = 0;
+    PySlpMemAccount *top, *a;
+    PyObject *ret = NULL;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|n:memory_top", kwlist, &n))
+        return NULL;
+    if (!slp_memaccount_enabled())
+        RUNTIME_ERROR("tasklet memory accounting is off, "
+                      "set PYTHONTASKLETMEMORY to enable it", NULL);
+    if (n < 0)
+        VALUE_ERROR("n must not be negative", NULL);
+    /*
+     * Copy the accounts first, since creating the result allocates
+     * and frees memory, which changes them.
+     */
+    top = PyMem_New(PySlpMemAccount, n + 1);
+    if (top == NULL)
+        return PyErr_NoMemory();
+    a = &slp_memaccounts;
+    do {
+        for (i = count; i > 0 && top[i - 1].live < a->live; i--)
+            top[i] = top[i - 1];
+        top[i] = *a;
+        if (count < n)
+            ++count;
+        a = a->next;
+    } while (a != &slp_memaccounts);
+    for (i = 0; i < count; i++)
+        Py_XINCREF(top[i].task);
+    ret = PyList_New(count);
+    for (i = 0; i < count; i++) {
+        PyObject *task = (PyObject *) top[i].task;
+        PyObject *item = NULL;
+
+        if (ret != NULL)
+            item = Py_BuildValue("(Onn)", task ? task : Py_None,
+                                 top[i].live, top[i].peak);
+        Py_XDECREF(task);
+        if (item == NULL)
+            Py_CLEAR(ret);
+        else
+            PyList_SET_ITEM(ret, i, item);
+    }
+    PyMem_Free(top);
+    return ret;
+}
+
+
 static char getcurrent__doc__[] =
 "getcurrent() -- return the currently executing tasklet.";
 
@@ -362,6 +440,496 @@ get_thread_info(PyObject *self, PyObject *args)
         ts->st.runcount);
 }
 
+static char get_tasklets__doc__[] =
+"get_tasklets(state='alive', thread_id=0) -- return a list of the\n\
+tasklets of a thread which are in the given state:\n\
+'alive'    all tasklets which have a frame,\n\
+'runnable' the run queue, starting with the current tasklet,\n\
+'blocked'  the tasklets waiting on a channel.\n\
+The default thread is the calling one. This takes time in proportion\n\
+to the result, and to the waiters of channels for 'blocked'.";
+
+static PyObject *
+get_tasklets(PyObject *self, PyObject *args, PyObject *kwds)
+{
+    static char *kwlist[] = {"state", "thread_id", NULL};
+    PyThreadState *ts = PyThreadState_GET();
+    char *state = "alive";
+    long id = 0;
+    PyObject *lis;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|sl:get_tasklets",
+                                     kwlist, &state, &id))
+        return NULL;
+    if (id != 0) {
+        for (ts = ts->interp->tstate_head; ts != NULL; ts = ts->next)
+            if (ts->thread_id == id)
+                break;
+        if (ts == NULL)
+            VALUE_ERROR("Thread id not found", NULL);
+    }
+    lis = PyList_New(0);
+    if (lis == NULL)
+        return NULL;
+    if (strcmp(state, "alive") == 0) {
+        PySlpLink *link;
+
+        for (link = ts->st.alive.next; link != &ts->st.alive;
+             link = link->next) {
+            if (PyList_Append(lis, (PyObject *)
+                              SLP_LINK_OBJECT(link, PyTaskletObject, alive)))
+                goto error;
+        }
+    }
+    else if (strcmp(state, "runnable") == 0) {
+        PyTaskletObject *t = ts->st.current;
+
+        if (t != NULL && t->next != NULL) {
+            do {
+                if (PyList_Append(lis, (PyObject *) t))
+                    goto error;
+                t = t->next;
+            } while (t != ts->st.current);
+        }
+    }
+    else if (strcmp(state, "blocked") == 0) {
+        PySlpLink *link;
+
+        /* channels may be shared between threads */
+        for (link = slp_waiting_channels.next; link != &slp_waiting_channels;
+             link = link->next) {
+            PyChannelObject *ch = SLP_LINK_OBJECT(link, PyChannelObject,
+                                                  waiting);
+            PyTaskletObject *t;
+
+            for (t = ch->head; t != (PyTaskletObject *) ch; t = t->next) {
+                if (t->cstate->tstate == ts &&
+                    PyList_Append(lis, (PyObject *) t))
+                    goto error;
+            }
+        }
+    }
+    else {
+        Py_DECREF(lis);
+        VALUE_ERROR("state must be 'alive', 'runnable' or 'blocked'", NULL);
+    }
+    return lis;
+error:
+    Py_DECREF(lis);
+    return NULL;
+}
+
+static char freeze_blocked__doc__[] =
+"freeze_blocked() -- freeze all tasklets of this thread which wait on\n\
+a channel, see tasklet.freeze(). Returns the number of tasklets which\n\
+were not frozen before.";
+
+static PyObject *
+freeze_blocked(PyObject *self)
+{
+    PyThreadState *ts = PyThreadState_GET();
+    PySlpLink *link;
+    long n = 0;
+
+    for (link = slp_waiting_channels.next; link != &slp_waiting_channels;
+         link = link->next) {
+        PyChannelObject *ch = SLP_LINK_OBJECT(link, PyChannelObject,
+                                              waiting);
+        PyTaskletObject *t;
+
+        for (t = ch->head; t != (PyTaskletObject *) ch; t = t->next) {
+            if (t->cstate->tstate != ts || t->flags.frozen)
+                continue;
+            if (slp_tasklet_freeze(t))
+                return NULL;
+            ++n;
+        }
+    }
+    return PyInt_FromLong(n);
+}
+
+static char get_channels__doc__[] =
+"get_channels() -- return a list of (channel, balance) tuples for all\n\
+channels with tasklets waiting on them, in all threads. The length\n\
+of the queue is abs(balance), a negative balance means receivers.";
+
+static PyObject *
+get_channels(PyObject *self)
+{
+    PyObject *lis = PyList_New(0);
+    PySlpLink *link;
+
+    if (lis == NULL)
+        return NULL;
+    for (link = slp_waiting_channels.next; link != &slp_waiting_channels;
+         link = link->next) {
+        PyChannelObject *ch = SLP_LINK_OBJECT(link, PyChannelObject, waiting);
+        PyObject *item = Py_BuildValue("(Oi)", ch, ch->balance);
+
+        if (item == NULL || PyList_Append(lis, item)) {
+            Py_XDECREF(item);
+            Py_DECREF(lis);
+            return NULL;
+        }
+        Py_DECREF(item);
+    }
+    return lis;
+}
+
+#ifdef WITH_THREAD
+
+/******************************************************
+
+  The thread pool for blocking calls.
+
+  call_in_pool() parks the current tasklet and hands the call
+  over to a small set of worker threads. When the call is done,
+  the worker puts the tasklet back into its own thread's queue,
+  just like a channel action between threads does.
+  All pool data is protected by the GIL. A forked child starts
+  over with new workers, and the idle workers leave at
+  finalization.
+
+ ******************************************************/
+
+#define SLP_POOL_SIZE 4
+
+typedef struct _slp_pool_job {
+    struct _slp_pool_job *next;
+    PyObject *func;
+    PyObject *args;
+    PyObject *kwds;
+    PyTaskletObject *task;      /* the parked tasklet, owned while set */
+    int waiting;                /* the tasklet has not resumed, yet */
+    int done;                   /* the worker is finished with the call */
+} slp_pool_job;
+
+typedef struct _slp_pool_worker {
+    struct _slp_pool_worker *next;          /* in the idle list */
+    struct _slp_pool_worker *sibling;       /* in the list of all workers */
+    PyThreadState *tstate;
+    PyThread_type_lock wakeup;
+    PyThread_type_lock done;    /* released on exit, if slp_pool_fini waits */
+    slp_pool_job *job;          /* the call in progress */
+} slp_pool_worker;
+
+static struct {
+    slp_pool_job *head, *tail;              /* pending jobs */
+    slp_pool_worker *idle;
+    slp_pool_worker *all;
+    int nworkers;
+    int shutdown;
+} slp_pool = {NULL, NULL, NULL, NULL, 0, 0};
+
+static void
+pool_job_free(slp_pool_job *job)
+{
+    Py_XDECREF(job->func);
+    Py_XDECREF(job->args);
+    Py_XDECREF(job->kwds);
+    Py_XDECREF(job->task);
+    PyMem_Free(job);
+}
+
+static void
+pool_job_finish(slp_pool_job *job, PyObject *result)
+{
+    job->done = 1;
+    if (!job->waiting) {
+        /* the tasklet went away, nobody wants the result */
+        Py_XDECREF(result);
+        pool_job_free(job);
+        return;
+    }
+    if (result == NULL) {
+        result = slp_curexc_to_bomb();
+        if (result == NULL) {
+            /* no memory for the bomb, the tasklet gets None */
+            PyErr_Clear();
+            Py_INCREF(Py_None);
+            result = Py_None;
+        }
+    }
+    TASKLET_SETVAL_OWN(job->task, result);
+    slp_schedule_wakeup(job->task);
+    /* the run queue has its own reference now */
+    Py_CLEAR(job->task);
+}
+
+static void
+pool_worker_free(slp_pool_worker *w)
+{
+    slp_pool_worker **p;
+
+    for (p = &slp_pool.all; *p != NULL; p = &(*p)->sibling)
+        if (*p == w) {
+            *p = w->sibling;
+            --slp_pool.nworkers;
+            break;
+        }
+    if (w->done != NULL)
+        PyThread_free_lock(w->done);
+    PyThread_free_lock(w->wakeup);
+    PyMem_Free(w);
+}
+
+static void
+pool_worker_main(void *arg)
+{
+    slp_pool_worker *w = (slp_pool_worker *) arg;
+    PyThreadState *ts = w->tstate;
+
+    ts->thread_id = PyThread_get_thread_ident();
+    _PyThreadState_Init(ts);
+    PyEval_AcquireThread(ts);
+    while (!slp_pool.shutdown) {
+        slp_pool_job *job = slp_pool.head;
+
+        if (job == NULL) {
+            /* wait until pool_submit wakes us up */
+            w->next = slp_pool.idle;
+            slp_pool.idle = w;
+            ts->st.thread.is_idle = 1;
+            Py_BEGIN_ALLOW_THREADS
+            PyThread_acquire_lock(w->wakeup, 1);
+            Py_END_ALLOW_THREADS
+            continue;
+        }
+        slp_pool.head = job->next;
+        if (slp_pool.head == NULL)
+            slp_pool.tail = NULL;
+        if (!job->waiting) {
+            /* cancelled before we got to it */
+            pool_job_finish(job, NULL);
+            continue;
+        }
+        w->job = job;
+        pool_job_finish(job, PyObject_Call(job->func, job->args, job->kwds));
+        w->job = NULL;
+    }
+
+    /* the pool shuts down */
+    PyThreadState_Clear(ts);
+    if (w->done != NULL)
+        /* slp_pool_fini waits for us and frees the worker */
+        PyThread_release_lock(w->done);
+    else
+        pool_worker_free(w);
+    PyThreadState_DeleteCurrent();
+}
+
+static int
+pool_start_worker(void)
+{
+    slp_pool_worker *w;
+
+    PyEval_InitThreads();
+    w = PyMem_New(slp_pool_worker, 1);
+    if (w == NULL) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    w->next = NULL;
+    w->done = NULL;
+    w->job = NULL;
+    w->wakeup = PyThread_allocate_lock();
+    if (w->wakeup == NULL) {
+        PyMem_Free(w);
+        PyErr_NoMemory();
+        return -1;
+    }
+    PyThread_acquire_lock(w->wakeup, 1);
+    w->tstate = _PyThreadState_Prealloc(PyThreadState_GET()->interp);
+    if (w->tstate == NULL) {
+        PyThread_free_lock(w->wakeup);
+        PyMem_Free(w);
+        return -1;
+    }
+    if (PyThread_start_new_thread(pool_worker_main, (void *) w) == -1) {
+        PyThreadState_Clear(w->tstate);
+        PyThreadState_Delete(w->tstate);
+        PyThread_free_lock(w->wakeup);
+        PyMem_Free(w);
+        RUNTIME_ERROR("can't start a pool thread", -1);
+    }
+    w->sibling = slp_pool.all;
+    slp_pool.all = w;
+    ++slp_pool.nworkers;
+    return 0;
+}
+
+static int
+pool_submit(slp_pool_job *job)
+{
+    slp_pool_worker *w = slp_pool.idle;
+
+    if (slp_pool.shutdown)
+        RUNTIME_ERROR("the pool is shut down", -1);
+    if (w == NULL && slp_pool.nworkers < SLP_POOL_SIZE) {
+        /* grow lazily, but we can live with the workers we have */
+        if (pool_start_worker()) {
+            if (slp_pool.nworkers == 0)
+                return -1;
+            PyErr_Clear();
+        }
+    }
+    job->next = NULL;
+    if (slp_pool.tail == NULL)
+        slp_pool.head = job;
+    else
+        slp_pool.tail->next = job;
+    slp_pool.tail = job;
+    if (w != NULL) {
+        slp_pool.idle = w->next;
+        w->tstate->st.thread.is_idle = 0;
+        PyThread_release_lock(w->wakeup);
+    }
+    return 0;
+}
+
+/*
+ * In a forked child only the forking thread is left. The state of
+ * the idle workers is dropped. A worker that was in a call may have
+ * left frames and tasklets behind, so its thread state stays, like
+ * the states of the other threads lost in fork. Its tasklet gets an
+ * error if it belongs to us.
+ */
+
+void
+slp_pool_after_fork(void)
+{
+    PyThreadState *ts = PyThreadState_GET();
+    slp_pool_worker *w = slp_pool.all;
+
+    while (w != NULL) {
+        slp_pool_worker *next = w->sibling;
+        slp_pool_job *job = w->job;
+
+        if (job != NULL) {
+            if (job->waiting && job->task != NULL &&
+                job->task->cstate->tstate == ts) {
+                PyErr_SetString(PyExc_RuntimeError,
+                                "the pool thread of the call was lost "
+                                "in fork()");
+                pool_job_finish(job, NULL);
+            }
+        }
+        else {
+            PyThreadState_Clear(w->tstate);
+            PyThreadState_Delete(w->tstate);
+        }
+        pool_worker_free(w);
+        w = next;
+    }
+    slp_pool.idle = NULL;
+    assert(slp_pool.nworkers == 0);
+    /* the pending jobs need a worker now */
+    if (slp_pool.head != NULL && pool_start_worker())
+        PyErr_WriteUnraisable(slp_module);
+}
+
+/*
+ * Called by Py_Finalize after the tasklets were killed. The idle
+ * workers are woken up and waited for, a busy worker leaves when its
+ * call returns.
+ */
+
+void
+slp_pool_fini(void)
+{
+    slp_pool_worker *w, *idle = slp_pool.idle;
+
+    slp_pool.shutdown = 1;
+    slp_pool.idle = NULL;
+    for (w = idle; w != NULL; w = w->next) {
+        w->done = PyThread_allocate_lock();
+        if (w->done == NULL)
+            /* it stays asleep */
+            continue;
+        PyThread_acquire_lock(w->done, 1);
+        w->tstate->st.thread.is_idle = 0;
+        PyThread_release_lock(w->wakeup);
+    }
+    while (idle != NULL) {
+        w = idle;
+        idle = w->next;
+        if (w->done == NULL)
+            continue;
+        Py_BEGIN_ALLOW_THREADS
+        PyThread_acquire_lock(w->done, 1);
+        Py_END_ALLOW_THREADS
+        pool_worker_free(w);
+    }
+}
+
+static char call_in_pool__doc__[] =
+"call_in_pool(func, *args, **kwds) -- call func in a worker thread.\n\
+The current tasklet is blocked until the call is done, and other\n\
+tasklets keep running meanwhile. The result of the call is returned,\n\
+or its exception is raised. This is meant for blocking calls which\n\
+release the GIL, such as file or socket functions.\n\
+Note that stackless.run() needs threadblock=True to wait for pool calls\n\
+when there is nothing else to run.";
+
+static PyObject *
+call_in_pool(PyObject *self, PyObject *args, PyObject *kwds)
+{
+    PyThreadState *ts = PyThreadState_GET();
+    PyTaskletObject *prev = ts->st.current;
+    PyObject *retval;
+    slp_pool_job *job;
+    int runflags;
+
+    if (PyTuple_GET_SIZE(args) < 1)
+        TYPE_ERROR("call_in_pool() needs a callable", NULL);
+    if (ts->st.main == NULL) {
+        PyObject *func = PyObject_GetAttrString(slp_module, "call_in_pool");
+
+        if (func == NULL)
+            return NULL;
+        retval = PyStackless_Call_Main(func, args, kwds);
+        Py_DECREF(func);
+        return retval;
+    }
+    if (prev->flags.block_trap)
+        RUNTIME_ERROR("this tasklet does not like to be blocked.", NULL);
+
+    job = PyMem_New(slp_pool_job, 1);
+    if (job == NULL)
+        return PyErr_NoMemory();
+    job->func = PyTuple_GET_ITEM(args, 0);
+    Py_INCREF(job->func);
+    job->args = PyTuple_GetSlice(args, 1, PyTuple_GET_SIZE(args));
+    job->kwds = kwds;
+    Py_XINCREF(kwds);
+    job->task = NULL;
+    job->waiting = 1;
+    job->done = 0;
+    if (job->args == NULL || pool_submit(job)) {
+        pool_job_free(job);
+        return NULL;
+    }
+
+    /* park ourselves, the job takes over the run queue's reference */
+    job->task = slp_current_remove();
+    runflags = ts->st.runflags;
+    if (prev == ts->st.main)
+        /* there is nobody to revive us, wait for the worker instead */
+        ts->st.runflags |= Py_WATCHDOG_THREADBLOCK;
+    /* the job refers to our C stack, so we must hard switch */
+    retval = slp_schedule_task(prev, ts->st.current, 0, 0);
+    ts->st.runflags = runflags;
+
+    /* we are either woken by the worker or by somebody else */
+    job->waiting = 0;
+    Py_CLEAR(job->task);
+    if (job->done)
+        pool_job_free(job);
+    return retval;
+}
+
+#endif
+
 static PyObject *
 slpmodule_reduce(PyObject *self)
 {
@@ -842,6 +1410,10 @@ static PyMethodDef stackless_methods[] = {
      getruncount__doc__},
     {"getcurrent",                  (PCF)getcurrent,            METH_NOARGS,
      getcurrent__doc__},
+    {"spawn_many",                  (PCF)spawn_many,            METH_VARARGS,
+     spawn_many__doc__},
+    {"memory_top",                  (PCF)memory_top,            METH_KEYWORDS,
+     memory_top__doc__},
     {"getmain",                     (PCF)getmain,               METH_NOARGS,
      getmain__doc__},
     {"enable_softswitch",           (PCF)enable_softswitch,     METH_O,
@@ -862,6 +1434,22 @@ static PyMethodDef stackless_methods[] = {
      slp_pickle_moduledict__doc__},
     {"get_thread_info",             (PCF)get_thread_info,       METH_VARARGS,
      get_thread_info__doc__},
+    {"get_tasklets",                (PCF)get_tasklets,          METH_KEYWORDS,
+     get_tasklets__doc__},
+    {"get_channels",                (PCF)get_channels,          METH_NOARGS,
+     get_channels__doc__},
+    {"freeze_blocked",              (PCF)freeze_blocked,        METH_NOARGS,
+     freeze_blocked__doc__},
+#ifdef WITH_THREAD
+    {"call_in_pool",                (PCF)call_in_pool,          METH_KEYWORDS,
+     call_in_pool__doc__},
+    {"sampler_start",               (PCF)slp_sampler_start,     METH_KEYWORDS,
+     slp_sampler_start__doc__},
+    {"sampler_stop",                (PCF)slp_sampler_stop,      METH_NOARGS,
+     slp_sampler_stop__doc__},
+    {"sampler_collapsed",           (PCF)slp_sampler_collapsed, METH_KEYWORDS,
+     slp_sampler_collapsed__doc__},
+#endif
     {"_gc_untrack",                 (PCF)_gc_untrack,           METH_O,
     _gc_untrack__doc__},
     {"_gc_track",                   (PCF)_gc_track,             METH_O,
@@ -1149,6 +1737,8 @@ _PyStackless_InitTypes(void)
         || init_flextype()
         || init_tasklettype()
         || init_channeltype()
+        || init_taskletgrouptype()
+        || init_taskletlocaltype()
         )
         return 0;
     return -1;
@@ -1198,8 +1788,18 @@ _PyStackless_Init(void)
     INSERT("bomb",          &PyBomb_Type);
     INSERT("tasklet",   &PyTasklet_Type);
     INSERT("channel",   &PyChannel_Type);
+    INSERT("TaskletGroup", &PyTaskletGroup_Type);
+    INSERT("local", &PyTaskletLocal_Type);
     INSERT("stackless", slp_module);
 
+    if (slp_timeout_error == NULL) {
+        slp_timeout_error = PyErr_NewException("stackless.TimeoutError",
+                                               NULL, NULL);
+        if (slp_timeout_error == NULL)
+            return;
+    }
+    INSERT("TimeoutError", slp_timeout_error);
+
     m = (PySlpModuleObject *) slp_module;
     slpmodule_set__tasklet__(m, &PyTasklet_Type, NULL);
     slpmodule_set__channel__(m, &PyChannel_Type, NULL);
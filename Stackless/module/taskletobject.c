@@ -9,6 +9,7 @@
 #ifdef STACKLESS
 #include "core/stackless_impl.h"
 #include "module/taskletobject.h"
+#include "opcode.h"
 
 void
 slp_current_insert(PyTaskletObject *task)
@@ -44,10 +45,81 @@ slp_current_remove(void)
     return ret;
 }
 
+/*
+ * Every thread keeps a ring of its tasklets which have a frame, so
+ * that they can be listed without walking the heap. A tasklet is
+ * registered when it is bound to a frame, and unregistered when it
+ * ends or is killed.
+ */
+
+void
+slp_tasklet_register(PyTaskletObject *task)
+{
+    PyThreadState *ts = task->cstate->tstate;
+
+    if (task->alive.next == NULL)
+        SLP_LINK_INSERT(&ts->st.alive, &task->alive);
+}
+
+void
+slp_tasklet_unregister(PyTaskletObject *task)
+{
+    if (task->alive.next != NULL)
+        SLP_LINK_REMOVE(&task->alive);
+}
+
+/*
+ * A tasklet which waits for a long time can be frozen: it and its
+ * frames go to the permanent generation of the collector, so that
+ * collections don't traverse them over and over. Scheduling the
+ * tasklet thaws it. While the collector runs, objects can't be moved,
+ * and thawing is retried on the next switch to the tasklet.
+ */
+
+int
+slp_tasklet_freeze(PyTaskletObject *task)
+{
+    PyFrameObject *f;
+
+    if (task == task->cstate->tstate->st.current)
+        RUNTIME_ERROR("cannot freeze the current tasklet", -1);
+    if (_PyObject_GC_Freeze((PyObject *) task))
+        RUNTIME_ERROR("cannot freeze during a garbage collection", -1);
+    for (f = task->f.frame; f != NULL; f = f->f_back)
+        _PyObject_GC_Freeze((PyObject *) f);
+    task->flags.frozen = 1;
+    return 0;
+}
+
+void
+slp_tasklet_thaw(PyTaskletObject *task)
+{
+    PyFrameObject *f;
+
+    if (_PyObject_GC_Thaw((PyObject *) task))
+        return;
+    for (f = task->f.frame; f != NULL; f = f->f_back)
+        _PyObject_GC_Thaw((PyObject *) f);
+    task->flags.frozen = 0;
+}
+
+/* the thread is going away, and the ring head with it */
+
+void
+slp_tasklet_unregister_all(PyThreadState *ts)
+{
+    while (ts->st.alive.next != &ts->st.alive) {
+        PySlpLink *link = ts->st.alive.next;
+
+        SLP_LINK_REMOVE(link);
+    }
+}
+
 static int
 tasklet_traverse(PyTaskletObject *t, visitproc visit, void *arg)
 {
     PyFrameObject *f;
+    Py_ssize_t i;
     PyThreadState *ts = PyThreadState_GET();
     if (ts != t->cstate->tstate)
         /* can't collect from this thread! */
@@ -59,6 +131,9 @@ tasklet_traverse(PyTaskletObject *t, visitproc visit, void *arg)
     }
     Py_VISIT(t->tempval);
     Py_VISIT(t->cstate);
+    Py_VISIT(t->group);
+    for (i = 0; i < t->nlocals; i++)
+        Py_VISIT(t->locals[i].dict);
     return 0;
 }
 
@@ -105,6 +180,9 @@ tasklet_clear(PyTaskletObject *t)
     if (t->f.frame != NULL)
         kill_finally((PyObject *) t);
     TASKLET_SETVAL(t, Py_None); /* always non-zero */
+    if (t->group != NULL)
+        slp_taskletgroup_leave(t);
+    slp_tasklet_clear_locals(t);
     /* unlink task from cstate */
     if (t->cstate != NULL && t->cstate->task == t)
         t->cstate->task = NULL;
@@ -130,12 +208,17 @@ tasklet_dealloc(PyTaskletObject *t)
     if (t->tsk_weakreflist != NULL)
         PyObject_ClearWeakRefs((PyObject *)t);
     assert(t->f.frame == NULL);
+    /* the member list of a group keeps its tasklets alive */
+    assert(t->group == NULL);
     if (t->cstate != NULL) {
         assert(t->cstate->task != t || t->cstate->ob_size == 0);
         Py_DECREF(t->cstate);
     }
     Py_DECREF(t->tempval);
     Py_XDECREF(t->def_globals);
+    slp_tasklet_unregister(t);
+    slp_tasklet_clear_locals(t);
+    slp_memaccount_release(t);
     t->ob_type->tp_free((PyObject*)t);
 }
 
@@ -173,6 +256,14 @@ PyTasklet_New(PyTypeObject *type, PyObject *func)
         Py_INCREF(func);
         t->tempval = func;
         t->tsk_weakreflist = NULL;
+        t->timer_slot = 0;
+        t->group = NULL;
+        t->group_slot = 0;
+        t->memaccount = NULL;
+        t->locals = NULL;
+        t->nlocals = 0;
+        t->alive.next = t->alive.prev = NULL;
+        t->sample_id = 0;
         Py_INCREF(ts->st.initial_stub);
         t->cstate = ts->st.initial_stub;
         t->def_globals = PyEval_GetGlobals();
@@ -191,6 +282,20 @@ PyTasklet_New(PyTypeObject *type, PyObject *func)
 PyTaskletObject *
 PyTasklet_Bind(PyTaskletObject *task, PyObject *func)
 {
+    if (func == Py_None) {
+        /* unbind: drop the frame of a tasklet that never ran */
+        PyFrameObject *f = task->f.frame;
+
+        if (f != NULL) {
+            if (f->f_back != NULL || !slp_cframe_is_unstarted(f) ||
+                !slp_tasklet_drop(task))
+                RUNTIME_ERROR(
+                    "only a tasklet that has not run can be unbound", NULL);
+        }
+        TASKLET_SETVAL(task, Py_None);
+        Py_INCREF(task);
+        return task;
+    }
     if (func == NULL || !PyCallable_Check(func))
         TYPE_ERROR("tasklet function must be a callable", NULL);
     if (task->f.frame != NULL)
@@ -206,7 +311,9 @@ static char tasklet_bind__doc__[] =
 The callable is usually passed in to the constructor.\n\
 In some cases, it makes sense to be able to re-bind a tasklet,\n\
 after it has been run, in order to keep its identity.\n\
-Note that a tasklet can only be bound when it doesn't have a frame.\
+Note that a tasklet can only be bound when it doesn't have a frame.\n\
+bind(None) unbinds the tasklet, dropping the frame of a tasklet\n\
+that was called but has not run, yet.\
 ";
 
 static PyObject *
@@ -215,7 +322,7 @@ tasklet_bind(PyObject *self, PyObject *func)
     return (PyObject *) PyTasklet_Bind ( (PyTaskletObject *) self, func);
 }
 
-#define TASKLET_TUPLEFMT "iOiO"
+#define TASKLET_TUPLEFMT "iOiOO"
 
 static PyObject *
 tasklet_new(PyTypeObject *type, PyObject *args, PyObject *kwds)
@@ -257,13 +364,16 @@ simply the tasklet() call without parameters.
 static PyObject *
 tasklet_reduce(PyTaskletObject * t)
 {
-    PyObject *tup = NULL, *lis = NULL;
+    PyObject *tup = NULL, *lis = NULL, *locals = NULL;
     PyFrameObject *f;
     PyThreadState *ts = PyThreadState_GET();
+    PyTaskletFlagStruc flags = t->flags;
 
     if (t == ts->st.current)
         RUNTIME_ERROR("You cannot __reduce__ the tasklet which is"
                       " current.", NULL);
+    /* being frozen is a property of this process */
+    flags.frozen = 0;
     lis = PyList_New(0);
     if (lis == NULL) goto err_exit;
     f = t->f.frame;
@@ -272,16 +382,20 @@ tasklet_reduce(PyTaskletObject * t)
         f = f->f_back;
     }
     if (PyList_Reverse(lis)) goto err_exit;
+    locals = slp_tasklet_locals(t);
+    if (locals == NULL) goto err_exit;
     assert(t->cstate != NULL);
     tup = Py_BuildValue("(O()(" TASKLET_TUPLEFMT "))",
                         t->ob_type,
-                        t->flags,
+                        flags,
                         t->tempval,
                         t->cstate->nesting_level,
-                        lis
+                        lis,
+                        locals
                         );
 err_exit:
     Py_XDECREF(lis);
+    Py_XDECREF(locals);
     return tup;
 }
 
@@ -298,17 +412,21 @@ static PyObject *
 tasklet_setstate(PyObject *self, PyObject *args)
 {
     PyTaskletObject *t = (PyTaskletObject *) self;
-    PyObject *tempval, *lis;
+    PyObject *tempval, *lis, *locals = NULL;
     int flags, nesting_level;
     PyFrameObject *f;
     Py_ssize_t i, nframes;
-    int j;
+    int j, frozen;
 
-    if (!PyArg_ParseTuple(args, "iOiO!:tasklet",
+    /* the locals are optional, older pickles don't have them */
+    if (!PyArg_ParseTuple(args, "iOiO!|O!:tasklet",
                           &flags,
                           &tempval,
                           &nesting_level,
-                          &PyList_Type, &lis))
+                          &PyList_Type, &lis,
+                          &PyList_Type, &locals))
+        return NULL;
+    if (locals != NULL && slp_tasklet_set_locals(t, locals))
         return NULL;
 
     nframes = PyList_GET_SIZE(lis);
@@ -328,7 +446,9 @@ tasklet_setstate(PyObject *self, PyObject *args)
      * channel would have set it.
      */
     j = t->flags.blocked;
+    frozen = t->flags.frozen;
     *(int *)&t->flags = flags;
+    t->flags.frozen = frozen;
     if (t->next == NULL) {
         t->flags.blocked = 0;
     } else {
@@ -356,6 +476,7 @@ tasklet_setstate(PyObject *self, PyObject *args)
             back = f;
         }
         t->f.frame = f;
+        slp_tasklet_register(t);
     }
     /* walk frames again and calculate recursion_depth */
     for (f = t->f.frame; f != NULL; f = f->f_back) {
@@ -658,6 +779,7 @@ bind_tasklet_to_frame(PyTaskletObject *task, PyFrameObject *frame)
             if (slp_ensure_linkage(task))
                 return -1;
     }
+    slp_tasklet_register(task);
     return 0;
     /* note: We expect that f_back is NULL, or will be adjusted immediately */
 }
@@ -853,6 +975,105 @@ tasklet_setup(PyObject *self, PyObject *args, PyObject *kwds)
     return (PyObject*) task;
 }
 
+static PyObject *
+PyTasklet_SpawnMany_M(PyObject *func, PyObject *arglist)
+{
+    return PyStackless_CallMethod_Main(slp_module, "spawn_many", "(OO)",
+                                       func, arglist);
+}
+
+/*
+ * Create a tasklet for every argument tuple. All tasklets and their
+ * frames are built first, so that a failure leaves the run queue alone.
+ * Binding cannot fail for fresh tasklets, and the new tasklets are then
+ * spliced into the runnables in a single step.
+ */
+
+PyObject *
+PyTasklet_SpawnMany(PyObject *func, PyObject *arglist)
+{
+    PyThreadState *ts = PyThreadState_GET();
+    PyObject *seq, *tasks = NULL;
+    PyFrameObject **frames = NULL;
+    PyTaskletObject *first, *last, *head;
+    Py_ssize_t i = 0, n;
+
+    if (ts->st.main == NULL) return PyTasklet_SpawnMany_M(func, arglist);
+    if (!PyCallable_Check(func))
+        TYPE_ERROR("tasklet function must be a callable", NULL);
+    seq = PySequence_Fast(arglist,
+                          "spawn_many() needs a sequence of argument tuples");
+    if (seq == NULL)
+        return NULL;
+    n = PySequence_Fast_GET_SIZE(seq);
+    tasks = PyList_New(n);
+    if (tasks == NULL || n == 0)
+        goto done;
+    frames = PyMem_New(PyFrameObject *, n);
+    if (frames == NULL) {
+        PyErr_NoMemory();
+        goto error;
+    }
+    for (i = 0; i < n; i++) {
+        PyObject *args = PySequence_Fast_GET_ITEM(seq, i);
+        PyTaskletObject *t;
+
+        args = PySequence_Tuple(args);
+        if (args == NULL)
+            goto error;
+        frames[i] = (PyFrameObject *) slp_cframe_newfunc(func, args, NULL, 0);
+        Py_DECREF(args);
+        if (frames[i] == NULL)
+            goto error;
+        t = PyTasklet_New(NULL, func);
+        if (t == NULL) {
+            Py_DECREF(frames[i]);
+            goto error;
+        }
+        PyList_SET_ITEM(tasks, i, (PyObject *) t);
+    }
+
+    /* from here on, nothing can fail */
+    for (i = 0; i < n; i++) {
+        PyTaskletObject *t = (PyTaskletObject *) PyList_GET_ITEM(tasks, i);
+
+        assert(t->cstate == ts->st.initial_stub);
+        bind_tasklet_to_frame(t, frames[i]);
+        TASKLET_SETVAL(t, Py_None);
+        /* the reference of the run queue */
+        Py_INCREF(t);
+        if (i > 0) {
+            t->prev = (PyTaskletObject *) PyList_GET_ITEM(tasks, i - 1);
+            t->prev->next = t;
+        }
+    }
+    PyMem_Free(frames);
+    first = (PyTaskletObject *) PyList_GET_ITEM(tasks, 0);
+    last = (PyTaskletObject *) PyList_GET_ITEM(tasks, n - 1);
+    head = ts->st.current;
+    if (head == NULL) {
+        ts->st.current = first;
+        head = first;
+    }
+    /* insert at the end, just like slp_current_insert */
+    last->next = head;
+    first->prev = head->prev != NULL ? head->prev : last;
+    first->prev->next = first;
+    head->prev = last;
+    ts->st.runcount += n;
+    goto done;
+
+error:
+    /* drop the frames which did not get their tasklet */
+    while (--i >= 0)
+        Py_DECREF(frames[i]);
+    PyMem_Free(frames);
+    Py_CLEAR(tasks);
+done:
+    Py_DECREF(seq);
+    return tasks;
+}
+
 
 static char tasklet_raise_exception__doc__[] =
 "tasklet.raise_exception(exc, value) -- raise an exception for the tasklet.\n\
@@ -982,6 +1203,178 @@ tasklet_kill(PyObject *self)
 }
 
 
+/*
+ * Drop a tasklet without switching to it, if killing it could not run
+ * any code: it has no C stack, and no frame of it has a pending
+ * except or finally clause (or is a generator).
+ * Returns 1 if the tasklet is dead now, 0 if it must be killed.
+ */
+
+int
+slp_tasklet_drop(PyTaskletObject *task)
+{
+    PyThreadState *ts = PyThreadState_GET();
+    PyFrameObject *f, *back;
+
+    if (task == ts->st.current || task == ts->st.main ||
+        task->f.frame == NULL || task->cstate->tstate != ts ||
+        task->cstate->nesting_level != 0 ||
+        (task->cstate != ts->st.initial_stub && task->cstate->ob_size != 0))
+        return 0;
+    for (f = task->f.frame; f != NULL; f = f->f_back) {
+        if (PyFrame_Check(f)) {
+            int i;
+
+            if (f->f_code->co_flags & CO_GENERATOR)
+                return 0;
+            for (i = 0; i < f->f_iblock; i++)
+                if (f->f_blockstack[i].b_type != SETUP_LOOP)
+                    return 0;
+        }
+        else if (f->f_back != NULL || !slp_cframe_is_unstarted(f))
+            return 0;
+    }
+
+    /* take it off its queue, keeping the queue's reference for now */
+    if (task->flags.blocked)
+        slp_channel_remove_slow(task);
+    else if (task->next != NULL) {
+        PyTaskletObject *hold = ts->st.current;
+
+        ts->st.current = task;
+        slp_current_remove();
+        ts->st.current = hold;
+    }
+    else
+        Py_INCREF(task);
+
+    f = task->f.frame;
+    task->f.frame = NULL;
+    task->recursion_depth = 0;
+    TASKLET_SETVAL(task, Py_None);
+    if (task->group != NULL)
+        slp_taskletgroup_leave(task);
+    slp_tasklet_unregister(task);
+    /* release the execute references */
+    while (f != NULL) {
+        back = f->f_back;
+        Py_DECREF(f);
+        f = back;
+    }
+    Py_DECREF(task);
+    return 1;
+}
+
+
+static char tasklet_switch__doc__[] =
+"tasklet.switch(value=None) -- switch to the tasklet, passing value.\n\
+Unlike run(), the current tasklet leaves the runnables and the target\n\
+takes its place, much like a greenlet switch. The target's pending\n\
+switch() or schedule() call returns value.\n\
+switch() returns the value passed by the next switch back to this\n\
+tasklet, or None if it is inserted by other means.";
+
+static PyObject *
+PyTasklet_Switch_M(PyTaskletObject *task, PyObject *value)
+{
+    return PyStackless_CallMethod_Main((PyObject*)task, "switch", "(O)",
+                                       value);
+}
+
+PyObject *
+PyTasklet_Switch(PyTaskletObject *task, PyObject *value)
+{
+    PyTasklet_HeapType *t = (PyTasklet_HeapType *)task->ob_type;
+
+    return t->switch_(task, value);
+}
+
+static TASKLET_SWITCH_HEAD(impl_tasklet_switch)
+{
+    STACKLESS_GETARG();
+    PyThreadState *ts = PyThreadState_GET();
+    PyTaskletObject *prev = ts->st.current;
+    PyObject *ret;
+    int inserted = 0, switched;
+
+    assert(PyTasklet_Check(task));
+    if (ts->st.main == NULL)
+        return PyTasklet_Switch_M(task, value);
+    if (task == prev) {
+        Py_INCREF(value);
+        return value;
+    }
+    if (task->flags.blocked)
+        RUNTIME_ERROR("You cannot switch to a blocked tasklet", NULL);
+    if (task->f.frame == NULL)
+        RUNTIME_ERROR("You cannot switch to an unbound(dead) tasklet", NULL);
+    if (task->cstate->tstate != ts)
+        RUNTIME_ERROR("You cannot switch to a tasklet of another thread",
+                      NULL);
+    if (prev->flags.block_trap)
+        RUNTIME_ERROR("this tasklet does not like to be blocked.", NULL);
+
+    TASKLET_SETVAL(task, value);
+    TASKLET_SETVAL(prev, Py_None);
+    if (task->next == NULL) {
+        /* the target takes our place in the runnables */
+        Py_INCREF(task);
+        slp_current_insert_after(task);
+        inserted = 1;
+    }
+    slp_current_remove();
+    /* keep our runnables reference until the switch is complete */
+    assert(ts->st.del_post_switch == NULL);
+    ts->st.del_post_switch = (PyObject *) prev;
+
+    ret = slp_schedule_task(prev, task, stackless, &switched);
+    if (!switched) {
+        /* we are still running: undo the exchange in the runnables */
+        ts->st.del_post_switch = NULL;
+        if (inserted && ts->st.current == task) {
+            slp_current_remove();
+            Py_DECREF(task);
+        }
+        slp_current_insert(prev); /* uses our runnables reference */
+        ts->st.current = prev;
+    }
+    return ret;
+}
+
+static TASKLET_SWITCH_HEAD(wrap_tasklet_switch)
+{
+    return PyObject_CallMethod((PyObject *)task, "switch", "(O)", value);
+}
+
+static PyObject *
+tasklet_switch(PyObject *self, PyObject *args)
+{
+    STACKLESS_GETARG();
+    PyObject *value = Py_None;
+
+    if (!PyArg_UnpackTuple(args, "switch", 0, 1, &value))
+        return NULL;
+    STACKLESS_PROMOTE_ALL();
+    return impl_tasklet_switch((PyTaskletObject*)self, value);
+}
+
+
+static char tasklet_freeze__doc__[] =
+"t.freeze() -- move the tasklet and its frames out of the way of the\n\
+garbage collector, until it runs the next time. Use this for tasklets\n\
+which will wait for a long time. Cycles through a frozen tasklet are\n\
+not collected while it is frozen.";
+
+static PyObject *
+tasklet_freeze(PyObject *self)
+{
+    if (slp_tasklet_freeze((PyTaskletObject *) self))
+        return NULL;
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+
 /* attributes which are hiding in small fields */
 
 static PyObject *
@@ -995,6 +1388,12 @@ int PyTasklet_GetBlocked(PyTaskletObject *task)
     return task->flags.blocked;
 }
 
+static PyObject *
+tasklet_get_frozen(PyTaskletObject *task)
+{
+    return PyBool_FromLong(task->flags.frozen);
+}
+
 
 static PyObject *
 tasklet_get_atomic(PyTaskletObject *task)
@@ -1155,6 +1554,18 @@ PyTasklet_Alive(PyTaskletObject *task)
 }
 
 
+static PyObject *
+tasklet_get_memory_live(PyTaskletObject *task)
+{
+    return PyInt_FromSsize_t(task->memaccount ? task->memaccount->live : 0);
+}
+
+static PyObject *
+tasklet_get_memory_peak(PyTaskletObject *task)
+{
+    return PyInt_FromSsize_t(task->memaccount ? task->memaccount->peak : 0);
+}
+
 static PyObject *
 tasklet_paused(PyTaskletObject *task)
 {
@@ -1253,6 +1664,9 @@ static PyMemberDef tasklet_members[] = {
      Every tasklet has a cstate, even if it is a trivial one.\n\
      Please see the cstate doc and the stackless documentation."},
     {"tempval", T_OBJECT, offsetof(PyTaskletObject, tempval), 0},
+    {"sample_id", T_LONG, offsetof(PyTaskletObject, sample_id), READONLY,
+     "the number of the tasklet in the output of the sampling profiler,\n\
+     0 if it was never sampled."},
     /* blocked, slicing_lock, atomic and such are treated by tp_getset */
     {0}
 };
@@ -1274,6 +1688,10 @@ static PyGetSetDef tasklet_getsetlist[] = {
      "Nonzero if waiting on a channel (1: send, -1: receive).\n"
      "Part of the flags word."},
 
+    {"frozen", (getter)tasklet_get_frozen, NULL,
+     "True if the tasklet was frozen and has not run since. See freeze()\n"
+     "Part of the flags word."},
+
     {"atomic", (getter)tasklet_get_atomic, NULL,
      "atomic inhibits scheduling of this tasklet. See set_atomic()\n"
      "Part of the flags word."},
@@ -1334,12 +1752,20 @@ static PyGetSetDef tasklet_getsetlist[] = {
     {"thread_id", (getter)tasklet_thread_id, NULL,
      "Return the thread id of the thread the tasklet belongs to."},
 
+    {"memory_live", (getter)tasklet_get_memory_live, NULL,
+     "The number of object bytes allocated by this tasklet and still in use.\n"
+     "Always zero, unless PYTHONTASKLETMEMORY was set at startup."},
+
+    {"memory_peak", (getter)tasklet_get_memory_peak, NULL,
+     "The maximum of memory_live over the life of this tasklet."},
+
     {0},
 };
 
 #define PCF PyCFunction
 #define METH_KS METH_KEYWORDS | METH_STACKLESS
 #define METH_NS METH_NOARGS | METH_STACKLESS
+#define METH_VS METH_VARARGS | METH_STACKLESS
 
 static PyMethodDef tasklet_methods[] = {
     {"insert",                  (PCF)tasklet_insert,        METH_NOARGS,
@@ -1360,10 +1786,14 @@ static PyMethodDef tasklet_methods[] = {
     tasklet_raise_exception__doc__},
     {"kill",                    (PCF)tasklet_kill,          METH_NS,
      tasklet_kill__doc__},
+    {"switch",                  (PCF)tasklet_switch,        METH_VS,
+     tasklet_switch__doc__},
     {"bind",                    (PCF)tasklet_bind,          METH_O,
      tasklet_bind__doc__},
     {"setup",                   (PCF)tasklet_setup,         METH_KEYWORDS,
      tasklet_setup__doc__},
+    {"freeze",                  (PCF)tasklet_freeze,        METH_NOARGS,
+     tasklet_freeze__doc__},
     {"__reduce__",              (PCF)tasklet_reduce,        METH_NOARGS,
      tasklet_reduce__doc__},
     {"__reduce_ex__",           (PCF)tasklet_reduce,        METH_VARARGS,
@@ -1383,6 +1813,10 @@ static PyCMethodDef tasklet_cmethods[] = {
     CMETHOD_PUBLIC_ENTRY(PyTasklet_HeapType, tasklet, capture),
     CMETHOD_PUBLIC_ENTRY(PyTasklet_HeapType, tasklet, raise_exception),
     CMETHOD_PUBLIC_ENTRY(PyTasklet_HeapType, tasklet, kill),
+    /* "switch" is a C keyword, so the slot is named switch_ */
+    {"switch", (PyCFunction)tasklet_switch,
+     &impl_tasklet_switch, &wrap_tasklet_switch,
+     offsetof(PyTasklet_HeapType, switch_)},
     {NULL}                       /* sentinel */
 };
 
@@ -28,6 +28,9 @@
 #define TASKLET_KILL_HEAD(func) \
     PyObject *func (PyTaskletObject *task)
 
+#define TASKLET_SWITCH_HEAD(func) \
+    PyObject *func (PyTaskletObject *task, PyObject *value)
+
 
 typedef struct _pytasklet_heaptype {
     PyFlexTypeObject type;
@@ -41,6 +44,7 @@ typedef struct _pytasklet_heaptype {
     TASKLET_CAPTURE_HEAD(               (*capture)           );
     TASKLET_RAISE_EXCEPTION_HEAD(       (*raise_exception)   );
     TASKLET_KILL_HEAD(                  (*kill)              );
+    TASKLET_SWITCH_HEAD(                (*switch_)           );
 } PyTasklet_HeapType;
 
 int init_tasklettype(void);
@@ -523,6 +523,8 @@ slp_from_tuple_with_nulls(PyObject **start, PyObject *tup)
 
 static struct _typeobject wrap_PyCode_Type;
 
+/* the caches, co_globalcache and co_attrcache, are rebuilt on demand */
+
 static PyObject *
 code_reduce(PyCodeObject * co)
 {
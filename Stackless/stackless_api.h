@@ -51,6 +51,13 @@ PyAPI_FUNC(PyTaskletObject *) PyTasklet_New(PyTypeObject *type, PyObject *func);
  */
 PyAPI_FUNC(int) PyTasklet_Setup(PyTaskletObject *task, PyObject *args, PyObject *kwds);
 
+/*
+ * create a tasklet of func for every tuple in arglist, bind it
+ * to the tuple and insert them all into the runnables queue.
+ */
+PyAPI_FUNC(PyObject *) PyTasklet_SpawnMany(PyObject *func, PyObject *arglist);
+/* a list of the new tasklets = success  NULL = failure */
+
 /*
  * forces the tasklet to run immediately.
  */
@@ -128,6 +135,16 @@ PyAPI_FUNC(int) PyTasklet_Kill(PyTaskletObject *self);
  * caller always should return NULL.
  */
 
+/*
+ * switching directly to a tasklet, passing value to it.
+ * The current tasklet is removed from the runnables and
+ * gets the value of the next switch back to it.
+ */
+
+PyAPI_FUNC(PyObject *) PyTasklet_Switch(PyTaskletObject *task,
+                                        PyObject *value);
+/* the value passed back = success  NULL = failure */
+
 
 /*
  * controlling the atomic flag of a tasklet.
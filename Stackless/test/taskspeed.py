@@ -11,7 +11,7 @@ except ImportError:
     print "This is not Stackless Python. Most tests will not work."
     def schedule(*args):
         raise StacklessError
-    test_outside = test_cframe = test_cframe_nr = schedule
+    test_outside = test_cframe = test_cframe_nr = spawn_many = schedule
     def enable_softswitch(n): pass
     class stackless:
         debug = 0 # assume to be tested with normal Python
@@ -86,6 +86,18 @@ def gf(n):
 def gentest(n):
     for i in gf(n):pass
 
+# tasklet creation test
+
+def noop(i):
+    pass
+
+def spawntest(n, bulk=0):
+    if bulk:
+        spawn_many(noop, [(i,) for i in xrange(n)])
+        return
+    for i in xrange(n):
+        tasklet(noop)(i)
+
 def channel_sender(chan, nest=0, bulk=0):
     if nest:
         return channel_sender(chan, nest-1)
@@ -228,6 +240,8 @@ for use_psyco in (False, True):
     res.append(tester(f, niter, (lambda:0,),        "function calls     "))
     res.append(tester(gentest, niter, (),           "generator calls    "))
     res.append(tester(test_cframe, niter//10, (),   "cframe from outside", 1, test_outside))
+    res.append(tester(spawntest, niter//10, (),     "tasklet spawns     ", 1))
+    res.append(tester(spawntest, niter//10, (1,),   "spawn_many spawns  ", 1))
     res.append(tester(test_cframe, niter, (),       "cframe switches    "))
     res.append(tester(test_cframe, niter, (500,),   "cframe 500 words   "))
 
@@ -1,3 +1,4 @@
+import time
 import unittest
 import stackless
 
@@ -97,6 +98,53 @@ class TestChannels(unittest.TestCase):
         c = stackless.channel()
         self.assertRaises(RuntimeError, c.receive)
 
+    def testReceiveTimeout(self):
+        ''' A receive in the main tasklet gives up after the timeout. '''
+        c = stackless.channel()
+        start = time.time()
+        self.assertRaises(stackless.TimeoutError, c.receive, timeout=0.05)
+        self.assertTrue(time.time() - start >= 0.04)
+        self.assertEqual(c.balance, 0)
+
+    def testSendTimeout(self):
+        ''' A blocked sender is removed from the channel on timeout. '''
+        c = stackless.channel()
+        self.assertRaises(stackless.TimeoutError, c.send, 42, timeout=0.01)
+        self.assertEqual(c.balance, 0)
+
+    def testZeroTimeout(self):
+        ''' A zero timeout never blocks. '''
+        c = stackless.channel()
+        self.assertRaises(stackless.TimeoutError, c.receive, 0)
+        self.assertRaises(ValueError, c.receive, -1)
+        self.assertEqual(c.balance, 0)
+
+    def testTimeoutInTasklet(self):
+        ''' Tasklets time out independently of each other. '''
+        c = stackless.channel()
+        result = []
+        def waiter(timeout):
+            try:
+                c.receive(timeout=timeout)
+            except stackless.TimeoutError:
+                result.append(timeout)
+        stackless.tasklet(waiter)(0.03)
+        stackless.tasklet(waiter)(0.01)
+        stackless.run()
+        self.assertEqual(result, [0.01, 0.03])
+        self.assertEqual(c.balance, 0)
+
+    def testValueBeforeTimeout(self):
+        ''' A value that arrives in time cancels the timeout. '''
+        c = stackless.channel()
+        stackless.tasklet(c.send)(42)
+        self.assertEqual(c.receive(timeout=10), 42)
+        def sender():
+            time.sleep(0.01)
+            c.send(43)
+        stackless.tasklet(sender)()
+        self.assertEqual(c.receive(timeout=10), 43)
+
 
 if __name__ == '__main__':
     import sys
@@ -0,0 +1,74 @@
+import unittest
+import gc
+import weakref
+
+import stackless
+
+# test freezing tasklets out of the garbage collector
+
+class Data(object):
+    pass
+
+class TestFreeze(unittest.TestCase):
+    def testThaw(self):
+        ''' A frozen tasklet is thawed when it runs. '''
+        c = stackless.channel()
+        result = []
+        def f():
+            data = Data()
+            result.append(c.receive())
+            result.append(data)
+        t = stackless.tasklet(f)()
+        t.run()
+        self.assertEqual(stackless.freeze_blocked(), 1)
+        self.assertTrue(t.frozen)
+        self.assertEqual(stackless.freeze_blocked(), 0)
+        gc.collect()
+        self.assertTrue(t in gc.get_objects())
+        c.send(42)
+        self.assertFalse(t.frozen)
+        self.assertEqual(result[0], 42)
+        self.assertTrue(isinstance(result[1], Data))
+
+    def testReferents(self):
+        ''' Objects referenced by frozen frames stay alive. '''
+        c = stackless.channel()
+        def f(data):
+            c.receive()
+        data = Data()
+        ref = weakref.ref(data)
+        t = stackless.tasklet(f)(data)
+        t.run()
+        t.freeze()
+        del data
+        gc.collect()
+        self.assertTrue(ref() is not None)
+        t.kill()
+        self.assertFalse(t.frozen)
+        gc.collect()
+        self.assertTrue(ref() is None)
+
+    def testErrors(self):
+        self.assertRaises(RuntimeError, stackless.getcurrent().freeze)
+        t = stackless.tasklet(lambda: None)()
+        t.freeze()
+        self.assertTrue(t.frozen)
+        stackless.run()
+        self.assertFalse(t.frozen)
+
+    def testPickle(self):
+        ''' Being frozen is not pickled. '''
+        c = stackless.channel()
+        t = stackless.tasklet(c.receive)()
+        t.run()
+        flags = t.__reduce__()[2][0]
+        t.freeze()
+        self.assertEqual(t.__reduce__()[2][0], flags)
+        t.kill()
+
+
+if __name__ == '__main__':
+    import sys
+    if not sys.argv[1:]:
+        sys.argv.append('-v')
+    unittest.main()
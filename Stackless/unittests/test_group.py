@@ -0,0 +1,141 @@
+import unittest
+import stackless
+
+# test stackless.TaskletGroup
+
+def is_soft():
+    softswitch = stackless.enable_softswitch(0)
+    stackless.enable_softswitch(softswitch)
+    return softswitch
+
+class TestTaskletGroup(unittest.TestCase):
+    def setUp(self):
+        self.switched_to = []
+        def cb(prev, next):
+            self.switched_to.append(next)
+        stackless.set_schedule_callback(cb)
+
+    def tearDown(self):
+        stackless.set_schedule_callback(None)
+
+    def testMembership(self):
+        ''' Tasklets leave the group when they end. '''
+        c = stackless.channel()
+        g = stackless.TaskletGroup()
+        tasklets = [stackless.tasklet(c.receive)() for i in range(5)]
+        for t in tasklets:
+            g.add(t)
+        g.add(tasklets[0])
+        self.assertEqual(len(g), 5)
+        self.assertEqual(sorted(g.tasklets), sorted(tasklets))
+        stackless.run()
+        c.send(None)
+        stackless.run()
+        self.assertEqual(len(g), 4)
+        self.assertFalse(tasklets[0] in g.tasklets)
+        self.assertRaises(RuntimeError, g.add, tasklets[0])
+        self.assertRaises(RuntimeError,
+                          stackless.TaskletGroup().add, tasklets[1])
+        for t in tasklets[1:]:
+            c.send(None)
+        stackless.run()
+        self.assertEqual(len(g), 0)
+
+    def testKillDrops(self):
+        ''' Tasklets without handlers are killed without switching. '''
+        c = stackless.channel()
+        def blocked():
+            for i in range(3):
+                c.receive()
+        g = stackless.TaskletGroup()
+        started = stackless.tasklet(blocked)()
+        started.run()
+        unstarted = stackless.tasklet(blocked)()
+        g.add(unstarted)
+        g.add(started)
+        del self.switched_to[:]
+        g.kill_all()
+        self.assertFalse(unstarted in self.switched_to)
+        if is_soft():
+            # without a C stack, started tasklets are dropped, too
+            self.assertEqual(self.switched_to, [])
+        self.assertFalse(unstarted.alive)
+        self.assertFalse(started.alive)
+        self.assertEqual(c.balance, 0)
+        self.assertEqual(len(g), 0)
+        self.assertEqual(stackless.getruncount(), 1)
+
+    def testKillRunsFinally(self):
+        ''' Tasklets with pending finally clauses are switched to. '''
+        c = stackless.channel()
+        log = []
+        def careful():
+            try:
+                c.receive()
+            finally:
+                log.append(stackless.getcurrent())
+        g = stackless.TaskletGroup()
+        t = stackless.tasklet(careful)()
+        t.run()
+        g.add(t)
+        g.kill_all()
+        self.assertEqual(log, [t])
+        self.assertFalse(t.alive)
+        self.assertEqual(len(g), 0)
+
+    def testJoin(self):
+        ''' join waits for all members, or the timeout. '''
+        g = stackless.TaskletGroup()
+        self.assertTrue(g.join())
+        for i in range(3):
+            g.add(stackless.tasklet(stackless.schedule)())
+        self.assertTrue(g.join())
+        self.assertEqual(len(g), 0)
+
+        c = stackless.channel()
+        t = stackless.tasklet(c.receive)()
+        g.add(t)
+        self.assertFalse(g.join(timeout=0.01))
+        c.send(None)
+        self.assertTrue(g.join())
+
+    def testUnbind(self):
+        ''' Unbinding a member removes it from the group. '''
+        g = stackless.TaskletGroup()
+        for scheduled in (True, False):
+            t = stackless.tasklet(lambda: None)()
+            if not scheduled:
+                t.remove()
+            g.add(t)
+            t.bind(None)
+            self.assertFalse(t.alive)
+            self.assertEqual(len(g), 0)
+            self.assertTrue(g.join(timeout=0.01))
+        c = stackless.channel()
+        t = stackless.tasklet(c.receive)()
+        g.add(t)
+        t.run()
+        self.assertRaises(RuntimeError, t.bind, None)
+        self.assertEqual(g.tasklets, [t])
+        c.send(None)
+        self.assertTrue(g.join())
+
+    def testJoinOwnGroup(self):
+        ''' A member cannot wait for its own group. '''
+        g = stackless.TaskletGroup()
+        result = []
+        def member():
+            try:
+                g.join()
+            except RuntimeError:
+                result.append(True)
+        g.add(stackless.tasklet(member)())
+        stackless.run()
+        self.assertEqual(result, [True])
+
+
+if __name__ == '__main__':
+    import sys
+    if not sys.argv[1:]:
+        sys.argv.append('-v')
+    unittest.main()
@@ -0,0 +1,140 @@
+import unittest
+import pickle
+import gc
+
+import stackless
+
+# test stackless.local
+
+def is_soft():
+    softswitch = stackless.enable_softswitch(0)
+    stackless.enable_softswitch(softswitch)
+    return softswitch
+
+class TestLocal(unittest.TestCase):
+    def testPerTasklet(self):
+        ''' Every tasklet sees its own attributes. '''
+        loc = stackless.local()
+        loc.x = "main"
+        seen = []
+        def f(i):
+            self.assertFalse(hasattr(loc, "x"))
+            loc.x = i
+            stackless.schedule()
+            seen.append(loc.x)
+        for i in range(3):
+            stackless.tasklet(f)(i)
+        stackless.run()
+        self.assertEqual(seen, [0, 1, 2])
+        self.assertEqual(loc.x, "main")
+        self.assertEqual(loc.__dict__, {"x": "main"})
+        del loc.x
+        self.assertRaises(AttributeError, getattr, loc, "x")
+
+    def testSeveral(self):
+        ''' Locals don't share their data. '''
+        a, b = stackless.local(), stackless.local()
+        a.x = 1
+        b.x = 2
+        self.assertEqual((a.x, b.x), (1, 2))
+        self.assertRaises(TypeError, stackless.local, 1)
+
+    def testSubclass(self):
+        ''' __init__ runs once in every tasklet. '''
+        inits = []
+        class MyLocal(stackless.local):
+            def __init__(self, value):
+                inits.append(stackless.getcurrent())
+                self.value = value
+        loc = MyLocal(42)
+        def f():
+            self.assertEqual(loc.value, 42)
+            loc.value = 0
+            self.assertEqual(loc.value, 0)
+        t = stackless.tasklet(f)()
+        stackless.run()
+        self.assertEqual(loc.value, 42)
+        self.assertEqual(inits, [stackless.getcurrent(), t])
+
+    def testSlotReuse(self):
+        ''' A new local does not see the data of a dead one. '''
+        c = stackless.channel()
+        locs = [stackless.local()]
+        def f():
+            locs[0].x = 1
+            c.receive()
+            self.assertFalse(hasattr(locs[0], "x"))
+        t = stackless.tasklet(f)()
+        t.run()
+        locs[0] = stackless.local()
+        gc.collect()
+        c.send(None)
+
+    def testCleanup(self):
+        ''' Dead tasklets release their data. '''
+        class Data(object):
+            pass
+        loc = stackless.local()
+        data = Data()
+        import weakref
+        ref = weakref.ref(data)
+        def f(d):
+            loc.data = d
+        stackless.tasklet(f)(data)
+        del data
+        stackless.run()
+        gc.collect()
+        self.assertEqual(ref(), None)
+
+    def testDeadLocal(self):
+        ''' A dead local releases its data in the tasklets that live on. '''
+        class Data(object):
+            pass
+        import weakref
+        loc = stackless.local()
+        data = Data()
+        other = Data()
+        refs = [weakref.ref(data), weakref.ref(other)]
+        loc.data = data
+        def f(box):
+            # the arguments may stay on a hard switched stack
+            l, d = box
+            del box[:]
+            l.data = d
+            del l, d
+            stackless.schedule_remove()
+        t = stackless.tasklet(f)([loc, other])
+        t.run()
+        del data, other
+        del loc
+        gc.collect()
+        self.assertEqual([r() for r in refs], [None, None])
+        t.insert()
+        stackless.run()
+
+    def testPickle(self):
+        ''' Pickled tasklets carry their local data along. '''
+        loc = stackless.local()
+        result = []
+        def f():
+            loc.x = 42
+            stackless.schedule_remove()
+            result.append(loc.x)
+        t = stackless.tasklet(f)()
+        t.run()
+        t2, loc2, result2 = pickle.loads(pickle.dumps((t, loc, result)))
+        self.assertEqual(t2.__reduce__()[2][4], [(loc2, {"x": 42})])
+        self.assertFalse(hasattr(loc2, "x"))
+        t.kill()
+        if is_soft():
+            # hard switched frames cannot be restored
+            t2.insert()
+            stackless.run()
+            self.assertEqual(result2, [42])
+
+
+if __name__ == '__main__':
+    import sys
+    if not sys.argv[1:]:
+        sys.argv.append('-v')
+    unittest.main()
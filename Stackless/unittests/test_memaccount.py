@@ -0,0 +1,122 @@
+import unittest
+import subprocess
+import os
+import sys
+
+import stackless
+
+# test the tasklet memory accounting of the object allocator.
+# The mode is chosen at startup, so the tests run in a child process.
+
+def run_child(source, enable=True):
+    env = dict(os.environ)
+    env.pop("PYTHONTASKLETMEMORY", None)
+    if enable:
+        env["PYTHONTASKLETMEMORY"] = "1"
+    p = subprocess.Popen([sys.executable, "-c", source], env=env,
+                         stdout=subprocess.PIPE, stderr=subprocess.STDOUT)
+    out = p.communicate()[0]
+    return p.returncode, out
+
+class TestMemoryAccount(unittest.TestCase):
+    def testDisabled(self):
+        ''' Without the variable, nothing is accounted. '''
+        code, out = run_child("""if 1:
+            import stackless
+            assert stackless.getcurrent().memory_live == 0
+            try:
+                stackless.memory_top()
+            except RuntimeError:
+                pass
+            else:
+                raise AssertionError
+            """, enable=False)
+        self.assertEqual(code, 0, out)
+
+    def testCharge(self):
+        ''' Allocations are charged to the allocating tasklet. '''
+        code, out = run_child("""if 1:
+            import stackless
+            c = stackless.channel()
+            keep = []
+            def hog():
+                keep.append([object() for i in range(10000)])
+                c.receive()
+                del keep[:]
+                c.receive()
+            t = stackless.tasklet(hog)()
+            t.run()
+            assert t.memory_live > 10000 * 16, t.memory_live
+            peak = t.memory_peak
+            assert peak >= t.memory_live
+            top = stackless.memory_top(3)
+            assert len(top) == 3
+            assert top[0][1] >= top[1][1] >= top[2][1]
+            assert [entry for entry in top if entry[0] is t], top
+            c.send(None)
+            assert t.memory_live < 1000, t.memory_live
+            assert t.memory_peak == peak
+            c.send(None)
+            """)
+        self.assertEqual(code, 0, out)
+
+    def testOrphan(self):
+        ''' Memory of dead tasklets stays accounted until it is freed. '''
+        code, out = run_child("""if 1:
+            import stackless, gc
+            keep = []
+            def hog():
+                keep.append([object() for i in range(10000)])
+            stackless.tasklet(hog)()
+            stackless.run()
+            gc.collect()
+            def orphaned():
+                return sum(live for task, live, peak in stackless.memory_top(100)
+                           if task is None)
+            before = orphaned()
+            del keep[:]
+            assert orphaned() <= before - 10000 * 16
+            """)
+        self.assertEqual(code, 0, out)
+
+
+    def testForeign(self):
+        ''' Memory from other allocators is still accepted on free. '''
+        code, out = run_child("""if 1:
+            import stackless, _testcapi
+            before = stackless.getcurrent().memory_live
+            for i in range(100):
+                _testcapi.test_pyobject_free_foreign()
+            # the strings charge the same amount again and again
+            s = "x" * 100000
+            s2 = s + "y"
+            del s, s2
+            assert stackless.getcurrent().memory_live - before < 1000
+            """)
+        self.assertEqual(code, 0, out)
+
+    def testResize(self):
+        ''' Resized blocks, small and large, keep their account right. '''
+        code, out = run_child("""if 1:
+            import stackless
+            def grow(n):
+                # the string is resized in place by the concatenation
+                s = ""
+                for i in range(n):
+                    s += "x"
+                return stackless.getcurrent().memory_live, s
+            task = stackless.getcurrent()
+            for n in (100, 1000, 100000):
+                before = task.memory_live
+                live, s = grow(n)
+                assert live - before >= n, (n, live - before)
+                del s
+                assert task.memory_live - before < 1000, n
+            """)
+        self.assertEqual(code, 0, out)
+
+
+if __name__ == '__main__':
+    if not sys.argv[1:]:
+        sys.argv.append('-v')
+    unittest.main()
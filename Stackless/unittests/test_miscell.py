@@ -114,7 +114,102 @@ class TestWatchdog(unittest.TestCase):
         self.assertFalse(t.alive)
         self.assertFalse(t.scheduled)
         self.assertEquals(t.recursion_depth, 0)
-    
+
+
+class TestSwitch(unittest.TestCase):
+
+    def testPingPong(self):
+        """ Values go back and forth, without other runnables. """
+        main = stackless.getcurrent()
+        info = []
+        def doubler():
+            value = main.switch("ready")
+            info.append((stackless.getruncount(), main.scheduled))
+            while value is not None:
+                value = main.switch(value * 2)
+        t = stackless.tasklet(doubler)()
+        self.assertEqual(t.switch(), "ready")
+        self.assertEqual(t.switch(21), 42)
+        self.assertEqual(info, [(1, False)])
+        self.assertFalse(t.scheduled)
+        self.assertEqual(t.switch("a"), "aa")
+        self.assertEqual(t.switch(None), None)
+        self.assertFalse(t.alive)
+        self.assertEqual(stackless.getruncount(), 1)
+
+    def testSwitchSelf(self):
+        """ Switching to the current tasklet returns the value. """
+        self.assertEqual(stackless.getcurrent().switch(42), 42)
+
+    def testSwitchDead(self):
+        """ Dead and blocked tasklets refuse the switch. """
+        t = stackless.tasklet(lambda: None)()
+        stackless.run()
+        self.assertRaises(RuntimeError, t.switch)
+        c = stackless.channel()
+        t = stackless.tasklet(c.receive)()
+        t.run()
+        self.assertRaises(RuntimeError, t.switch)
+        c.send(None)
+
+    def testSwitchFailed(self):
+        """ After a failed switch the current tasklet is still runnable. """
+        main = stackless.getcurrent()
+        log = []
+        def cb(prev, next):
+            raise ZeroDivisionError
+        for scheduled in (False, True):
+            t = stackless.tasklet(log.append)(1)
+            if not scheduled:
+                t.remove()
+            stackless.set_schedule_callback(cb)
+            try:
+                self.assertRaises(ZeroDivisionError, t.switch)
+            finally:
+                stackless.set_schedule_callback(None)
+            self.assertTrue(stackless.getcurrent() is main)
+            self.assertTrue(main.scheduled)
+            self.assertEqual(t.scheduled, scheduled)
+            self.assertEqual(stackless.getruncount(), 1 + scheduled)
+            self.assertEqual(stackless.get_tasklets("runnable")[0], main)
+            t.switch()
+            self.assertEqual(log, [1])
+            del log[:]
+
+
+class TestSpawnMany(unittest.TestCase):
+
+    def testOrder(self):
+        """ The tasklets run in order, behind the existing runnables. """
+        log = []
+        first = stackless.tasklet(log.append)("first")
+        tasks = stackless.spawn_many(log.append, [(i,) for i in range(5)])
+        self.assertEqual(len(tasks), 5)
+        self.assertTrue(all(t.scheduled for t in tasks))
+        self.assertEqual(stackless.getruncount(), 7)
+        self.assertTrue(first.next is tasks[0])
+        self.assertTrue(tasks[-1].next is stackless.getcurrent())
+        stackless.run()
+        self.assertEqual(log, ["first"] + range(5))
+        self.assertFalse(any(t.alive for t in tasks))
+
+    def testArguments(self):
+        """ Argument sequences become tuples, and may be empty. """
+        log = []
+        def func(*args):
+            log.append(args)
+        stackless.spawn_many(func, [(), [1], (1, 2)])
+        self.assertEqual(stackless.spawn_many(func, []), [])
+        stackless.run()
+        self.assertEqual(log, [(), (1,), (1, 2)])
+
+    def testErrors(self):
+        """ Errors leave the run queue alone. """
+        self.assertRaises(TypeError, stackless.spawn_many, 42, [()])
+        self.assertRaises(TypeError, stackless.spawn_many, len, 42)
+        self.assertRaises(TypeError, stackless.spawn_many, len, [(), 42])
+        self.assertEqual(stackless.getruncount(), 1)
+
 #///////////////////////////////////////////////////////////////////////////////
 
 if __name__ == '__main__':
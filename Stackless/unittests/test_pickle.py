@@ -123,6 +123,36 @@ def genoutertest(n, when):
             schedule()
     return i
 
+class Collector(object):
+    def __init__(self):
+        self.items = []
+    def add(self, item):
+        self.items.append(item)
+
+def scheduled(value):
+    schedule()
+    return value
+
+def methodtest(n, when):
+    # the frame is pickled with a pending method call on the stack,
+    # and a pending call of a module function above it
+    c = Collector()
+    for i in range(n):
+        if i == when:
+            c.add(types.IntType(scheduled(i)))
+        else:
+            c.add(i)
+    return c.items
+
+def quickenedtest(n, when):
+    # the loop runs quickened code when the frame is pickled
+    x = 0.0
+    for i in range(n):
+        x = x + 0.5
+        if i == when:
+            schedule()
+    return x
+
 def cellpickling():
     """defect:  Initializing a function object with a partially constructed
        cell object
@@ -275,6 +305,12 @@ class TestConcretePickledTasklets(TestPickledTasklets):
     def testCell(self):
         self.run_pickled(cellpickling)
 
+    def testMethodCall(self):
+        self.run_pickled(methodtest, 20, 13)
+
+    def testQuickenedCode(self):
+        self.run_pickled(quickenedtest, 100, 60)
+
     def testFakeModules(self):
         types.ModuleType('fakemodule!')
 
@@ -0,0 +1,101 @@
+import unittest
+import thread
+import time
+import os
+import sys
+import subprocess
+
+import stackless
+
+# test stackless.call_in_pool
+
+class TestCallInPool(unittest.TestCase):
+    def testResult(self):
+        ''' The call runs in another thread and returns its result. '''
+        self.assertNotEqual(stackless.call_in_pool(thread.get_ident),
+                            thread.get_ident())
+        self.assertEqual(stackless.call_in_pool(int, "42"), 42)
+        self.assertEqual(stackless.call_in_pool(int, "2a", base=16), 42)
+
+    def testException(self):
+        ''' Exceptions of the call are raised in the caller. '''
+        self.assertRaises(ValueError, stackless.call_in_pool, int, "x")
+        self.assertRaises(TypeError, stackless.call_in_pool)
+
+    def testOthersRun(self):
+        ''' Other tasklets keep running while the call blocks. '''
+        done = []
+        ticks = [0]
+        def ticker():
+            while not done:
+                ticks[0] += 1
+                stackless.schedule()
+        stackless.tasklet(ticker)()
+        stackless.call_in_pool(time.sleep, 0.05)
+        done.append(True)
+        stackless.schedule()
+        self.assertTrue(ticks[0] > 0)
+        self.assertEqual(stackless.getruncount(), 1)
+
+    def testTasklets(self):
+        ''' Several tasklets can wait for the pool at the same time. '''
+        c = stackless.channel()
+        def worker(i):
+            c.send(stackless.call_in_pool(lambda: time.sleep(0.01) or i))
+        for i in range(10):
+            stackless.tasklet(worker)(i)
+        result = [c.receive() for i in range(10)]
+        self.assertEqual(sorted(result), range(10))
+        # let the senders end
+        stackless.run()
+
+    def testKill(self):
+        ''' A waiting tasklet can be killed. '''
+        def worker():
+            stackless.call_in_pool(time.sleep, 0.05)
+        t = stackless.tasklet(worker)()
+        t.run()
+        self.assertTrue(t.alive)
+        t.kill()
+        self.assertFalse(t.alive)
+        time.sleep(0.1)
+        self.assertEqual(stackless.getruncount(), 1)
+
+    @unittest.skipUnless(hasattr(os, "fork"), "needs os.fork")
+    def testFork(self):
+        ''' A forked child starts new workers. '''
+        self.assertEqual(stackless.call_in_pool(int, "1"), 1)
+        pid = os.fork()
+        if pid == 0:
+            try:
+                ok = stackless.call_in_pool(lambda: 42) == 42
+            finally:
+                os._exit(0 if ok else 1)
+        for i in range(100):
+            done, status = os.waitpid(pid, os.WNOHANG)
+            if done:
+                break
+            time.sleep(0.1)
+        else:
+            os.kill(pid, 9)
+            os.waitpid(pid, 0)
+            self.fail("the child hangs")
+        self.assertEqual(status, 0)
+
+    def testShutdown(self):
+        ''' The workers leave at exit. '''
+        code = ("import stackless\n"
+                "stackless.call_in_pool(int, '1')\n"
+                "def f():\n"
+                "    stackless.call_in_pool(int, '2')\n"
+                "stackless.tasklet(f)()\n"
+                "stackless.run(threadblock=True)\n")
+        rc = subprocess.call([sys.executable, "-c", code])
+        self.assertEqual(rc, 0)
+
+
+if __name__ == '__main__':
+    import sys
+    if not sys.argv[1:]:
+        sys.argv.append('-v')
+    unittest.main()
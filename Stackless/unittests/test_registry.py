@@ -0,0 +1,78 @@
+import unittest
+import thread
+
+import stackless
+
+# test the registries of tasklets and channels
+
+def ids(tasklets):
+    return set(map(id, tasklets))
+
+class TestRegistry(unittest.TestCase):
+    def testAlive(self):
+        ''' Tasklets are alive from binding until they end. '''
+        main = stackless.getcurrent()
+        self.assertTrue(main in stackless.get_tasklets())
+        t = stackless.tasklet(lambda: None)
+        self.assertFalse(t in stackless.get_tasklets())
+        t()
+        self.assertTrue(t in stackless.get_tasklets("alive"))
+        stackless.run()
+        self.assertFalse(t in stackless.get_tasklets())
+
+    def testKill(self):
+        ''' Killed tasklets leave the registry. '''
+        c = stackless.channel()
+        t = stackless.tasklet(c.receive)()
+        t.run()
+        self.assertTrue(t in stackless.get_tasklets())
+        t.kill()
+        self.assertFalse(t in stackless.get_tasklets())
+        u = stackless.tasklet(c.receive)()
+        u.kill()
+        self.assertFalse(u in stackless.get_tasklets())
+
+    def testRunnable(self):
+        ''' The run queue is listed in order, current first. '''
+        tasks = [stackless.tasklet(lambda: None)() for i in range(3)]
+        runnable = stackless.get_tasklets("runnable")
+        self.assertEqual(runnable[0], stackless.getcurrent())
+        self.assertEqual(runnable[-3:], tasks)
+        self.assertEqual(len(runnable), stackless.getruncount())
+        stackless.run()
+        self.assertEqual(stackless.get_tasklets("runnable"),
+                         [stackless.getcurrent()])
+
+    def testBlocked(self):
+        ''' Blocked tasklets and their channels are listed. '''
+        c1, c2 = stackless.channel(), stackless.channel()
+        receivers = [stackless.tasklet(c1.receive)() for i in range(2)]
+        sender = stackless.tasklet(c2.send)(None)
+        stackless.run()
+        self.assertEqual(ids(stackless.get_tasklets("blocked")),
+                         ids(receivers + [sender]))
+        channels = stackless.get_channels()
+        self.assertTrue((c1, -2) in channels)
+        self.assertTrue((c2, 1) in channels)
+        c1.send(None)
+        self.assertEqual(ids(stackless.get_tasklets("blocked")),
+                         ids(receivers[1:] + [sender]))
+        c1.send(None)
+        c2.receive()
+        self.assertEqual(stackless.get_tasklets("blocked"), [])
+        channels = stackless.get_channels()
+        self.assertFalse([c for c, balance in channels if c in (c1, c2)])
+
+    def testThread(self):
+        ''' The registries are per thread. '''
+        self.assertEqual(stackless.get_tasklets(thread_id=thread.get_ident()),
+                         stackless.get_tasklets())
+        self.assertRaises(ValueError, stackless.get_tasklets, "alive", -1)
+        self.assertRaises(ValueError, stackless.get_tasklets, "dead")
+
+
+if __name__ == '__main__':
+    import sys
+    if not sys.argv[1:]:
+        sys.argv.append('-v')
+    unittest.main()
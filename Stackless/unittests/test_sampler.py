@@ -0,0 +1,108 @@
+import unittest
+import time
+
+import stackless
+
+# test the sampling profiler
+
+def busy(seconds):
+    end = time.time() + seconds
+    while time.time() < end:
+        pass
+
+def spinner(seconds):
+    end = time.time() + seconds
+    while time.time() < end:
+        stackless.schedule()
+
+def parse(collapsed):
+    result = {}
+    for line in collapsed.splitlines():
+        stack, count = line.rsplit(" ", 1)
+        result[stack] = int(count)
+    return result
+
+class TestSampler(unittest.TestCase):
+    def tearDown(self):
+        stackless.sampler_stop()
+
+    def testCurrent(self):
+        ''' The running tasklet is sampled, root first. '''
+        stackless.sampler_start(interval=0.001)
+        busy(0.1)
+        stackless.sampler_stop()
+        stacks = parse(stackless.sampler_collapsed())
+        self.assertTrue(stacks)
+        busy_stacks = [s for s in stacks if s.split(";")[-1].startswith("busy ")]
+        self.assertTrue(busy_stacks)
+        for s in busy_stacks:
+            frames = s.split(";")
+            self.assertEqual(frames[0], "main")
+            self.assertTrue(frames[-2].startswith("testCurrent "))
+        stacks = parse(stackless.sampler_collapsed(per_tasklet=False))
+        self.assertFalse([s for s in stacks if s.startswith("main;")])
+
+    def testTasklets(self):
+        ''' Tasklets are told apart, and others are sampled on request. '''
+        t = stackless.tasklet(spinner)(0.1)
+        stackless.sampler_start(interval=0.001, others=True)
+        spinner(0.1)
+        stackless.sampler_stop()
+        stackless.run()
+        self.assertTrue(t.sample_id > 0)
+        label = "tasklet-%d" % t.sample_id
+        stacks = parse(stackless.sampler_collapsed())
+        self.assertTrue([s for s in stacks if s.startswith("main;")])
+        self.assertTrue([s for s in stacks if s.startswith(label + ";")])
+
+    def testBlocked(self):
+        ''' Tasklets blocked on channels are sampled with others. '''
+        c = stackless.channel()
+        def waiter():
+            c.receive()
+        t = stackless.tasklet(waiter)()
+        t.run()
+        stackless.sampler_start(interval=0.001, others=True)
+        busy(0.05)
+        stackless.sampler_stop()
+        c.send(None)
+        stacks = parse(stackless.sampler_collapsed())
+        label = "tasklet-%d" % t.sample_id
+        self.assertTrue([s for s in stacks if s.startswith(label + ";") and
+                         s.split(";")[-1].startswith("waiter ")])
+
+    def testStableIds(self):
+        ''' Tasklets keep their id, and ids are not reused. '''
+        ids = []
+        for i in range(2):
+            t = stackless.tasklet(spinner)(0.02)
+            stackless.sampler_start(interval=0.001, others=True)
+            spinner(0.02)
+            stackless.sampler_stop()
+            ids.append(t.sample_id)
+            stackless.run()
+            self.assertEqual(t.sample_id, ids[-1])
+            del t
+        self.assertTrue(0 < ids[0] < ids[1])
+
+    def testDropped(self):
+        ''' Samples beyond the buffer are counted as dropped. '''
+        stackless.sampler_start(interval=0.001, bufsize=4)
+        busy(0.05)
+        stackless.sampler_stop()
+        stacks = parse(stackless.sampler_collapsed())
+        self.assertTrue(stacks.get("[dropped]", 0) > 0)
+
+    def testErrors(self):
+        self.assertRaises(ValueError, stackless.sampler_start, 0)
+        stackless.sampler_start()
+        self.assertRaises(RuntimeError, stackless.sampler_start)
+        stackless.sampler_stop()
+        stackless.sampler_stop()
+
+
+if __name__ == '__main__':
+    import sys
+    if not sys.argv[1:]:
+        sys.argv.append('-v')
+    unittest.main()
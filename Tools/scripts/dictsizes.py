@@ -0,0 +1,96 @@
+#! /usr/bin/env python
+
+# Report the memory taken by the instance dicts of every class, and
+# what the same dicts would take as ordinary dicts, with their keys
+# not shared between the instances.
+#
+# Usage: dictsizes [ -n count ] [ module ... ]
+#
+# The instances found in the garbage collector after importing the
+# modules are counted.  Without modules, some typical instances are
+# made up.  -n limits the output to the count biggest classes.
+
+import sys, gc, getopt
+
+# only the instances of heap types share their keys
+Py_TPFLAGS_HEAPTYPE = 1 << 9
+
+def sizes():
+    # class -> [instances, shared bytes, unshared bytes]
+    result = {}
+    for obj in gc.get_objects():
+        cls = type(obj)
+        if not getattr(cls, '__flags__', 0) & Py_TPFLAGS_HEAPTYPE:
+            continue
+        d = getattr(obj, '__dict__', None)
+        if type(d) is not dict:
+            continue
+        entry = result.setdefault(cls, [0, 0, 0])
+        entry[0] += 1
+        entry[1] += sys.getsizeof(d)
+        entry[2] += sys.getsizeof(dict(d))
+    return result
+
+class Point(object):
+    def __init__(self, x, y):
+        self.x = x
+        self.y = y
+
+class Record(object):
+    def __init__(self, i):
+        self.id = i
+        self.name = 'record %d' % i
+        self.owner = None
+        self.tags = ()
+        self.size = i * 10
+        self.parent = None
+        self.valid = True
+
+class Sparse(object):
+    def __init__(self, i):
+        setattr(self, 'attr%d' % (i % 40), i)
+
+def workload():
+    return ([Point(i, -i) for i in range(10000)] +
+            [Record(i) for i in range(10000)] +
+            [Sparse(i) for i in range(1000)])
+
+def main():
+    try:
+        opts, args = getopt.getopt(sys.argv[1:], 'n:')
+    except getopt.error, msg:
+        sys.stderr.write('%s\n' % msg)
+        sys.stderr.write('usage: dictsizes [-n count] [module ...]\n')
+        sys.exit(2)
+    count = None
+    for o, a in opts:
+        if o == '-n':
+            count = int(a)
+    if args:
+        for name in args:
+            __import__(name)
+        keep = None
+    else:
+        keep = workload()
+    result = sizes()
+    rows = sorted(result.items(), key=lambda item: -item[1][2])
+    if count is not None:
+        rows = rows[:count]
+    print '%-40s %9s %12s %12s %6s' % ('class', 'instances', 'shared',
+                                       'unshared', 'saved')
+    total = [0, 0, 0]
+    for cls, (n, shared, unshared) in rows:
+        name = '%s.%s' % (cls.__module__, cls.__name__)
+        print '%-40s %9d %12d %12d %5.1f%%' % (
+            name[-40:], n, shared, unshared,
+            100.0 * (unshared - shared) / unshared)
+        total[0] += n
+        total[1] += shared
+        total[2] += unshared
+    if total[2]:
+        print '%-40s %9d %12d %12d %5.1f%%' % (
+            'total', total[0], total[1], total[2],
+            100.0 * (total[2] - total[1]) / total[2])
+
+if __name__ == '__main__':
+    main()